@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sudoku-solver.h"
+#include "work-stealing.h"
+
+// puzzles are read, solved and written in blocks of this size, so memory use
+// does not depend on the input size
+static constexpr size_t BLOCK_PUZZLES = 1 << 16;
+static constexpr size_t READ_BUFFER_SIZE = 1 << 20;
+
+// one puzzle per line: 81 cells in row-major order, digits 1-9 are givens,
+// '0' or '.' are empty cells. Empty lines are skipped
+class puzzle_reader_t {
+public:
+  explicit puzzle_reader_t(std::FILE* file)
+      : file_(file), buffer_(READ_BUFFER_SIZE) {}
+
+  // reads the next puzzle, returns false at the end of input or on a
+  // malformed line (then error() is true)
+  bool read(board_t* board) {
+    size_t cells = 0;
+    while (true) {
+      int c = next_char();
+      if (c == EOF || c == '\n') {
+        if (cells == CELLS_COUNT) {
+          ++line_;
+          return true;
+        }
+        if (cells != 0) {
+          error_ = true;
+          return false;
+        }
+        if (c == EOF) {
+          return false;
+        }
+        ++line_;
+        continue;
+      }
+      if (c == '\r') {
+        continue;
+      }
+      if (cells == CELLS_COUNT) {
+        error_ = true;
+        return false;
+      }
+      if (c == '.') {
+        (*board)[cells++] = 0;
+      } else if (c >= '0' && c <= '9') {
+        (*board)[cells++] = c - '0';
+      } else {
+        error_ = true;
+        return false;
+      }
+    }
+  }
+
+  bool error() const {
+    return error_;
+  }
+
+  // 1-indexed line of the last puzzle read or of the malformed line
+  size_t line() const {
+    return line_ + 1;
+  }
+
+private:
+  int next_char() {
+    if (pos_ == size_) {
+      size_ = std::fread(buffer_.data(), 1, buffer_.size(), file_);
+      pos_ = 0;
+      if (size_ == 0) {
+        return EOF;
+      }
+    }
+    return static_cast<unsigned char>(buffer_[pos_++]);
+  }
+
+  std::FILE* file_;
+  std::vector<char> buffer_;
+  size_t pos_{0};
+  size_t size_{0};
+  size_t line_{0};
+  bool error_{false};
+};
+
+// writes "<solutions count> <first solution>" per puzzle, or just "0" if there
+// is no solution. Solutions count is capped by the optional max solutions
+// argument
+size_t format_result(size_t solutions_count, const board_t& solution,
+                     char* out) {
+  bool solved = solutions_count != 0;
+  char digits[20];
+  size_t len = 0;
+  do {
+    digits[len++] = static_cast<char>('0' + solutions_count % 10);
+    solutions_count /= 10;
+  } while (solutions_count != 0);
+
+  size_t pos = 0;
+  while (len > 0) {
+    out[pos++] = digits[--len];
+  }
+  if (solved) {
+    out[pos++] = ' ';
+    for (uint8_t cell : solution) {
+      out[pos++] = static_cast<char>('0' + cell);
+    }
+  }
+  out[pos++] = '\n';
+  return pos;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0]
+              << " <puzzles file> <output file | -> [threads count]"
+                 " [max solutions]"
+              << std::endl;
+    return 1;
+  }
+
+  size_t threads_count = std::thread::hardware_concurrency();
+  if (argc > 3) {
+    threads_count = std::strtoul(argv[3], nullptr, 10);
+  }
+  threads_count = std::max<size_t>(1, threads_count);
+
+  // counting is capped, so that under-constrained puzzles can't stall a batch
+  solver_options_t options;
+  if (argc > 4) {
+    options.max_solutions = std::strtoull(argv[4], nullptr, 10);
+  }
+
+  std::FILE* input = std::fopen(argv[1], "rb");
+  if (input == nullptr) {
+    std::cerr << "Cannot open " << argv[1] << std::endl;
+    return 1;
+  }
+  bool to_stdout = std::string(argv[2]) == "-";
+  std::FILE* output = to_stdout ? stdout : std::fopen(argv[2], "wb");
+  if (output == nullptr) {
+    std::cerr << "Cannot open " << argv[2] << std::endl;
+    std::fclose(input);
+    return 1;
+  }
+
+  // count, space, 81 cells and newline
+  static constexpr size_t MAX_RESULT_SIZE = 20 + 1 + CELLS_COUNT + 1;
+
+  puzzle_reader_t reader(input);
+  std::vector<board_t> boards(BLOCK_PUZZLES);
+  std::vector<size_t> counts(BLOCK_PUZZLES);
+  std::vector<char> out_buffer(BLOCK_PUZZLES * MAX_RESULT_SIZE);
+
+  while (true) {
+    size_t block_size = 0;
+    while (block_size < BLOCK_PUZZLES && reader.read(&boards[block_size])) {
+      ++block_size;
+    }
+
+    // puzzles go to workers, results stay at the puzzle's index
+    run_work_stealing(block_size, threads_count, [&](size_t puzzle, size_t) {
+      counts[puzzle] = sudoku_solve(boards[puzzle], options);
+    });
+
+    size_t out_size = 0;
+    for (size_t puzzle = 0; puzzle < block_size; ++puzzle) {
+      out_size += format_result(counts[puzzle], boards[puzzle],
+                                out_buffer.data() + out_size);
+    }
+    std::fwrite(out_buffer.data(), 1, out_size, output);
+
+    if (block_size < BLOCK_PUZZLES) {
+      break;
+    }
+  }
+
+  std::fclose(input);
+  if (!to_stdout) {
+    std::fclose(output);
+  }
+  if (reader.error()) {
+    std::cerr << "Malformed puzzle at line " << reader.line() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -39,8 +39,9 @@ int main(int argc, char **argv) {
     return 1;
   }
 
-  if (!check_field(field, actual_answer.second)) {
-    std::cerr << "Actual solution: " << std::endl;
+  field_error_t error = validate_solution(field, actual_answer.second);
+  if (error) {
+    std::cerr << "Actual solution (" << error << "): " << std::endl;
     std::cerr << actual_answer.second;
     std::cerr << "isn't solution for init field: " << std::endl;
     std::cerr << field;
@@ -1,62 +1,108 @@
 #include "field-checker.h"
-#include "sudoku-solver.h"
-#include <algorithm>
+#include <array>
+#include <cstdint>
 
-// checks if all values in an element (row, column, block) are unique
-bool is_unique(std::vector<int> element) {
-  auto iter = std::unique(element.begin(), element.end());
-  return (iter == element.end());
-}
+// init_at(row, col) and solution_at(row, col) return cells of the
+// FIELD_SIZE x FIELD_SIZE fields
+template <typename init_at_t, typename solution_at_t>
+field_error_t validate(const init_at_t& init_at,
+                       const solution_at_t& solution_at) {
+  std::array<uint16_t, FIELD_SIZE> rows{};
+  std::array<uint16_t, FIELD_SIZE> cols{};
+  std::array<uint16_t, FIELD_SIZE> blocks{};
 
-bool check_field(const std::vector<std::vector<int>>& init_field,
-                 const std::vector<std::vector<int>>& solution) {
-  //  return true;
-  for (int i = 0; i < FIELD_SIZE; ++i) {
-    for (int j = 0; j < FIELD_SIZE; ++j) {
+  for (int row = 0; row < static_cast<int>(FIELD_SIZE); ++row) {
+    for (int col = 0; col < static_cast<int>(FIELD_SIZE); ++col) {
+      int value = solution_at(row, col);
+      int init_value = init_at(row, col);
       // if values in solution are in range
-      if ((solution[i][j] <= 0) || (solution[i][j] > FIELD_SIZE)) {
-        return false;
+      if (value <= 0 || value > static_cast<int>(FIELD_SIZE)) {
+        return {field_error_t::OUT_OF_RANGE, row, col};
       }
       // if original values are preserved
-      if ((init_field[i][j] != 0) && (solution[i][j] != init_field[i][j])) {
-        return false;
+      if (init_value != 0 && value != init_value) {
+        return {field_error_t::CHANGED_CELL, row, col};
+      }
+
+      // if values in rows, columns and blocks are unique
+      auto bit = static_cast<uint16_t>(1U << (value - 1));
+      int block = row - row % 3 + col / 3;
+      if (rows[row] & bit) {
+        return {field_error_t::DUPLICATE_IN_ROW, row, col};
+      }
+      if (cols[col] & bit) {
+        return {field_error_t::DUPLICATE_IN_COLUMN, row, col};
+      }
+      if (blocks[block] & bit) {
+        return {field_error_t::DUPLICATE_IN_BLOCK, row, col};
       }
+      rows[row] |= bit;
+      cols[col] |= bit;
+      blocks[block] |= bit;
     }
   }
+  return {};
+}
 
-  // if values in rows are unique
-  for (int row = 0; row < FIELD_SIZE; ++row) {
-    if (!is_unique(solution[row])) {
+bool has_field_size(const std::vector<std::vector<int>>& field) {
+  if (field.size() != FIELD_SIZE) {
+    return false;
+  }
+  for (const auto& line : field) {
+    if (line.size() != FIELD_SIZE) {
       return false;
     }
   }
+  return true;
+}
 
-  // if values in columns are unique
-  for (int col = 0; col < FIELD_SIZE; ++col) {
-    auto* column = new std::vector<int>;
-    for (int row = 0; row < FIELD_SIZE; ++row) {
-      column->push_back(solution[row][col]);
-    }
-    if (!is_unique(*column)) {
-      return false;
-    }
-    delete column;
+field_error_t validate_solution(const std::vector<std::vector<int>>& init_field,
+                                const std::vector<std::vector<int>>& solution) {
+  if (!has_field_size(init_field) || !has_field_size(solution)) {
+    return {field_error_t::WRONG_SIZE};
   }
+  const auto cell_at = [](const std::vector<std::vector<int>>& field) {
+    return [&field](int row, int col) { return field[row][col]; };
+  };
+  return validate(cell_at(init_field), cell_at(solution));
+}
 
-  //   if values in blocks are unique
-  for (int row = 0; row <= FIELD_SIZE - 3; row += 3) {
-    for (int col = 0; col < FIELD_SIZE - 3; col += 3) {
-      auto* block = new std::vector<int>;
-      for (int i = 0; i < 3; ++i) {
-        for (int j = 0; j < 3; ++j) {
-          block->push_back(solution[row + i][col + j]);
-        }
-      }
-      if (!is_unique(*block)) {
-        return false;
-      }
-      delete block;
-    }
+field_error_t validate_solution(const board_t& init_board,
+                                const board_t& solution) {
+  const auto cell_at = [](const board_t& board) {
+    return [&board](int row, int col) {
+      return static_cast<int>(board[row * FIELD_SIZE + col]);
+    };
+  };
+  return validate(cell_at(init_board), cell_at(solution));
+}
+
+std::ostream& operator<<(std::ostream& stream, const field_error_t& error) {
+  switch (error.kind) {
+  case field_error_t::NONE:
+    return stream << "no error";
+  case field_error_t::WRONG_SIZE:
+    return stream << "field isn't " << FIELD_SIZE << "x" << FIELD_SIZE;
+  case field_error_t::OUT_OF_RANGE:
+    stream << "value out of range";
+    break;
+  case field_error_t::CHANGED_CELL:
+    stream << "initial value changed";
+    break;
+  case field_error_t::DUPLICATE_IN_ROW:
+    stream << "duplicate value in row";
+    break;
+  case field_error_t::DUPLICATE_IN_COLUMN:
+    stream << "duplicate value in column";
+    break;
+  case field_error_t::DUPLICATE_IN_BLOCK:
+    stream << "duplicate value in block";
+    break;
   }
-  return true;
-}
\ No newline at end of file
+  return stream << " at (" << error.row << ", " << error.col << ")";
+}
+
+bool check_field(const std::vector<std::vector<int>>& init_field,
+                 const std::vector<std::vector<int>>& solution) {
+  return !validate_solution(init_field, solution);
+}
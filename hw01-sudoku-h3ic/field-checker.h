@@ -1,5 +1,41 @@
 #pragma once
 
+#include <ostream>
 #include <vector>
 
+#include "sudoku-solver.h"
+
+// the first problem found in a solution by validate_solution
+struct field_error_t {
+  enum kind_t {
+    NONE,
+    // solution isn't FIELD_SIZE x FIELD_SIZE
+    WRONG_SIZE,
+    // cell (row, col) isn't a digit 1-9
+    OUT_OF_RANGE,
+    // cell (row, col) differs from the non-empty initial cell
+    CHANGED_CELL,
+    // cell (row, col) repeats a digit of its row, column or block
+    DUPLICATE_IN_ROW,
+    DUPLICATE_IN_COLUMN,
+    DUPLICATE_IN_BLOCK
+  };
+
+  kind_t kind{NONE};
+  int row{-1};
+  int col{-1};
+
+  explicit operator bool() const {
+    return kind != NONE;
+  }
+};
+
+std::ostream &operator<<(std::ostream &stream, const field_error_t &error);
+
+// checks the solution in a single pass with row/column/block digit masks,
+// nothing is allocated
+field_error_t validate_solution(const std::vector<std::vector<int>> &init_field,
+                                const std::vector<std::vector<int>> &solution);
+field_error_t validate_solution(const board_t &init_board, const board_t &solution);
+
 bool check_field(const std::vector<std::vector<int>> &init_field, const std::vector<std::vector<int>> &solution);
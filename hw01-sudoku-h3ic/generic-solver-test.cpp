@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "sudoku-solver-generic.h"
+
+// solution counts of sudoku_solver_t for sizes other than the classic 9x9,
+// every field is solved with every combination of search options
+
+#define CHECK(condition)                                                  \
+  do {                                                                    \
+    if (!(condition)) {                                                   \
+      std::cerr << __FILE__ << ":" << __LINE__ << ": " << #condition      \
+                << " failed" << std::endl;                                \
+      std::exit(1);                                                       \
+    }                                                                     \
+  } while (false)
+
+template <size_t N>
+using board_of_t = typename sudoku_solver_t<N>::board_t;
+
+// solved field, row r is the first one shifted by N * (r % N) + r / N
+template <size_t N>
+board_of_t<N> pattern_board() {
+  constexpr size_t SIDE = N * N;
+  board_of_t<N> board{};
+  for (size_t row = 0; row < SIDE; ++row) {
+    for (size_t col = 0; col < SIDE; ++col) {
+      board[row * SIDE + col] = (N * (row % N) + row / N + col) % SIDE + 1;
+    }
+  }
+  return board;
+}
+
+// solution keeps the givens of field and has every digit once in every row,
+// column and block
+template <size_t N>
+bool is_solution(const board_of_t<N>& field, const board_of_t<N>& solution) {
+  constexpr size_t SIDE = N * N;
+  std::vector<uint64_t> rows(SIDE), cols(SIDE), blocks(SIDE);
+  for (size_t cell = 0; cell < SIDE * SIDE; ++cell) {
+    int value = solution[cell];
+    if (value < 1 || value > static_cast<int>(SIDE) ||
+        (field[cell] != 0 && field[cell] != value)) {
+      return false;
+    }
+    size_t row = cell / SIDE;
+    size_t col = cell % SIDE;
+    uint64_t bit = uint64_t{1} << (value - 1);
+    rows[row] |= bit;
+    cols[col] |= bit;
+    blocks[row - row % N + col / N] |= bit;
+  }
+  uint64_t all = ~uint64_t{0} >> (64 - SIDE);
+  for (size_t unit = 0; unit < SIDE; ++unit) {
+    if (rows[unit] != all || cols[unit] != all || blocks[unit] != all) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// solves field with every option combination, also on several threads and
+// with the count capped
+template <size_t N>
+void check_count(const board_of_t<N>& field, size_t expected_count) {
+  for (int variant = 0; variant < 8; ++variant) {
+    solver_options_t options;
+    options.min_remaining_values = (variant & 1) != 0;
+    options.propagate_singles = (variant & 2) != 0;
+    options.threads_count = (variant & 4) != 0 ? 4 : 1;
+    board_of_t<N> board = field;
+    CHECK(sudoku_solver_t<N>::solve(board, options) == expected_count);
+    CHECK(expected_count == 0 ? board == field
+                              : is_solution<N>(field, board));
+
+    options.max_solutions = 1;
+    board = field;
+    CHECK(sudoku_solver_t<N>::solve(board, options) ==
+          std::min<size_t>(expected_count, 1));
+  }
+}
+
+template <size_t N>
+void check_field_size() {
+  constexpr size_t SIDE = N * N;
+  const board_of_t<N> solved = pattern_board<N>();
+  CHECK(is_solution<N>(solved, solved));
+  check_count<N>(solved, 1);
+
+  // one empty cell in every row and column is a naked single
+  board_of_t<N> field = solved;
+  for (size_t i = 0; i < SIDE; ++i) {
+    field[i * SIDE + i] = 0;
+  }
+  check_count<N>(field, 1);
+
+  // rows of the first two columns hold consecutive digits, which are placed
+  // either in the same or in the swapped order in all rows
+  field = solved;
+  for (size_t row = 0; row < SIDE; ++row) {
+    field[row * SIDE] = 0;
+    field[row * SIDE + 1] = 0;
+  }
+  check_count<N>(field, 2);
+
+  // the same digit twice in a block
+  field = solved;
+  field[SIDE + 1] = 0;
+  field[SIDE] = field[0];
+  check_count<N>(field, 0);
+
+  // a half empty field has at least the pattern solution
+  std::mt19937 gen(N);
+  field = solved;
+  for (auto& cell : field) {
+    if (gen() % 2 == 0) {
+      cell = 0;
+    }
+  }
+  solver_options_t options;
+  options.max_solutions = 1;
+  board_of_t<N> board = field;
+  CHECK(sudoku_solver_t<N>::solve(board, options) == 1);
+  CHECK(is_solution<N>(field, board));
+}
+
+int main() {
+  check_field_size<2>();
+  check_field_size<4>();
+
+  // the empty 4x4 field has 288 solutions
+  check_count<2>(board_of_t<2>{}, 288);
+  std::cout << "OK" << std::endl;
+  return 0;
+}
@@ -0,0 +1,461 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "sudoku-solver.h"
+#include "work-stealing.h"
+
+// bitmask sudoku solver for a field of N x N blocks of N x N cells, i.e.
+// N = 3 is the classic 9x9 sudoku, N = 4 is 16x16 and N = 5 is 25x25.
+// Every size is a separate instantiation: the mask width, the cell index
+// width and all loop bounds are compile-time constants.
+//
+// The search keeps row/column/block digit masks: bit (d - 1) of a mask is
+// set when digit d is already used in that row, column or block. The board
+// is flat and is modified in place, so no search node allocates.
+template <size_t N>
+class sudoku_solver_t {
+public:
+  static constexpr size_t SIDE = N * N;
+  static constexpr size_t CELLS = SIDE * SIDE;
+  static constexpr size_t UNITS = 3 * SIDE;
+
+  static_assert(N >= 2 && SIDE <= 64, "digits must fit into a 64-bit mask");
+
+  // the narrowest unsigned type with a bit for every digit
+  using mask_t = std::conditional_t<
+      SIDE <= 16, uint16_t,
+      std::conditional_t<SIDE <= 32, uint32_t, uint64_t>>;
+  // the narrowest unsigned type for a cell index
+  using index_t = std::conditional_t<CELLS <= 256, uint8_t, uint16_t>;
+  // row-major flat field, cell (i, j) is board[i * SIDE + j], 0 is empty
+  using board_t = std::array<uint8_t, CELLS>;
+
+  sudoku_solver_t(const board_t& board, const solver_options_t& options)
+      : board_(board), options_(options) {
+    for (size_t cell = 0; cell < CELLS; ++cell) {
+      int value = board_[cell];
+      if (value == 0) {
+        continue;
+      }
+      // out of range or the same digit twice in one row, column or block
+      if (value > static_cast<int>(SIDE) ||
+          (candidates(cell) & digit_bit(value)) == 0) {
+        consistent_ = false;
+        return;
+      }
+      place(cell, value);
+    }
+  }
+
+  // solves board in place: counts solutions up to options.max_solutions
+  // (on options.threads_count threads) and writes the first solution found
+  // back into board, which is left untouched if there are none
+  static size_t solve(board_t& board, const solver_options_t& options) {
+    if (options.threads_count != 1) {
+      return solve_in_parallel(board, options);
+    }
+    sudoku_solver_t solver(board, options);
+    size_t solutions_count = solver.solve();
+    if (solver.has_solution()) {
+      board = solver.solution();
+    }
+    if (options.nodes_counter != nullptr) {
+      *options.nodes_counter += solver.nodes_count();
+    }
+    return solutions_count;
+  }
+
+  // counts solutions up to options.max_solutions, the first one found is
+  // kept in solution()
+  size_t solve() {
+    if (!consistent_ || options_.max_solutions == 0) {
+      return 0;
+    }
+    solve_recursively();
+    return solutions_count_;
+  }
+
+  // visits the current node only: a complete board is counted as a
+  // solution, otherwise the boards of all its children are appended to
+  // children, so that their subtrees can be searched independently
+  void expand(std::vector<board_t>* children) {
+    if (!consistent_) {
+      return;
+    }
+    ++nodes_count_;
+    if (options_.propagate_singles && !propagate_singles()) {
+      return;
+    }
+    if (filled_count_ == CELLS) {
+      record_solution();
+      return;
+    }
+    size_t cell = select_cell();
+    if (cell == CELLS) {
+      return;
+    }
+    for (mask_t mask = candidates(cell); mask != 0; mask &= mask - 1) {
+      children->push_back(board_);
+      children->back()[cell] = lowest_digit(mask);
+    }
+  }
+
+  bool has_solution() const {
+    return has_solution_;
+  }
+
+  const board_t& solution() const {
+    return solution_;
+  }
+
+  size_t nodes_count() const {
+    return nodes_count_;
+  }
+
+private:
+  static constexpr mask_t ALL_DIGITS =
+      static_cast<mask_t>(~uint64_t{0} >> (64 - SIDE));
+
+  // the first branching levels are split into subtrees until there are at
+  // least this many subtrees per thread (or MAX_SPLIT_DEPTH levels are split)
+  static constexpr size_t TASKS_PER_THREAD = 16;
+  static constexpr size_t MAX_SPLIT_DEPTH = 8;
+
+  struct cell_tables_t {
+    std::array<index_t, CELLS> row{};
+    std::array<index_t, CELLS> col{};
+    std::array<index_t, CELLS> block{};
+    // cells of every unit: rows first, then columns, then blocks
+    std::array<std::array<index_t, SIDE>, UNITS> units{};
+  };
+
+  static constexpr cell_tables_t make_cell_tables() {
+    cell_tables_t tables;
+    std::array<size_t, SIDE> block_size{};
+    for (size_t cell = 0; cell < CELLS; ++cell) {
+      size_t row = cell / SIDE;
+      size_t col = cell % SIDE;
+      size_t block = row - row % N + col / N;
+      tables.row[cell] = row;
+      tables.col[cell] = col;
+      tables.block[cell] = block;
+      tables.units[row][col] = cell;
+      tables.units[SIDE + col][row] = cell;
+      tables.units[2 * SIDE + block][block_size[block]++] = cell;
+    }
+    return tables;
+  }
+
+  // row, column, block and unit cells of every flat board cell
+  static constexpr cell_tables_t CELL = make_cell_tables();
+
+  static mask_t digit_bit(int value) {
+    return static_cast<mask_t>(mask_t{1} << (value - 1));
+  }
+
+  static int lowest_digit(mask_t mask) {
+    return __builtin_ctzll(mask) + 1;
+  }
+
+  static int digits_count(mask_t mask) {
+    return __builtin_popcountll(mask);
+  }
+
+  mask_t candidates(size_t cell) const {
+    return static_cast<mask_t>(~(rows_[CELL.row[cell]] | cols_[CELL.col[cell]] |
+                                 blocks_[CELL.block[cell]]) &
+                               ALL_DIGITS);
+  }
+
+  mask_t unit_digits(size_t unit) const {
+    if (unit < SIDE) {
+      return rows_[unit];
+    }
+    if (unit < 2 * SIDE) {
+      return cols_[unit - SIDE];
+    }
+    return blocks_[unit - 2 * SIDE];
+  }
+
+  void place(size_t cell, int value) {
+    mask_t bit = digit_bit(value);
+    board_[cell] = value;
+    rows_[CELL.row[cell]] |= bit;
+    cols_[CELL.col[cell]] |= bit;
+    blocks_[CELL.block[cell]] |= bit;
+    ++filled_count_;
+  }
+
+  void remove(size_t cell) {
+    mask_t bit = digit_bit(board_[cell]);
+    board_[cell] = 0;
+    rows_[CELL.row[cell]] &= ~bit;
+    cols_[CELL.col[cell]] &= ~bit;
+    blocks_[CELL.block[cell]] &= ~bit;
+    --filled_count_;
+  }
+
+  // placement which is undone by undo_to
+  void assign(size_t cell, int value) {
+    place(cell, value);
+    trail_[trail_size_++] = cell;
+  }
+
+  void undo_to(size_t trail_mark) {
+    while (trail_size_ > trail_mark) {
+      remove(trail_[--trail_size_]);
+    }
+  }
+
+  // fills naked singles (cells with one candidate) and hidden singles
+  // (digits with one possible cell in a unit) until nothing changes,
+  // returns false if the board turns out to be contradictory
+  bool propagate_singles() {
+    bool changed = true;
+    while (changed) {
+      changed = false;
+      for (size_t cell = 0; cell < CELLS; ++cell) {
+        if (board_[cell] != 0) {
+          continue;
+        }
+        mask_t mask = candidates(cell);
+        if (mask == 0) {
+          return false;
+        }
+        if ((mask & (mask - 1)) == 0) {
+          assign(cell, lowest_digit(mask));
+          changed = true;
+        }
+      }
+
+      for (size_t unit = 0; unit < UNITS; ++unit) {
+        // digits possible in at least one and in at least two cells
+        mask_t once = 0;
+        mask_t twice = 0;
+        for (index_t cell : CELL.units[unit]) {
+          if (board_[cell] == 0) {
+            mask_t mask = candidates(cell);
+            twice |= once & mask;
+            once |= mask;
+          }
+        }
+        if ((once | unit_digits(unit)) != ALL_DIGITS) {
+          return false;
+        }
+        for (mask_t singles = once & ~twice; singles != 0;
+             singles &= singles - 1) {
+          int value = lowest_digit(singles);
+          for (index_t cell : CELL.units[unit]) {
+            if (board_[cell] == 0 && (candidates(cell) & digit_bit(value))) {
+              assign(cell, value);
+              changed = true;
+              break;
+            }
+          }
+          // the only cell for the digit was taken by another single
+          if ((unit_digits(unit) & digit_bit(value)) == 0) {
+            return false;
+          }
+        }
+      }
+    }
+    return true;
+  }
+
+  // empty cell to branch on, CELLS if it has no candidates at all
+  size_t select_cell() const {
+    if (!options_.min_remaining_values) {
+      size_t cell = 0;
+      while (board_[cell] != 0) {
+        ++cell;
+      }
+      return candidates(cell) == 0 ? CELLS : cell;
+    }
+    size_t best_cell = CELLS;
+    int best_count = SIDE + 1;
+    for (size_t cell = 0; cell < CELLS; ++cell) {
+      if (board_[cell] != 0) {
+        continue;
+      }
+      int count = digits_count(candidates(cell));
+      if (count < best_count) {
+        best_cell = count == 0 ? CELLS : cell;
+        best_count = count;
+        if (count <= 1) {
+          break;
+        }
+      }
+    }
+    return best_cell;
+  }
+
+  void record_solution() {
+    if (!has_solution_) {
+      solution_ = board_;
+      has_solution_ = true;
+    }
+    ++solutions_count_;
+    if (shared_solutions_count_ != nullptr) {
+      shared_solutions_count_->fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  // options.max_solutions are found by this solver or, in a parallel search,
+  // by all solvers together
+  bool enough_solutions() const {
+    if (shared_solutions_count_ != nullptr) {
+      return shared_solutions_count_->load(std::memory_order_relaxed) >=
+             options_.max_solutions;
+    }
+    return solutions_count_ >= options_.max_solutions;
+  }
+
+  void solve_recursively() {
+    ++nodes_count_;
+    size_t trail_mark = trail_size_;
+    if (options_.propagate_singles && !propagate_singles()) {
+      undo_to(trail_mark);
+      return;
+    }
+    if (filled_count_ == CELLS) {
+      record_solution();
+      undo_to(trail_mark);
+      return;
+    }
+
+    size_t cell = select_cell();
+    if (cell != CELLS) {
+      for (mask_t mask = candidates(cell);
+           mask != 0 && !enough_solutions(); mask &= mask - 1) {
+        assign(cell, lowest_digit(mask));
+        solve_recursively();
+        undo_to(trail_size_ - 1);
+      }
+    }
+    undo_to(trail_mark);
+  }
+
+  // counts solutions like solve(), but the subtrees below the first
+  // branching levels are searched by a pool of work-stealing threads, each
+  // of them with its own counters which are summed up at the end. All
+  // searches also add to one shared count and stop once it reaches
+  // max_solutions
+  static size_t solve_in_parallel(board_t& board,
+                                  const solver_options_t& options) {
+    size_t threads_count = options.threads_count;
+    if (threads_count == 0) {
+      threads_count = std::max(1U, std::thread::hardware_concurrency());
+    }
+    solver_options_t task_options = options;
+    task_options.threads_count = 1;
+    task_options.nodes_counter = nullptr;
+
+    size_t solutions_count = 0;
+    size_t nodes_count = 0;
+    bool has_solution = false;
+    board_t solution{};
+
+    std::vector<board_t> tasks = {board};
+    for (size_t depth = 0; depth < MAX_SPLIT_DEPTH && !tasks.empty() &&
+                           tasks.size() < threads_count * TASKS_PER_THREAD &&
+                           solutions_count < options.max_solutions;
+         ++depth) {
+      std::vector<board_t> children;
+      for (const auto& task : tasks) {
+        sudoku_solver_t solver(task, task_options);
+        solver.expand(&children);
+        nodes_count += solver.nodes_count();
+        if (solver.has_solution()) {
+          ++solutions_count;
+          if (!has_solution) {
+            solution = solver.solution();
+            has_solution = true;
+          }
+        }
+      }
+      tasks = std::move(children);
+    }
+    if (solutions_count >= options.max_solutions) {
+      tasks.clear();
+    }
+
+    struct alignas(64) worker_result_t {
+      size_t solutions_count{0};
+      size_t nodes_count{0};
+      // the solution of the task with the smallest index among solved ones
+      size_t solution_task{0};
+      bool has_solution{false};
+      board_t solution{};
+    };
+    std::vector<worker_result_t> results(threads_count);
+    std::atomic<size_t> found_count{solutions_count};
+
+    run_work_stealing(
+        tasks.size(), threads_count, [&](size_t task, size_t worker) {
+          if (found_count.load(std::memory_order_relaxed) >=
+              options.max_solutions) {
+            return;
+          }
+          sudoku_solver_t solver(tasks[task], task_options);
+          solver.shared_solutions_count_ = &found_count;
+          size_t count = solver.solve();
+
+          worker_result_t& result = results[worker];
+          result.solutions_count += count;
+          result.nodes_count += solver.nodes_count();
+          if (solver.has_solution() &&
+              (!result.has_solution || task < result.solution_task)) {
+            result.solution_task = task;
+            result.has_solution = true;
+            result.solution = solver.solution();
+          }
+        });
+
+    const worker_result_t* best = nullptr;
+    for (const auto& result : results) {
+      solutions_count += result.solutions_count;
+      nodes_count += result.nodes_count;
+      if (result.has_solution &&
+          (best == nullptr || result.solution_task < best->solution_task)) {
+        best = &result;
+      }
+    }
+    if (!has_solution && best != nullptr) {
+      solution = best->solution;
+      has_solution = true;
+    }
+
+    if (has_solution) {
+      board = solution;
+    }
+    if (options.nodes_counter != nullptr) {
+      *options.nodes_counter += nodes_count;
+    }
+    return std::min(solutions_count, options.max_solutions);
+  }
+
+  board_t board_;
+  board_t solution_{};
+  solver_options_t options_;
+  std::array<mask_t, SIDE> rows_{};
+  std::array<mask_t, SIDE> cols_{};
+  std::array<mask_t, SIDE> blocks_{};
+  // cells assigned during the search, in order of assignment
+  std::array<index_t, CELLS> trail_{};
+  size_t trail_size_{0};
+  size_t filled_count_{0};
+  size_t nodes_count_{0};
+  size_t solutions_count_{0};
+  // solutions of all solvers of a parallel search, null for a single solver
+  std::atomic<size_t>* shared_solutions_count_{nullptr};
+  bool consistent_{true};
+  bool has_solution_{false};
+};
@@ -1,5 +1,7 @@
 #include "sudoku-solver.h"
+#include "sudoku-solver-generic.h"
 #include <set>
+#include <type_traits>
 
 std::set<int> find_possible_values(const std::vector<std::vector<int>>& field,
                                    const std::pair<int, int>& empty_pos) {
@@ -54,31 +56,115 @@ bool is_complete(const std::vector<std::vector<int>>& field) {
 }
 
 
-size_t solve_recursively(std::vector<std::vector<int>> field) {
-  if (is_complete(field)) {
-    auto *solution = &field;
+// fills empty cells of field in place and restores them before returning,
+// so the whole search works on a single copy of the field. Stops as soon as
+// max_solutions solutions are found
+size_t solve_recursively(std::vector<std::vector<int>>& field,
+                         std::vector<std::vector<int>>* solution,
+                         size_t* nodes_counter, size_t max_solutions) {
+  if (nodes_counter != nullptr) {
+    ++*nodes_counter;
+  }
+  const auto empty_pos = find_empty_position(field);
+  if (empty_pos.first == -1) {
+    // keep the first solution found
+    if (solution->empty()) {
+      *solution = field;
+    }
     return 1;
   }
   size_t sum = 0;
-  const auto& empty_pos = find_empty_position(field);
   const auto& possible_values = find_possible_values(field, empty_pos);
   const int& row = empty_pos.first;
   const int& col = empty_pos.second;
 
   for (const auto& value : possible_values) {
+    if (sum == max_solutions) {
+      break;
+    }
     field[row][col] = value;
-    sum += solve_recursively(field);
+    sum += solve_recursively(field, solution, nodes_counter,
+                             max_solutions - sum);
   }
+  field[row][col] = 0;
   return sum;
 }
 
+// the classic 9x9 field is the 3x3 blocks instantiation of the generic solver
+using bitmask_solver_t = sudoku_solver_t<3>;
+static_assert(std::is_same_v<bitmask_solver_t::board_t, board_t>);
+
+board_t to_board(const std::vector<std::vector<int>>& field) {
+  board_t board{};
+  for (size_t row = 0; row < FIELD_SIZE; ++row) {
+    for (size_t col = 0; col < FIELD_SIZE; ++col) {
+      board[row * FIELD_SIZE + col] = field[row][col];
+    }
+  }
+  return board;
+}
+
+std::vector<std::vector<int>> to_field(const board_t& board) {
+  std::vector<std::vector<int>> field(FIELD_SIZE,
+                                      std::vector<int>(FIELD_SIZE));
+  for (size_t row = 0; row < FIELD_SIZE; ++row) {
+    for (size_t col = 0; col < FIELD_SIZE; ++col) {
+      field[row][col] = board[row * FIELD_SIZE + col];
+    }
+  }
+  return field;
+}
+
+size_t sudoku_solve(board_t& board) {
+  return sudoku_solve(board, solver_options_t{});
+}
+
+size_t sudoku_solve(board_t& board, const solver_options_t& options) {
+  return bitmask_solver_t::solve(board, options);
+}
+
 std::pair<size_t, std::vector<std::vector<int>>>
 sudoku_solve(const std::vector<std::vector<int>>& field) {
-    std::vector<std::vector<int>> solution;
+  return sudoku_solve(field, solver_options_t{});
+}
+
+std::pair<size_t, std::vector<std::vector<int>>>
+sudoku_solve(const std::vector<std::vector<int>>& field,
+             solver_backend_t backend) {
+  solver_options_t options;
+  options.backend = backend;
+  return sudoku_solve(field, options);
+}
+
+std::pair<size_t, std::vector<std::vector<int>>>
+sudoku_solve(const std::vector<std::vector<int>>& field, size_t max_solutions) {
+  solver_options_t options;
+  options.max_solutions = max_solutions;
+  return sudoku_solve(field, options);
+}
+
+std::pair<size_t, std::vector<std::vector<int>>>
+sudoku_solve(const std::vector<std::vector<int>>& field,
+             const solver_options_t& options) {
+  if (options.backend == solver_backend_t::BITMASK) {
+    board_t board = to_board(field);
+    size_t solutions_count = sudoku_solve(board, options);
+    if (solutions_count == 0) {
+      return {0, {}};
+    }
+    return {solutions_count, to_field(board)};
+  }
+
   // if initial field is full
   if (is_complete(field)) {
-    return {1, field};
+    return {options.max_solutions == 0 ? 0 : 1, field};
   }
   auto non_const_field = field;
-  return {solve_recursively(non_const_field), *solution};
-}
\ No newline at end of file
+  std::vector<std::vector<int>> solution;
+  size_t solutions_count =
+      options.max_solutions == 0
+          ? 0
+          : solve_recursively(non_const_field, &solution,
+                              options.nodes_counter, options.max_solutions);
+  return {solutions_count, solution};
+}
@@ -1,8 +1,59 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <utility>
 #include <vector>
 
 static constexpr size_t FIELD_SIZE = 9;
+static constexpr size_t CELLS_COUNT = FIELD_SIZE * FIELD_SIZE;
+
+// row-major flat field, cell (i, j) is board[i * FIELD_SIZE + j], 0 is empty
+using board_t = std::array<uint8_t, CELLS_COUNT>;
+
+// search backends available for sudoku_solve
+enum class solver_backend_t {
+  // candidates are collected into std::set by scanning row, column and block
+  SET_SCAN,
+  // candidates come from row/column/block digit masks kept up to date on
+  // every placement and removal
+  BITMASK
+};
+
+// search settings for sudoku_solve, the defaults are the fastest ones
+struct solver_options_t {
+  solver_backend_t backend{solver_backend_t::BITMASK};
+  // branch on the empty cell with the fewest candidates instead of the first
+  // empty cell in row-major order (BITMASK only)
+  bool min_remaining_values{true};
+  // fill naked and hidden singles before every branching (BITMASK only)
+  bool propagate_singles{true};
+  // the search stops once this many solutions are found, so the returned
+  // count is min(solutions count, max_solutions)
+  size_t max_solutions{std::numeric_limits<size_t>::max()};
+  // number of threads counting solutions (BITMASK only), 0 means one per
+  // hardware thread
+  size_t threads_count{1};
+  // if not null, the number of visited search nodes is added to it
+  size_t *nodes_counter{nullptr};
+};
 
 std::pair<size_t, std::vector<std::vector<int>>> sudoku_solve(const std::vector<std::vector<int>> &field);
+
+std::pair<size_t, std::vector<std::vector<int>>> sudoku_solve(const std::vector<std::vector<int>> &field,
+                                                              solver_backend_t backend);
+
+// counts at most max_solutions solutions, e.g. max_solutions = 2 tells
+// whether the field has no solutions, a unique one or several
+std::pair<size_t, std::vector<std::vector<int>>> sudoku_solve(const std::vector<std::vector<int>> &field,
+                                                              size_t max_solutions);
+
+std::pair<size_t, std::vector<std::vector<int>>> sudoku_solve(const std::vector<std::vector<int>> &field,
+                                                              const solver_options_t &options);
+
+// solves board in place without any heap allocations: on return board holds
+// the first solution found (it is left untouched if there are none)
+size_t sudoku_solve(board_t &board);
+size_t sudoku_solve(board_t &board, const solver_options_t &options);
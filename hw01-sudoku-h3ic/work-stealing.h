@@ -0,0 +1,73 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// runs job(job_index, worker_index) for every job_index in [0, jobs_count) on
+// threads_count threads (the calling thread is one of them). Every worker
+// starts with its own contiguous range of jobs and takes them from the front;
+// once its range is empty it steals jobs from the back of the other ranges.
+template <typename job_t>
+void run_work_stealing(size_t jobs_count, size_t threads_count,
+                       const job_t& job) {
+  if (jobs_count == 0) {
+    return;
+  }
+  threads_count = std::max<size_t>(1, std::min(threads_count, jobs_count));
+
+  // jobs [begin, end) not taken yet, padded to keep workers off each other's
+  // cache lines
+  struct alignas(64) range_t {
+    std::mutex mutex;
+    size_t begin{0};
+    size_t end{0};
+  };
+  std::vector<range_t> ranges(threads_count);
+  for (size_t worker = 0; worker < threads_count; ++worker) {
+    ranges[worker].begin = jobs_count * worker / threads_count;
+    ranges[worker].end = jobs_count * (worker + 1) / threads_count;
+  }
+
+  const auto take_own = [&ranges](size_t worker, size_t* job_index) {
+    std::lock_guard<std::mutex> lock(ranges[worker].mutex);
+    if (ranges[worker].begin == ranges[worker].end) {
+      return false;
+    }
+    *job_index = ranges[worker].begin++;
+    return true;
+  };
+
+  const auto steal = [&ranges, threads_count](size_t worker,
+                                              size_t* job_index) {
+    for (size_t shift = 1; shift < threads_count; ++shift) {
+      range_t& victim = ranges[(worker + shift) % threads_count];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if (victim.begin != victim.end) {
+        *job_index = --victim.end;
+        return true;
+      }
+    }
+    return false;
+  };
+
+  // jobs are never added, so a worker that finds nothing to steal is done
+  const auto work = [&](size_t worker) {
+    size_t job_index = 0;
+    while (take_own(worker, &job_index) || steal(worker, &job_index)) {
+      job(job_index, worker);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(threads_count - 1);
+  for (size_t worker = 1; worker < threads_count; ++worker) {
+    threads.emplace_back(work, worker);
+  }
+  work(0);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
@@ -0,0 +1,156 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "number.h"
+
+// every algorithm is forced by thresholds, so crossover points can be read from the results
+enum algorithm_t { SCHOOLBOOK, KARATSUBA, TOOM3, DEFAULT };
+
+static number_t::thresholds_t thresholds_for(algorithm_t algorithm) {
+  number_t::thresholds_t thresholds;
+  switch (algorithm) {
+  case SCHOOLBOOK:
+    thresholds.karatsuba = SIZE_MAX;
+    thresholds.recursive_division = SIZE_MAX;
+    break;
+  case KARATSUBA:
+    thresholds.toom3 = SIZE_MAX;
+    break;
+  case TOOM3:
+    thresholds.toom3 = thresholds.karatsuba;
+    break;
+  case DEFAULT:
+    break;
+  }
+  return thresholds;
+}
+
+static number_t random_number(std::mt19937_64 &gen, size_t limbs_count) {
+  number_t result = 1;
+  for (size_t i = 0; i < limbs_count; ++i) {
+    for (size_t j = 0; j < 4; ++j) {
+      result <<= 16;
+      result |= static_cast<long>(gen() & 0xffff);
+    }
+  }
+  return result;
+}
+
+static void BM_multiply(benchmark::State &state) {
+  const number_t::thresholds_t defaults = number_t::thresholds;
+  std::mt19937_64 gen(state.range(0));
+  number_t a = random_number(gen, state.range(0));
+  number_t b = random_number(gen, state.range(0));
+  number_t::thresholds = thresholds_for(static_cast<algorithm_t>(state.range(1)));
+  // a * b is a lazy expression, the product is computed only by conversion to number_t
+  number_t product;
+  for (auto _ : state) {
+    product = a * b;
+    benchmark::DoNotOptimize(product);
+  }
+  number_t::thresholds = defaults;
+}
+
+// 2n-limb dividend by n-limb divisor, recursive division when it is not forced to be schoolbook
+static void BM_divide(benchmark::State &state) {
+  const number_t::thresholds_t defaults = number_t::thresholds;
+  std::mt19937_64 gen(state.range(0));
+  number_t a = random_number(gen, 2 * state.range(0));
+  number_t b = random_number(gen, state.range(0));
+  number_t::thresholds = thresholds_for(static_cast<algorithm_t>(state.range(1)));
+  if (state.range(1) != SCHOOLBOOK) {
+    number_t::thresholds.recursive_division = state.range(2);
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(a / b);
+  }
+  number_t::thresholds = defaults;
+}
+
+// decimal conversions of n-limb values, radix_conversion is the size of the parts which aren't split
+static void BM_to_chars(benchmark::State &state) {
+  const number_t::thresholds_t defaults = number_t::thresholds;
+  std::mt19937_64 gen(state.range(0));
+  number_t num = random_number(gen, state.range(0));
+  std::string buffer(num.max_chars_size(), '\0');
+  number_t::thresholds.radix_conversion = state.range(1);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(to_chars(buffer.data(), buffer.data() + buffer.size(), num));
+  }
+  number_t::thresholds = defaults;
+}
+
+static void BM_from_chars(benchmark::State &state) {
+  const number_t::thresholds_t defaults = number_t::thresholds;
+  std::mt19937_64 gen(state.range(0));
+  std::string text = static_cast<std::string>(random_number(gen, state.range(0)));
+  number_t num;
+  number_t::thresholds.radix_conversion = state.range(1);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(from_chars(text.data(), text.data() + text.size(), num));
+  }
+  number_t::thresholds = defaults;
+}
+
+// sums of int64_t values, batch or one at a time through the operator
+static void BM_add_small(benchmark::State &state) {
+  std::mt19937_64 gen(state.range(0));
+  std::vector<number_t> a(state.range(0));
+  std::vector<number_t> b(state.range(0));
+  std::vector<number_t> result(state.range(0));
+  for (size_t i = 0; i < a.size(); ++i) {
+    a[i] = static_cast<long>(gen() >> 2);
+    b[i] = static_cast<long>(gen() >> 2);
+  }
+  for (auto _ : state) {
+    if (state.range(1) != 0) {
+      number_t::batch_add(a.data(), b.data(), result.data(), a.size());
+    } else {
+      for (size_t i = 0; i < a.size(); ++i) {
+        result[i] = a[i] + b[i];
+      }
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * a.size());
+}
+
+static void multiply_arguments(benchmark::internal::Benchmark *benchmark) {
+  benchmark->ArgNames({"limbs", "algorithm"});
+  for (int64_t limbs = 8; limbs <= 2048; limbs *= 2) {
+    for (int algorithm : {SCHOOLBOOK, KARATSUBA, TOOM3, DEFAULT}) {
+      benchmark->Args({limbs, algorithm});
+    }
+  }
+}
+
+static void divide_arguments(benchmark::internal::Benchmark *benchmark) {
+  benchmark->ArgNames({"limbs", "algorithm", "recursive_division"});
+  for (int64_t limbs = 16; limbs <= 2048; limbs *= 2) {
+    benchmark->Args({limbs, SCHOOLBOOK, 0});
+    for (int64_t threshold : {32, 64, 128}) {
+      benchmark->Args({limbs, DEFAULT, threshold});
+    }
+  }
+}
+
+static void chars_arguments(benchmark::internal::Benchmark *benchmark) {
+  benchmark->ArgNames({"limbs", "radix_conversion"});
+  for (int64_t limbs = 1; limbs <= 4096; limbs *= 4) {
+    for (int64_t threshold : {4, 8, 16, 32}) {
+      benchmark->Args({limbs, threshold});
+    }
+  }
+}
+
+BENCHMARK(BM_multiply)->Apply(multiply_arguments);
+BENCHMARK(BM_divide)->Apply(divide_arguments);
+BENCHMARK(BM_add_small)->ArgNames({"count", "batch"})->ArgsProduct({{1 << 10, 1 << 16}, {0, 1}});
+BENCHMARK(BM_to_chars)->Apply(chars_arguments);
+BENCHMARK(BM_from_chars)->Apply(chars_arguments);
+
+BENCHMARK_MAIN();
@@ -1,10 +1,36 @@
 #include "gtest/gtest.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
 #include <limits>
+#include <new>
+#include <random>
 #include <sstream>
+#include <vector>
 
 #include "number.h"
 
+// counts allocations of the whole test binary, tests compare it before and after their operations
+static std::atomic<size_t> allocations_count{0};
+
+void *operator new(size_t size) {
+  ++allocations_count;
+  if (void *result = std::malloc(size == 0 ? 1 : size)) {
+    return result;
+  }
+  throw std::bad_alloc();
+}
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void operator delete(void *ptr) noexcept {
+  std::free(ptr);
+}
+void operator delete(void *ptr, size_t) noexcept {
+  std::free(ptr);
+}
+#pragma GCC diagnostic pop
+
 TEST(Number, ConstructorsAndAssignments) {
   number_t a;
   ASSERT_EQ(a, number_t(0));
@@ -206,3 +232,383 @@ TEST(Number, BinaryShifts) {
   (ia >>= 2) -= 12;
   ASSERT_EQ(a, ia);
 }
+
+static number_t from_string(const std::string &str) {
+  std::stringstream stream(str);
+  number_t result;
+  stream >> result;
+  return result;
+}
+
+// random value with up to limbs_count 64-bit limbs and random sign
+static number_t random_number(std::mt19937_64 &gen, size_t limbs_count) {
+  number_t result;
+  for (size_t i = 0; i < limbs_count; ++i) {
+    result <<= 32;
+    result |= static_cast<long>(gen() >> 32);
+    result <<= 32;
+    result |= static_cast<long>(gen() >> 32);
+  }
+  return gen() % 2 == 0 ? result : -result;
+}
+
+TEST(Number, BigValues) {
+  number_t factorial = 1;
+  for (long i = 2; i <= 30; ++i) {
+    factorial *= i;
+  }
+  ASSERT_EQ(static_cast<std::string>(factorial), "265252859812191058636308480000000");
+  ASSERT_EQ(factorial, from_string("265252859812191058636308480000000"));
+  for (long i = 30; i >= 2; --i) {
+    factorial /= i;
+  }
+  ASSERT_EQ(factorial, 1);
+
+  number_t power = number_t(1) << 128;
+  ASSERT_EQ(static_cast<std::string>(power), "340282366920938463463374607431768211456");
+  ASSERT_EQ(static_cast<std::string>(-power), "-340282366920938463463374607431768211456");
+  ASSERT_EQ(power - 1, from_string("340282366920938463463374607431768211455"));
+  ASSERT_EQ(static_cast<std::string>(power * power * power % 1000000007), "488314807");
+
+  number_t max_val = std::numeric_limits<int64_t>::max();
+  number_t min_val = std::numeric_limits<int64_t>::min();
+  ASSERT_EQ(static_cast<std::string>(max_val + 1), "9223372036854775808");
+  ASSERT_EQ(static_cast<std::string>(min_val - 1), "-9223372036854775809");
+  ASSERT_EQ(static_cast<std::string>(min_val * min_val), "85070591730234615865843651857942052864");
+  ASSERT_EQ(min_val / -1, max_val + 1);
+  ASSERT_EQ(static_cast<int64_t>(max_val + 1), std::numeric_limits<int64_t>::min());
+
+  std::stringstream stream;
+  stream << power << " " << -power;
+  number_t a;
+  number_t b;
+  stream >> a >> b;
+  ASSERT_EQ(a, power);
+  ASSERT_EQ(b, -power);
+}
+
+TEST(Number, BigIdentities) {
+  std::mt19937_64 gen(42);
+  for (size_t i = 0; i < 300; ++i) {
+    number_t a = random_number(gen, gen() % 6);
+    number_t b = random_number(gen, gen() % 4);
+    if (!b) {
+      b = 3;
+    }
+
+    ASSERT_EQ(a + b - b, a);
+    ASSERT_EQ(a * b / b, a);
+    ASSERT_EQ(a * b, b * a);
+    number_t quotient = a / b;
+    number_t remainder = a % b;
+    ASSERT_EQ(quotient * b + remainder, a);
+    ASSERT_TRUE((remainder >= 0 ? remainder : -remainder) < (b >= 0 ? b : -b));
+    ASSERT_TRUE(!remainder || (remainder < 0) == (a < 0));
+
+    ASSERT_EQ((a ^ b) ^ b, a);
+    ASSERT_EQ((a & b) + (a | b), a + b);
+    ASSERT_EQ(~a, -a - 1);
+    ASSERT_EQ((a << 77) >> 77, a);
+    ASSERT_EQ(a >> 70, a / (number_t(1) << 70) - (a < 0 && a % (number_t(1) << 70) ? 1 : 0));
+    ASSERT_EQ(from_string(static_cast<std::string>(a)), a);
+  }
+}
+
+TEST(Number, InlineLimbs) {
+  number_t one = 1;
+  number_t low = -(number_t(1) << 63);
+  number_t x = number_t(1) << 64;
+  number_t y = (number_t(1) << 126) - 1;
+  number_t z = -y;
+
+  size_t allocations_before = allocations_count;
+  one <<= 64;
+  x += y;
+  x -= y;
+  ASSERT_EQ(allocations_count, allocations_before);
+  x ^= y;
+  x &= z;
+  x |= y;
+  y ^= z;
+  z &= low;
+  ASSERT_EQ(allocations_count, allocations_before);
+
+  ASSERT_EQ(one, number_t(1) << 64);
+  ASSERT_EQ(x, (number_t(1) << 126) - 1);
+  ASSERT_EQ(y, -2);
+  ASSERT_EQ(z, -(number_t(1) << 126));
+  // the only result with a carry into the sign limb, -2^64 needs one limb more than the operands
+  ASSERT_EQ(low & (low - 1), -(number_t(1) << 64));
+  ASSERT_EQ((low - 1) & low, -(number_t(1) << 64));
+}
+
+TEST(Number, InPlaceAddition) {
+  std::mt19937_64 gen(19);
+  number_t a = random_number(gen, 8);
+  a = a < 0 ? -a : a;
+  number_t b = random_number(gen, 4);
+  number_t c = random_number(gen, 4);
+  number_t d = random_number(gen, 4);
+  d = d < 0 ? -d : d;
+  number_t expected = a;
+  for (size_t i = 0; i < 100; ++i) {
+    expected = expected + d;
+  }
+
+  // the sum grows into a carry limb at most once
+  size_t allocations_before = allocations_count;
+  for (size_t i = 0; i < 100; ++i) {
+    a += d;
+  }
+  ASSERT_LE(allocations_count, allocations_before + 1);
+  ASSERT_EQ(a, expected);
+
+  // a has enough limbs for the product and the sum
+  number_t product = b;
+  product *= c;
+  allocations_before = allocations_count;
+  a = b * c + d;
+  ASSERT_EQ(allocations_count, allocations_before);
+  ASSERT_EQ(a + (-d), product);
+  a = -d;
+
+  a += a;
+  ASSERT_EQ(a, -d - d);
+  a -= a;
+  ASSERT_EQ(a, 0);
+}
+
+TEST(Number, FastAlgorithms) {
+  const number_t::thresholds_t defaults = number_t::thresholds;
+  const number_t::thresholds_t schoolbook{SIZE_MAX, SIZE_MAX, SIZE_MAX};
+  // tiny thresholds, so that every algorithm and every recursion level is used
+  const number_t::thresholds_t fast{2, 6, 2};
+
+  std::mt19937_64 gen(17);
+  for (size_t i = 0; i < 200; ++i) {
+    number_t a = random_number(gen, 1 + gen() % 80);
+    number_t b = random_number(gen, 1 + gen() % 40);
+
+    number_t::thresholds = schoolbook;
+    number_t expected_product = a * b;
+    number_t expected_square = a * a;
+    number_t expected_quotient = expected_product / a;
+    number_t expected_remainder = a % b;
+
+    number_t::thresholds = fast;
+    ASSERT_EQ(a * b, expected_product);
+    ASSERT_EQ(a * a, expected_square);
+    ASSERT_EQ(expected_product / a, expected_quotient);
+    ASSERT_EQ(expected_quotient, b);
+    ASSERT_EQ(a % b, expected_remainder);
+    ASSERT_EQ(a / b * b + a % b, a);
+  }
+  number_t::thresholds = defaults;
+}
+
+TEST(Number, MoveAndExpressions) {
+  number_t big = from_string("123456789012345678901234567890");
+  number_t moved(std::move(big));
+  ASSERT_EQ(static_cast<std::string>(moved), "123456789012345678901234567890");
+  ASSERT_EQ(big, 0);
+  big = std::move(moved);
+  ASSERT_EQ(static_cast<std::string>(big), "123456789012345678901234567890");
+  ASSERT_EQ(moved, 0);
+  moved = -big;
+  ASSERT_EQ(big + moved, 0);
+
+  std::mt19937_64 gen(18);
+  for (size_t i = 0; i < 100; ++i) {
+    number_t a = random_number(gen, 1 + gen() % 8);
+    number_t b = random_number(gen, 1 + gen() % 8);
+    number_t c = random_number(gen, 1 + gen() % 8);
+
+    number_t expected = b;
+    expected *= c;
+    expected += a;
+    number_t result = b * c + a;
+    ASSERT_EQ(result, expected);
+    result = a + b * c;
+    ASSERT_EQ(result, expected);
+    result = (a + b) * (c - a);
+    expected = a;
+    expected += b;
+    number_t difference = c;
+    difference -= a;
+    expected *= difference;
+    ASSERT_EQ(result, expected);
+
+    // operands may alias the result
+    expected = a;
+    expected *= b;
+    expected += a;
+    number_t aliased = a;
+    aliased = aliased * b + aliased;
+    ASSERT_EQ(aliased, expected);
+    aliased = a;
+    aliased = b - aliased * aliased;
+    expected = a;
+    expected *= a;
+    ASSERT_EQ(aliased, b - expected);
+  }
+
+  // expressions convert like numbers
+  number_t two = 2;
+  ASSERT_EQ(static_cast<long>(two * 3 + 1), 7);
+  ASSERT_EQ(static_cast<std::string>(two - 5), "-3");
+  ASSERT_TRUE(static_cast<bool>(two * two - 4 + 1));
+  ASSERT_EQ(-(two + 1), -3);
+  ASSERT_EQ((two + 1) << 2, 12);
+  ASSERT_EQ(1 - two * two, -3);
+}
+
+// decimal digits by repeated division by 10
+static std::string reference_digits(number_t num) {
+  bool negative = num < 0;
+  std::string digits;
+  do {
+    digits += static_cast<char>('0' + std::abs(static_cast<long>(num % 10)));
+    num /= 10;
+  } while (num != 0);
+  if (negative) {
+    digits += '-';
+  }
+  return std::string(digits.rbegin(), digits.rend());
+}
+
+static std::string to_chars_string(const number_t &num) {
+  std::string buffer(num.max_chars_size(), '\0');
+  std::to_chars_result result = to_chars(buffer.data(), buffer.data() + buffer.size(), num);
+  EXPECT_EQ(result.ec, std::errc());
+  return buffer.substr(0, result.ptr - buffer.data());
+}
+
+TEST(Number, CharsConversions) {
+  const number_t::thresholds_t defaults = number_t::thresholds;
+  number_t power = 1;
+  for (size_t digits = 0; digits < 60; ++digits) {
+    ASSERT_EQ(to_chars_string(power), "1" + std::string(digits, '0'));
+    ASSERT_EQ(to_chars_string(power - 1), digits == 0 ? "0" : std::string(digits, '9'));
+    power *= 10;
+  }
+  ASSERT_EQ(to_chars_string(std::numeric_limits<int64_t>::min()), "-9223372036854775808");
+
+  std::mt19937_64 gen(19);
+  for (size_t radix_conversion : {defaults.radix_conversion, size_t(1), size_t(3)}) {
+    number_t::thresholds.radix_conversion = radix_conversion;
+    for (size_t i = 0; i < 60; ++i) {
+      number_t num = random_number(gen, 1 + gen() % 80);
+      // long runs of zero digits in the lower parts
+      if (i % 3 == 0) {
+        num *= power * power;
+      }
+      std::string digits = reference_digits(num);
+      ASSERT_EQ(to_chars_string(num), digits);
+      ASSERT_EQ(static_cast<std::string>(num), digits);
+
+      std::string buffer(digits.size(), '\0');
+      std::to_chars_result to = to_chars(buffer.data(), buffer.data() + buffer.size() - 1, num);
+      ASSERT_EQ(to.ec, std::errc::value_too_large);
+      ASSERT_EQ(to.ptr, buffer.data() + buffer.size() - 1);
+
+      digits = "000" + digits.substr(num < 0) + "x";
+      number_t parsed;
+      std::from_chars_result from = from_chars(digits.data(), digits.data() + digits.size(), parsed);
+      ASSERT_EQ(from.ec, std::errc());
+      ASSERT_EQ(from.ptr, digits.data() + digits.size() - 1);
+      ASSERT_EQ(parsed, num < 0 ? -num : num);
+    }
+  }
+  number_t::thresholds = defaults;
+
+  number_t num = 42;
+  for (std::string text : {"", "-", "+1", "x1", " 1"}) {
+    std::from_chars_result result = from_chars(text.data(), text.data() + text.size(), num);
+    ASSERT_EQ(result.ec, std::errc::invalid_argument);
+    ASSERT_EQ(result.ptr, text.data());
+    ASSERT_EQ(num, 42);
+  }
+  std::string text = "-0000";
+  ASSERT_EQ(from_chars(text.data(), text.data() + text.size(), num).ec, std::errc());
+  ASSERT_EQ(num, 0);
+  ASSERT_EQ(to_chars_string(num), "0");
+  text = "-" + std::string(1000, '9');
+  ASSERT_EQ(from_chars(text.data(), text.data() + text.size(), num).ec, std::errc());
+  number_t expected = 1;
+  for (size_t i = 0; i < 1000; ++i) {
+    expected *= 10;
+  }
+  ASSERT_EQ(num, 1 - expected);
+}
+
+TEST(Number, BatchOperations) {
+  std::mt19937_64 gen(20);
+  const int64_t max = std::numeric_limits<int64_t>::max();
+  // values around int64_t limits overflow in some lanes, tail of the last block has 3 elements
+  std::vector<number_t> a;
+  std::vector<number_t> b;
+  for (size_t i = 0; i < 403; ++i) {
+    for (std::vector<number_t> *nums : {&a, &b}) {
+      switch (gen() % 4) {
+      case 0:
+        nums->push_back(static_cast<long>(gen() % 2000) - 1000);
+        break;
+      case 1:
+        nums->push_back(max - static_cast<long>(gen() % 3));
+        break;
+      case 2:
+        nums->push_back(-max + static_cast<long>(gen() % 3));
+        break;
+      default:
+        nums->push_back(random_number(gen, 1 + gen() % 3));
+      }
+    }
+  }
+  size_t count = a.size();
+  std::vector<number_t> result(count);
+
+  number_t::batch_add(a.data(), b.data(), result.data(), count);
+  for (size_t i = 0; i < count; ++i) {
+    ASSERT_EQ(result[i], a[i] + b[i]);
+  }
+  number_t::batch_subtract(a.data(), b.data(), result.data(), count);
+  for (size_t i = 0; i < count; ++i) {
+    ASSERT_EQ(result[i], a[i] - b[i]);
+  }
+  number_t::batch_xor(a.data(), b.data(), result.data(), count);
+  for (size_t i = 0; i < count; ++i) {
+    ASSERT_EQ(result[i], a[i] ^ b[i]);
+  }
+  number_t::batch_and(a.data(), b.data(), result.data(), count);
+  for (size_t i = 0; i < count; ++i) {
+    ASSERT_EQ(result[i], a[i] & b[i]);
+  }
+  number_t::batch_or(a.data(), b.data(), result.data(), count);
+  for (size_t i = 0; i < count; ++i) {
+    ASSERT_EQ(result[i], a[i] | b[i]);
+  }
+  for (size_t bits : {0, 1, 17, 62, 63, 64, 100}) {
+    number_t::batch_shift_left(a.data(), bits, result.data(), count);
+    for (size_t i = 0; i < count; ++i) {
+      ASSERT_EQ(result[i], a[i] << static_cast<long>(bits));
+    }
+    number_t::batch_shift_right(a.data(), bits, result.data(), count);
+    for (size_t i = 0; i < count; ++i) {
+      ASSERT_EQ(result[i], a[i] >> static_cast<long>(bits));
+    }
+  }
+  std::vector<int> order(count);
+  number_t::batch_compare(a.data(), b.data(), order.data(), count);
+  for (size_t i = 0; i < count; ++i) {
+    ASSERT_EQ(order[i], a[i] < b[i] ? -1 : a[i] == b[i] ? 0 : 1);
+  }
+  number_t::batch_compare(a.data(), a.data(), order.data(), count);
+  ASSERT_EQ(std::count(order.begin(), order.end(), 0), count);
+
+  // in place
+  std::vector<number_t> sum = a;
+  number_t::batch_add(sum.data(), b.data(), sum.data(), count);
+  for (size_t i = 0; i < count; ++i) {
+    ASSERT_EQ(sum[i], a[i] + b[i]);
+  }
+}
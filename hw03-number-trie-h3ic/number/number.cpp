@@ -1,145 +1,1093 @@
 #include "number.h"
 
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <cstring>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+__extension__ typedef unsigned __int128 uint128_t;
+
+// limbs
+number_t::limbs_t::limbs_t(const limbs_t &other) {
+  resize(other._size);
+  std::copy(other.data(), other.data() + other._size, data());
+}
+
+number_t::limbs_t::limbs_t(limbs_t &&other) noexcept : _size(other._size), _capacity(other._capacity) {
+  if (other._capacity > INLINE_LIMBS) {
+    _heap = other._heap;
+    other._capacity = INLINE_LIMBS;
+  } else {
+    std::copy(other._inline, other._inline + INLINE_LIMBS, _inline);
+  }
+  other._size = 0;
+}
+
+number_t::limbs_t &number_t::limbs_t::operator=(const limbs_t &other) {
+  if (this != &other) {
+    // reuses own storage if it is large enough
+    _size = 0;
+    resize(other._size);
+    std::copy(other.data(), other.data() + other._size, data());
+  }
+  return *this;
+}
+
+number_t::limbs_t &number_t::limbs_t::operator=(limbs_t &&other) noexcept {
+  limbs_t tmp(std::move(other));
+  swap(tmp);
+  return *this;
+}
+
+number_t::limbs_t::~limbs_t() {
+  if (_capacity > INLINE_LIMBS) {
+    delete[] _heap;
+  }
+}
+
+void number_t::limbs_t::resize(size_t size) {
+  if (size > _capacity) {
+    size_t capacity = std::max<size_t>(size, 2 * _capacity);
+    auto *heap = new uint64_t[capacity];
+    std::copy(data(), data() + _size, heap);
+    if (_capacity > INLINE_LIMBS) {
+      delete[] _heap;
+    }
+    _heap = heap;
+    _capacity = capacity;
+  }
+  if (size > _size) {
+    std::fill(data() + _size, data() + size, 0);
+  }
+  _size = size;
+}
+
+void number_t::limbs_t::normalize() {
+  const uint64_t *limbs = data();
+  while (_size > 0 && limbs[_size - 1] == 0) {
+    --_size;
+  }
+}
+
+void number_t::limbs_t::swap(limbs_t &other) {
+  // inline limbs are swapped together with the union, heap pointers just change owners
+  std::swap(_size, other._size);
+  std::swap(_capacity, other._capacity);
+  uint64_t tmp[INLINE_LIMBS];
+  std::memcpy(tmp, _inline, sizeof(tmp));
+  std::memcpy(_inline, other._inline, sizeof(tmp));
+  std::memcpy(other._inline, tmp, sizeof(tmp));
+}
+
+// operations on magnitudes, limbs are little-endian and sizes may include leading zeros
+
+static int compare_magnitudes(const uint64_t *a, size_t a_size, const uint64_t *b, size_t b_size) {
+  if (a_size != b_size) {
+    return a_size < b_size ? -1 : 1;
+  }
+  for (size_t i = a_size; i-- > 0;) {
+    if (a[i] != b[i]) {
+      return a[i] < b[i] ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+// result has max(a_size, b_size) limbs, it may be the same as a or b, returns the carry limb
+static uint64_t add_magnitudes(const uint64_t *a, size_t a_size, const uint64_t *b, size_t b_size,
+                               uint64_t *result) {
+  if (a_size < b_size) {
+    std::swap(a, b);
+    std::swap(a_size, b_size);
+  }
+  uint64_t carry = 0;
+  for (size_t i = 0; i < a_size; ++i) {
+    uint128_t sum = static_cast<uint128_t>(a[i]) + (i < b_size ? b[i] : 0) + carry;
+    result[i] = static_cast<uint64_t>(sum);
+    carry = static_cast<uint64_t>(sum >> 64);
+  }
+  return carry;
+}
+
+// a >= b, result has a_size limbs, it may be the same as a or b
+static void subtract_magnitudes(const uint64_t *a, size_t a_size, const uint64_t *b, size_t b_size, uint64_t *result) {
+  uint64_t borrow = 0;
+  for (size_t i = 0; i < a_size; ++i) {
+    uint64_t subtrahend = i < b_size ? b[i] : 0;
+    uint64_t difference = a[i] - subtrahend - borrow;
+    borrow = a[i] < subtrahend || (a[i] == subtrahend && borrow != 0);
+    result[i] = difference;
+  }
+  assert(borrow == 0);
+}
+
+// result has a_size + b_size limbs and doesn't overlap inputs
+static void multiply_schoolbook(const uint64_t *a, size_t a_size, const uint64_t *b, size_t b_size,
+                                uint64_t *result) {
+  std::fill(result, result + a_size + b_size, 0);
+  for (size_t i = 0; i < a_size; ++i) {
+    uint64_t carry = 0;
+    for (size_t j = 0; j < b_size; ++j) {
+      uint128_t product = static_cast<uint128_t>(a[i]) * b[j] + result[i + j] + carry;
+      result[i + j] = static_cast<uint64_t>(product);
+      carry = static_cast<uint64_t>(product >> 64);
+    }
+    result[i + b_size] = carry;
+  }
+}
+
+// divides a in place, returns remainder
+static uint64_t divide_by_limb(uint64_t *a, size_t a_size, uint64_t divisor) {
+  uint64_t remainder = 0;
+  for (size_t i = a_size; i-- > 0;) {
+    uint128_t current = (static_cast<uint128_t>(remainder) << 64) | a[i];
+    a[i] = static_cast<uint64_t>(current / divisor);
+    remainder = static_cast<uint64_t>(current % divisor);
+  }
+  return remainder;
+}
+
+// a = a * multiplier + addend, returns the carry limb
+static uint64_t multiply_add_limb(uint64_t *a, size_t a_size, uint64_t multiplier, uint64_t addend) {
+  uint64_t carry = addend;
+  for (size_t i = 0; i < a_size; ++i) {
+    uint128_t current = static_cast<uint128_t>(a[i]) * multiplier + carry;
+    a[i] = static_cast<uint64_t>(current);
+    carry = static_cast<uint64_t>(current >> 64);
+  }
+  return carry;
+}
+
+// Knuth's algorithm D: a has a_size limbs, b has b_size >= 2 limbs with nonzero top limb,
+// a_size >= b_size. Quotient gets a_size - b_size + 1 limbs, remainder gets b_size limbs
+static void divide_magnitudes(const uint64_t *a, size_t a_size, const uint64_t *b, size_t b_size, uint64_t *quotient,
+                              uint64_t *remainder) {
+  // normalize, so that the top limb of divisor has its high bit set
+  unsigned shift = __builtin_clzll(b[b_size - 1]);
+  std::vector<uint64_t> u(a_size + 1);
+  std::vector<uint64_t> v(b_size);
+  for (size_t i = b_size; i-- > 0;) {
+    v[i] = (b[i] << shift) | (shift != 0 && i > 0 ? b[i - 1] >> (64 - shift) : 0);
+  }
+  u[a_size] = shift != 0 ? a[a_size - 1] >> (64 - shift) : 0;
+  for (size_t i = a_size; i-- > 0;) {
+    u[i] = (a[i] << shift) | (shift != 0 && i > 0 ? a[i - 1] >> (64 - shift) : 0);
+  }
+
+  const uint64_t top = v[b_size - 1];
+  const uint64_t next = v[b_size - 2];
+  for (size_t j = a_size - b_size + 1; j-- > 0;) {
+    // estimate quotient limb from the top two limbs, it is at most 2 too large
+    uint128_t numerator = (static_cast<uint128_t>(u[j + b_size]) << 64) | u[j + b_size - 1];
+    uint128_t q_hat = numerator / top;
+    uint128_t r_hat = numerator % top;
+    while (q_hat >> 64 != 0 || q_hat * next > ((r_hat << 64) | u[j + b_size - 2])) {
+      --q_hat;
+      r_hat += top;
+      if (r_hat >> 64 != 0) {
+        break;
+      }
+    }
+
+    // u[j .. j + b_size] -= q_hat * v
+    uint64_t carry = 0;
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < b_size; ++i) {
+      uint128_t product = q_hat * v[i] + carry;
+      carry = static_cast<uint64_t>(product >> 64);
+      uint64_t low = static_cast<uint64_t>(product);
+      uint64_t difference = u[i + j] - low - borrow;
+      borrow = u[i + j] < low || (u[i + j] == low && borrow != 0);
+      u[i + j] = difference;
+    }
+    uint64_t difference = u[j + b_size] - carry - borrow;
+    bool negative = u[j + b_size] < carry || (u[j + b_size] == carry && borrow != 0);
+    u[j + b_size] = difference;
+
+    if (negative) {
+      // q_hat was one too large, add divisor back
+      --q_hat;
+      uint64_t add_carry = 0;
+      for (size_t i = 0; i < b_size; ++i) {
+        uint128_t sum = static_cast<uint128_t>(u[i + j]) + v[i] + add_carry;
+        u[i + j] = static_cast<uint64_t>(sum);
+        add_carry = static_cast<uint64_t>(sum >> 64);
+      }
+      u[j + b_size] += add_carry;
+    }
+    quotient[j] = static_cast<uint64_t>(q_hat);
+  }
+
+  for (size_t i = 0; i < b_size; ++i) {
+    remainder[i] = (u[i] >> shift) | (shift != 0 ? u[i + 1] << (64 - shift) : 0);
+  }
+}
+
 // constructors
 number_t::number_t() = default;
-number_t::number_t(long value) : _value{value} {}
+number_t::number_t(long value) {
+  assign(static_cast<int64_t>(value));
+}
+
+number_t::number_t(const number_t &other) = default;
+
+number_t::number_t(number_t &&other) noexcept
+    : _magnitude(std::move(other._magnitude)), _negative(std::exchange(other._negative, false)) {}
 
 void number_t::swap(number_t &other) {
-  std::swap(_value, other._value);
+  _magnitude.swap(other._magnitude);
+  std::swap(_negative, other._negative);
 }
 
-// assignment operator
+// assignment operators, copying reuses own limbs if they are enough
 number_t &number_t::operator=(const number_t &other) {
-  number_t tmp(other);
-  swap(tmp);
+  _magnitude = other._magnitude;
+  _negative = other._negative;
   return *this;
 }
 
+number_t &number_t::operator=(number_t &&other) noexcept {
+  _magnitude = std::move(other._magnitude);
+  _negative = std::exchange(other._negative, false);
+  return *this;
+}
+
+void number_t::assign(int64_t value) {
+  _negative = value < 0;
+  _magnitude.assign(_negative ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value));
+}
+
+void number_t::assign(bool negative, uint64_t low, uint64_t high) {
+  if (high == 0) {
+    _magnitude.assign(low);
+  } else {
+    _magnitude.resize(2);
+    _magnitude[0] = low;
+    _magnitude[1] = high;
+  }
+  _negative = negative;
+  normalize();
+}
+
+void number_t::normalize() {
+  _magnitude.normalize();
+  if (_magnitude.size() == 0) {
+    _negative = false;
+  }
+}
+
 // casts
 number_t::operator bool() const {
-  return _value != 0;
+  return _magnitude.size() != 0;
 }
 
 number_t::operator long() const {
-  return _value;
+  // the lowest bits of two's complement, like conversions between built-in integers
+  uint64_t low = _magnitude.size() == 0 ? 0 : _magnitude[0];
+  return static_cast<long>(_negative ? 0 - low : low);
 }
 
 number_t::operator std::string() const {
-  return std::to_string(_value);
+  std::string result(max_chars_size(), '\0');
+  std::to_chars_result end = to_chars(result.data(), result.data() + result.size(), *this);
+  result.resize(end.ptr - result.data());
+  return result;
 }
 
 // comparisons
+int number_t::compare(const number_t &num1, const number_t &num2) {
+  if (num1._negative != num2._negative) {
+    return num1._negative ? -1 : 1;
+  }
+  int result = compare_magnitudes(num1._magnitude.data(), num1._magnitude.size(), num2._magnitude.data(),
+                                  num2._magnitude.size());
+  return num1._negative ? -result : result;
+}
+
 bool operator==(const number_t &num1, const number_t &num2) {
-  return (num1._value == num2._value);
+  return number_t::compare(num1, num2) == 0;
 }
 
 bool operator!=(const number_t &num1, const number_t &num2) {
-  return (num1._value != num2._value);
+  return number_t::compare(num1, num2) != 0;
 }
 
 bool operator<(const number_t &num1, const number_t &num2) {
-  return (num1._value < num2._value);
+  return number_t::compare(num1, num2) < 0;
 }
 
 bool operator>(const number_t &num1, const number_t &num2) {
-  return (num1._value > num2._value);
+  return number_t::compare(num1, num2) > 0;
 }
 
 bool operator<=(const number_t &num1, const number_t &num2) {
-  return (num1._value <= num2._value);
+  return number_t::compare(num1, num2) <= 0;
 }
 
 bool operator>=(const number_t &num1, const number_t &num2) {
-  return (num1._value >= num2._value);
+  return number_t::compare(num1, num2) >= 0;
 }
 
 // I/O
 std::ostream &operator<<(std::ostream &stream, const number_t &num) {
-  stream << num._value;
+  // up to 128-bit values are written without allocations
+  char buffer[48];
+  if (num._magnitude.size() <= 2) {
+    std::to_chars_result end = to_chars(buffer, buffer + sizeof(buffer), num);
+    stream << std::string_view(buffer, end.ptr - buffer);
+  } else {
+    stream << static_cast<std::string>(num);
+  }
   return stream;
 }
+
 std::istream &operator>>(std::istream &stream, number_t &num) {
-  stream >> num._value;
+  std::istream::sentry sentry(stream);
+  if (!sentry) {
+    return stream;
+  }
+  std::string text;
+  if (stream.peek() == '-' || stream.peek() == '+') {
+    if (stream.get() == '-') {
+      text += '-';
+    }
+  }
+  if (!std::isdigit(stream.peek())) {
+    stream.setstate(std::ios::failbit);
+    return stream;
+  }
+  while (std::isdigit(stream.peek())) {
+    text += static_cast<char>(stream.get());
+  }
+  from_chars(text.data(), text.data() + text.size(), num);
   return stream;
 }
 
-// binary operators
-number_t number_t::operator+=(const number_t &num) {
-  this->_value += num._value;
-  return *this;
+// decimal conversions
+static constexpr uint64_t CHUNK_BASE = 10000000000000000000ULL;
+static constexpr size_t CHUNK_DIGITS = 19;
+// magnitudes up to this size are converted in buffers on stack
+static constexpr size_t MAX_LEAF_LIMBS = 32;
+
+static constexpr char DIGIT_PAIRS[] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static bool is_digit(char c) {
+  return static_cast<unsigned char>(c - '0') < 10;
 }
 
-number_t number_t::operator-=(const number_t &num) {
-  this->_value -= num._value;
-  return *this;
+static size_t digits_count(uint64_t value) {
+  size_t count = 1;
+  for (uint64_t power = 10; count < 20 && value >= power; power *= 10) {
+    ++count;
+  }
+  return count;
 }
 
-number_t number_t::operator*=(const number_t &num) {
-  this->_value *= num._value;
-  return *this;
+// writes exactly width digits of value < 10^width, two digits per step
+static void write_digits(uint64_t value, char *out, size_t width) {
+  char *pos = out + width;
+  while (pos - out >= 2) {
+    pos -= 2;
+    std::memcpy(pos, DIGIT_PAIRS + value % 100 * 2, 2);
+    value /= 100;
+  }
+  if (pos != out) {
+    *--pos = static_cast<char>('0' + value);
+  }
+}
+
+// reads up to 19 digits, two digits per step
+static uint64_t read_digits(const char *first, const char *last) {
+  uint64_t value = 0;
+  if ((last - first) % 2 != 0) {
+    value = *first++ - '0';
+  }
+  for (; first != last; first += 2) {
+    value = value * 100 + (first[0] - '0') * 10 + (first[1] - '0');
+  }
+  return value;
+}
+
+// magnitude of at most MAX_LEAF_LIMBS limbs padded to width digits, null if it doesn't fit
+static char *write_leaf(const uint64_t *limbs, size_t size, size_t width, char *first, char *last) {
+  // split into base 10^19 chunks from the lowest one, a limb takes less than 64 / 63 chunks
+  uint64_t rest[MAX_LEAF_LIMBS];
+  uint64_t chunks[MAX_LEAF_LIMBS + 2];
+  std::copy(limbs, limbs + size, rest);
+  size_t chunks_count = 0;
+  do {
+    chunks[chunks_count++] = divide_by_limb(rest, size, CHUNK_BASE);
+    while (size != 0 && rest[size - 1] == 0) {
+      --size;
+    }
+  } while (size != 0);
+
+  size_t top_digits = digits_count(chunks[chunks_count - 1]);
+  size_t length = top_digits + CHUNK_DIGITS * (chunks_count - 1);
+  size_t padding = width > length ? width - length : 0;
+  if (static_cast<size_t>(last - first) < padding + length) {
+    return nullptr;
+  }
+  std::fill(first, first + padding, '0');
+  char *pos = first + padding;
+  write_digits(chunks[chunks_count - 1], pos, top_digits);
+  pos += top_digits;
+  for (size_t i = chunks_count - 1; i-- > 0;) {
+    write_digits(chunks[i], pos, CHUNK_DIGITS);
+    pos += CHUNK_DIGITS;
+  }
+  return pos;
+}
+
+static size_t leaf_limbs() {
+  return std::clamp<size_t>(number_t::thresholds.radix_conversion, 1, MAX_LEAF_LIMBS);
+}
+
+const number_t &number_t::decimal_power(size_t k) {
+  // kept between conversions, every power is the square of the previous one
+  thread_local std::vector<number_t> powers;
+  if (powers.empty()) {
+    powers.push_back(from_limbs(&CHUNK_BASE, 1));
+  }
+  while (powers.size() <= k) {
+    number_t square = powers.back() * powers.back();
+    powers.push_back(std::move(square));
+  }
+  return powers[k];
+}
+
+char *number_t::write_decimal(const number_t &num, size_t width, char *first, char *last) {
+  size_t size = num._magnitude.size();
+  if (size <= leaf_limbs()) {
+    return write_leaf(num._magnitude.data(), size, width, first, last);
+  }
+  // the lower part takes about a half of limbs, the power is less than num, so the higher part isn't zero
+  size_t k = 0;
+  while (2 * decimal_power(k + 1)._magnitude.size() <= size + 1) {
+    ++k;
+  }
+  // truncating division of a negative num gives negative parts with right magnitudes
+  number_t high;
+  number_t low;
+  divide(num, decimal_power(k), &high, &low);
+  size_t low_width = CHUNK_DIGITS << k;
+  char *pos = write_decimal(high, width > low_width ? width - low_width : 0, first, last);
+  return pos == nullptr ? nullptr : write_decimal(low, low_width, pos, last);
+}
+
+void number_t::read_decimal(const char *first, const char *last, number_t &result) {
+  size_t digits = last - first;
+  if (digits <= CHUNK_DIGITS * leaf_limbs()) {
+    // 19 digits chunks from the highest one, the first chunk takes the rest
+    assert(digits != 0);
+    size_t chunks_count = (digits + CHUNK_DIGITS - 1) / CHUNK_DIGITS;
+    result._magnitude.resize(0);
+    result._magnitude.resize(chunks_count);
+    uint64_t *limbs = result._magnitude.data();
+    size_t size = 0;
+    const char *chunk_end = last - (chunks_count - 1) * CHUNK_DIGITS;
+    for (const char *chunk = first; chunk != last; chunk = chunk_end, chunk_end += CHUNK_DIGITS) {
+      uint64_t carry = multiply_add_limb(limbs, size, CHUNK_BASE, read_digits(chunk, chunk_end));
+      if (carry != 0) {
+        limbs[size++] = carry;
+      }
+    }
+    result._magnitude.resize(size);
+    result._negative = false;
+    return;
+  }
+  // the lower part takes about a half of digits
+  size_t k = 0;
+  while ((CHUNK_DIGITS << (k + 1)) * 2 <= digits) {
+    ++k;
+  }
+  const char *middle = last - (CHUNK_DIGITS << k);
+  number_t high;
+  read_decimal(first, middle, high);
+  read_decimal(middle, last, result);
+  result += high * decimal_power(k);
+}
+
+size_t number_t::max_chars_size() const {
+  // log10(2) < 0.30103
+  return bit_length() * 30103 / 100000 + 1 + _negative;
+}
+
+std::to_chars_result to_chars(char *first, char *last, const number_t &num) {
+  char *pos = first;
+  if (num._negative) {
+    if (pos == last) {
+      return {last, std::errc::value_too_large};
+    }
+    *pos++ = '-';
+  }
+  if (num._magnitude.size() <= 1) {
+    uint64_t value = num._magnitude.size() == 0 ? 0 : num._magnitude[0];
+    size_t digits = digits_count(value);
+    if (static_cast<size_t>(last - pos) < digits) {
+      return {last, std::errc::value_too_large};
+    }
+    write_digits(value, pos, digits);
+    return {pos + digits, std::errc()};
+  }
+  char *end = number_t::write_decimal(num, 0, pos, last);
+  if (end == nullptr) {
+    return {last, std::errc::value_too_large};
+  }
+  return {end, std::errc()};
+}
+
+std::from_chars_result from_chars(const char *first, const char *last, number_t &num) {
+  const char *pos = first;
+  bool negative = pos != last && *pos == '-';
+  pos += negative;
+  const char *digits_begin = pos;
+  while (pos != last && is_digit(*pos)) {
+    ++pos;
+  }
+  if (pos == digits_begin) {
+    return {first, std::errc::invalid_argument};
+  }
+  // leading zeros would unbalance splitting
+  while (digits_begin != pos && *digits_begin == '0') {
+    ++digits_begin;
+  }
+  if (pos - digits_begin < static_cast<ptrdiff_t>(CHUNK_DIGITS)) {
+    int64_t value = static_cast<int64_t>(read_digits(digits_begin, pos));
+    num.assign(negative ? -value : value);
+  } else {
+    number_t::read_decimal(digits_begin, pos, num);
+    num._negative = negative;
+    num.normalize();
+  }
+  return {pos, std::errc()};
+}
+
+// arithmetic
+void number_t::add(const number_t &num, bool negate) {
+  bool num_negative = num._negative != negate && num._magnitude.size() != 0;
+  size_t size = _magnitude.size();
+  size_t num_size = num._magnitude.size();
+  // the result is computed in own limbs, num may be this, so its limbs are taken after the resize
+  if (_negative == num_negative) {
+    size_t sum_size = std::max(size, num_size);
+    _magnitude.resize(sum_size);
+    if (uint64_t carry = add_magnitudes(_magnitude.data(), size, num._magnitude.data(), num_size, _magnitude.data())) {
+      _magnitude.resize(sum_size + 1);
+      _magnitude[sum_size] = carry;
+    }
+  } else if (compare_magnitudes(_magnitude.data(), size, num._magnitude.data(), num_size) >= 0) {
+    subtract_magnitudes(_magnitude.data(), size, num._magnitude.data(), num_size, _magnitude.data());
+  } else {
+    // num is longer or larger, so it isn't this
+    _magnitude.resize(num_size);
+    subtract_magnitudes(num._magnitude.data(), num_size, _magnitude.data(), size, _magnitude.data());
+    _negative = num_negative;
+  }
+  normalize();
+}
+
+number_t::thresholds_t number_t::thresholds;
+
+number_t number_t::from_limbs(const uint64_t *limbs, size_t size) {
+  number_t result;
+  result._magnitude.resize(size);
+  std::copy(limbs, limbs + size, result._magnitude.data());
+  result.normalize();
+  return result;
+}
+
+size_t number_t::bit_length() const {
+  size_t size = _magnitude.size();
+  return size == 0 ? 0 : 64 * size - __builtin_clzll(_magnitude[size - 1]);
+}
+
+number_t number_t::low_bits(const number_t &num, size_t bits) {
+  size_t size = std::min(num._magnitude.size(), (bits + 63) / 64);
+  number_t result = from_limbs(num._magnitude.data(), size);
+  if (size == (bits + 63) / 64 && bits % 64 != 0) {
+    result._magnitude[size - 1] &= (uint64_t(1) << (bits % 64)) - 1;
+    result.normalize();
+  }
+  return result;
+}
+
+// drops leading zero limbs from size
+static size_t significant_size(const uint64_t *limbs, size_t size) {
+  while (size > 0 && limbs[size - 1] == 0) {
+    --size;
+  }
+  return size;
+}
+
+// result[0 .. result_size) += addend, the sum must fit
+static void add_into(uint64_t *result, size_t result_size, const uint64_t *addend, size_t addend_size) {
+  uint64_t carry = 0;
+  size_t i = 0;
+  for (; i < addend_size; ++i) {
+    uint128_t sum = static_cast<uint128_t>(result[i]) + addend[i] + carry;
+    result[i] = static_cast<uint64_t>(sum);
+    carry = static_cast<uint64_t>(sum >> 64);
+  }
+  for (; carry != 0 && i < result_size; ++i) {
+    carry = ++result[i] == 0;
+  }
+}
+
+void number_t::multiply_magnitudes(const uint64_t *a, size_t a_size, const uint64_t *b, size_t b_size,
+                                   uint64_t *result) {
+  if (a_size < b_size) {
+    std::swap(a, b);
+    std::swap(a_size, b_size);
+  }
+  if (b_size < thresholds.karatsuba) {
+    multiply_schoolbook(a, a_size, b, b_size, result);
+  } else if (a_size >= 2 * b_size) {
+    // unbalanced operands: multiply b by pieces of a of the same size
+    std::fill(result, result + a_size + b_size, 0);
+    std::vector<uint64_t> product(2 * b_size);
+    for (size_t offset = 0; offset < a_size; offset += b_size) {
+      size_t piece_size = std::min(b_size, a_size - offset);
+      multiply_magnitudes(a + offset, piece_size, b, b_size, product.data());
+      add_into(result + offset, a_size + b_size - offset, product.data(), piece_size + b_size);
+    }
+  } else if (b_size < thresholds.toom3) {
+    multiply_karatsuba(a, a_size, b, b_size, result);
+  } else {
+    multiply_toom3(a, a_size, b, b_size, result);
+  }
+}
+
+void number_t::multiply_karatsuba(const uint64_t *a, size_t a_size, const uint64_t *b, size_t b_size,
+                                  uint64_t *result) {
+  // a = a1 * B^half + a0, b = b1 * B^half + b0, where b1 may be empty
+  size_t half = (a_size + 1) / 2;
+  size_t b0_size = std::min(half, b_size);
+  size_t b1_size = b_size - b0_size;
+  std::fill(result, result + a_size + b_size, 0);
+
+  // z0 = a0 * b0 and z2 = a1 * b1 go to their places in result
+  multiply_magnitudes(a, half, b, b0_size, result);
+  if (b1_size != 0) {
+    multiply_magnitudes(a + half, a_size - half, b + half, b1_size, result + 2 * half);
+  }
+
+  // z1 = (a0 + a1) * (b0 + b1) - z0 - z2
+  std::vector<uint64_t> a_sum(half + 1);
+  std::vector<uint64_t> b_sum(half + 1);
+  a_sum[half] = add_magnitudes(a, half, a + half, a_size - half, a_sum.data());
+  b_sum[b0_size] = add_magnitudes(b, b0_size, b + half, b1_size, b_sum.data());
+  size_t a_sum_size = significant_size(a_sum.data(), a_sum.size());
+  size_t b_sum_size = significant_size(b_sum.data(), std::max(b0_size, b1_size) + 1);
+  std::vector<uint64_t> z1(a_sum_size + b_sum_size);
+  multiply_magnitudes(a_sum.data(), a_sum_size, b_sum.data(), b_sum_size, z1.data());
+
+  subtract_magnitudes(z1.data(), z1.size(), result, half + b0_size, z1.data());
+  if (b1_size != 0) {
+    subtract_magnitudes(z1.data(), z1.size(), result + 2 * half, a_size - half + b1_size, z1.data());
+  }
+  add_into(result + half, a_size + b_size - half, z1.data(), significant_size(z1.data(), z1.size()));
+}
+
+void number_t::multiply_toom3(const uint64_t *a, size_t a_size, const uint64_t *b, size_t b_size,
+                              uint64_t *result) {
+  // operands are split into three pieces of k limbs: a = a2 * x^2 + a1 * x + a0, x = B^k
+  size_t k = (a_size + 2) / 3;
+  const auto piece = [k](const uint64_t *limbs, size_t size, size_t index) {
+    size_t begin = std::min(size, index * k);
+    size_t end = std::min(size, begin + k);
+    return from_limbs(limbs + begin, end - begin);
+  };
+  number_t a0 = piece(a, a_size, 0), a1 = piece(a, a_size, 1), a2 = piece(a, a_size, 2);
+  number_t b0 = piece(b, b_size, 0), b1 = piece(b, b_size, 1), b2 = piece(b, b_size, 2);
+
+  // values at 0, 1, -1, -2 and infinity
+  number_t a_sum = a0 + a2;
+  number_t b_sum = b0 + b2;
+  number_t r0 = a0 * b0;
+  number_t r1 = (a_sum + a1) * (b_sum + b1);
+  number_t r_minus1 = (a_sum - a1) * (b_sum - b1);
+  number_t r_minus2 = ((((a2 << 1) - a1) << 1) + a0) * ((((b2 << 1) - b1) << 1) + b0);
+  number_t r_inf = a2 * b2;
+
+  // interpolation by Bodrato, all divisions are exact
+  number_t c3 = (r_minus2 - r1) / 3;
+  number_t c1 = (r1 - r_minus1) >> 1;
+  number_t c2 = r_minus1 - r0;
+  c3 = ((c2 - c3) >> 1) + (r_inf << 1);
+  c2 += c1 - r_inf;
+  c1 -= c3;
+
+  size_t shift = 64 * k;
+  number_t product = r0;
+  product += c1 << shift;
+  product += c2 << 2 * shift;
+  product += c3 << 3 * shift;
+  product += r_inf << 4 * shift;
+  assert(product._magnitude.size() <= a_size + b_size);
+  std::fill(result, result + a_size + b_size, 0);
+  std::copy(product._magnitude.data(), product._magnitude.data() + product._magnitude.size(), result);
+}
+
+void number_t::multiply_into(number_t &result, const number_t &num1, const number_t &num2) {
+  size_t size1 = num1._magnitude.size();
+  size_t size2 = num2._magnitude.size();
+  if (size1 <= 1 && size2 <= 1) {
+    uint64_t limb1 = size1 == 0 ? 0 : num1._magnitude[0];
+    uint64_t limb2 = size2 == 0 ? 0 : num2._magnitude[0];
+    uint128_t product = static_cast<uint128_t>(limb1) * limb2;
+    result.assign(num1._negative != num2._negative, static_cast<uint64_t>(product),
+                  static_cast<uint64_t>(product >> 64));
+    return;
+  }
+  // old limbs of result are not needed, so they aren't copied if storage grows
+  result._magnitude.resize(0);
+  result._magnitude.resize(size1 + size2);
+  multiply_magnitudes(num1._magnitude.data(), size1, num2._magnitude.data(), size2, result._magnitude.data());
+  result._negative = num1._negative != num2._negative;
+  result.normalize();
+}
+
+void number_t::multiply(const number_t &num) {
+  if (_magnitude.size() == 0 || num._magnitude.size() == 0) {
+    assign(0);
+    return;
+  }
+  limbs_t product;
+  product.resize(_magnitude.size() + num._magnitude.size());
+  multiply_magnitudes(_magnitude.data(), _magnitude.size(), num._magnitude.data(), num._magnitude.size(),
+                      product.data());
+  _magnitude.swap(product);
+  _negative = _negative != num._negative;
+  normalize();
+}
+
+void number_t::divide_schoolbook(const number_t &a, const number_t &b, number_t &quotient, number_t &remainder) {
+  const limbs_t &a_limbs = a._magnitude;
+  const limbs_t &b_limbs = b._magnitude;
+  number_t q;
+  number_t r;
+  if (compare_magnitudes(a_limbs.data(), a_limbs.size(), b_limbs.data(), b_limbs.size()) < 0) {
+    r._magnitude = a_limbs;
+  } else if (b_limbs.size() == 1) {
+    q._magnitude = a_limbs;
+    r._magnitude.assign(divide_by_limb(q._magnitude.data(), q._magnitude.size(), b_limbs[0]));
+  } else {
+    q._magnitude.resize(a_limbs.size() - b_limbs.size() + 1);
+    r._magnitude.resize(b_limbs.size());
+    divide_magnitudes(a_limbs.data(), a_limbs.size(), b_limbs.data(), b_limbs.size(), q._magnitude.data(),
+                      r._magnitude.data());
+  }
+  q.normalize();
+  r.normalize();
+  quotient.swap(q);
+  remainder.swap(r);
 }
 
-number_t number_t::operator/=(const number_t &num) {
-  this->_value /= num._value;
+void number_t::divide_recursive(const number_t &a, const number_t &b, number_t &quotient, number_t &remainder) {
+  size_t n = b.bit_length();
+  size_t digits = (a.bit_length() + n - 1) / n;
+  number_t q;
+  number_t r;
+  for (size_t i = digits; i-- > 0;) {
+    number_t digit = low_bits(a >> static_cast<long>(i * n), n);
+    number_t digit_q;
+    divide_2n_by_n((r << static_cast<long>(n)) + digit, b, n, digit_q, r);
+    q = (q << static_cast<long>(n)) + digit_q;
+  }
+  quotient.swap(q);
+  remainder.swap(r);
+}
+
+void number_t::divide_2n_by_n(const number_t &a, const number_t &b, size_t n, number_t &quotient,
+                              number_t &remainder) {
+  if (n < 64 * thresholds.recursive_division) {
+    divide_schoolbook(a, b, quotient, remainder);
+    return;
+  }
+  // n must be even, so that halves are of the same size
+  if (n % 2 != 0) {
+    divide_2n_by_n(a << 1, b << 1, n + 1, quotient, remainder);
+    remainder >>= 1;
+    return;
+  }
+  size_t half = n / 2;
+  number_t b1 = b >> static_cast<long>(half);
+  number_t b2 = low_bits(b, half);
+  number_t q1;
+  number_t q2;
+  number_t r;
+  divide_3n_by_2n(a >> static_cast<long>(n), low_bits(a >> static_cast<long>(half), half), b, b1, b2, half, q1, r);
+  divide_3n_by_2n(r, low_bits(a, half), b, b1, b2, half, q2, remainder);
+  quotient = (q1 << static_cast<long>(half)) + q2;
+}
+
+void number_t::divide_3n_by_2n(const number_t &a12, const number_t &a3, const number_t &b, const number_t &b1,
+                               const number_t &b2, size_t n, number_t &quotient, number_t &remainder) {
+  number_t r;
+  if (a12 >> static_cast<long>(n) == b1) {
+    quotient = (number_t(1) << static_cast<long>(n)) - 1;
+    r = a12 - (b1 << static_cast<long>(n)) + b1;
+  } else {
+    divide_2n_by_n(a12, b1, n, quotient, r);
+  }
+  r = (r << static_cast<long>(n)) + a3 - quotient * b2;
+  // the estimated quotient is at most 2 too large
+  while (r < 0) {
+    --quotient;
+    r += b;
+  }
+  remainder.swap(r);
+}
+
+void number_t::divide(const number_t &dividend, const number_t &divisor, number_t *quotient, number_t *remainder) {
+  assert(divisor._magnitude.size() != 0);
+  bool quotient_negative = dividend._negative != divisor._negative;
+  bool remainder_negative = dividend._negative;
+  number_t a = dividend;
+  number_t b = divisor;
+  a._negative = false;
+  b._negative = false;
+
+  number_t q;
+  number_t r;
+  size_t b_size = b._magnitude.size();
+  size_t a_size = a._magnitude.size();
+  if (b_size >= thresholds.recursive_division && a_size >= b_size + thresholds.recursive_division) {
+    divide_recursive(a, b, q, r);
+  } else {
+    divide_schoolbook(a, b, q, r);
+  }
+  q._negative = quotient_negative;
+  r._negative = remainder_negative;
+  q.normalize();
+  r.normalize();
+  if (quotient != nullptr) {
+    quotient->swap(q);
+  }
+  if (remainder != nullptr) {
+    remainder->swap(r);
+  }
+}
+
+template <typename op_t>
+void number_t::bitwise(const number_t &num, op_t op) {
+  // limbs above both magnitudes are the sign limbs, they give the sign of the result
+  bool negative = op(_negative ? ~uint64_t(0) : 0, num._negative ? ~uint64_t(0) : 0) >> 63 != 0;
+  bool num_negative = num._negative;
+  size_t num_size = num._magnitude.size();
+  size_t size = std::max(_magnitude.size(), num_size);
+  // num may be this, its limbs are read after the resize
+  _magnitude.resize(size);
+  uint64_t *limbs = _magnitude.data();
+  const uint64_t *num_limbs = num._magnitude.data();
+
+  // two's complement of a negative magnitude is ~m + 1, operands and the result are converted limb by limb,
+  // so the result is written in place
+  bool carry = _negative;
+  bool num_carry = num_negative;
+  bool result_carry = negative;
+  for (size_t i = 0; i < size; ++i) {
+    uint64_t a = limbs[i];
+    uint64_t b = i < num_size ? num_limbs[i] : 0;
+    if (_negative) {
+      a = ~a + carry;
+      carry = carry && a == 0;
+    }
+    if (num_negative) {
+      b = ~b + num_carry;
+      num_carry = num_carry && b == 0;
+    }
+    uint64_t limb = op(a, b);
+    if (negative) {
+      limb = ~limb + result_carry;
+      result_carry = result_carry && limb == 0;
+    }
+    limbs[i] = limb;
+  }
+  // the carry reaches the sign limb only for -2^(64 * size)
+  if (negative && result_carry) {
+    _magnitude.resize(size + 1);
+    _magnitude[size] = 1;
+  }
+  _negative = negative;
+  normalize();
+}
+
+void number_t::shift_left(size_t bits) {
+  if (_magnitude.size() == 0) {
+    return;
+  }
+  size_t limbs_shift = bits / 64;
+  unsigned bits_shift = bits % 64;
+  size_t size = _magnitude.size();
+  // the top limb is added only if bits are shifted out of the old top limb
+  uint64_t overflow = bits_shift != 0 ? _magnitude[size - 1] >> (64 - bits_shift) : 0;
+  _magnitude.resize(size + limbs_shift + (overflow != 0));
+  uint64_t *limbs = _magnitude.data();
+  if (overflow != 0) {
+    limbs[size + limbs_shift] = overflow;
+  }
+  for (size_t i = size; i-- > 0;) {
+    uint64_t high = limbs[i] << bits_shift;
+    uint64_t low = i > 0 && bits_shift != 0 ? limbs[i - 1] >> (64 - bits_shift) : 0;
+    limbs[i + limbs_shift] = high | low;
+  }
+  std::fill(limbs, limbs + limbs_shift, 0);
+}
+
+void number_t::shift_right(size_t bits) {
+  size_t limbs_shift = bits / 64;
+  unsigned bits_shift = bits % 64;
+  size_t size = _magnitude.size();
+  if (limbs_shift >= size) {
+    assign(_negative ? -1 : 0);
+    return;
+  }
+  uint64_t *limbs = _magnitude.data();
+  bool lost_bits = std::any_of(limbs, limbs + limbs_shift, [](uint64_t limb) { return limb != 0; }) ||
+                   (bits_shift != 0 && limbs[limbs_shift] << (64 - bits_shift) != 0);
+  for (size_t i = 0; i + limbs_shift < size; ++i) {
+    uint64_t low = limbs[i + limbs_shift] >> bits_shift;
+    uint64_t high = bits_shift != 0 && i + limbs_shift + 1 < size ? limbs[i + limbs_shift + 1] << (64 - bits_shift) : 0;
+    limbs[i] = low | high;
+  }
+  _magnitude.resize(size - limbs_shift);
+  bool negative = _negative;
+  normalize();
+  if (negative && lost_bits) {
+    // -m >> n is -ceil(m / 2^n)
+    add(number_t(1), true);
+  }
+}
+
+// binary operators
+number_t &number_t::operator+=(const number_t &num) {
+  int64_t sum;
+  if (is_small() && num.is_small() && !__builtin_add_overflow(small_value(), num.small_value(), &sum)) {
+    assign(sum);
+  } else {
+    add(num, false);
+  }
   return *this;
 }
 
-number_t number_t::operator%=(const number_t &num) {
-  this->_value %= num._value;
+number_t &number_t::operator-=(const number_t &num) {
+  int64_t difference;
+  if (is_small() && num.is_small() && !__builtin_sub_overflow(small_value(), num.small_value(), &difference)) {
+    assign(difference);
+  } else {
+    add(num, true);
+  }
   return *this;
 }
 
-number_t number_t::operator^=(const number_t &num) {
-  this->_value ^= num._value;
+number_t &number_t::operator*=(const number_t &num) {
+  if (_magnitude.size() <= 1 && num._magnitude.size() <= 1) {
+    // the product of two limbs fits into inline storage
+    uint64_t a = _magnitude.size() == 0 ? 0 : _magnitude[0];
+    uint64_t b = num._magnitude.size() == 0 ? 0 : num._magnitude[0];
+    uint128_t product = static_cast<uint128_t>(a) * b;
+    assign(_negative != num._negative, static_cast<uint64_t>(product), static_cast<uint64_t>(product >> 64));
+  } else {
+    multiply(num);
+  }
   return *this;
 }
 
-number_t number_t::operator&=(const number_t &num) {
-  this->_value &= num._value;
+number_t &number_t::operator/=(const number_t &num) {
+  if (is_small() && num.is_small()) {
+    assign(small_value() / num.small_value());
+  } else {
+    divide(*this, num, this, nullptr);
+  }
   return *this;
 }
 
-number_t number_t::operator|=(const number_t &num) {
-  this->_value |= num._value;
+number_t &number_t::operator%=(const number_t &num) {
+  if (is_small() && num.is_small()) {
+    assign(small_value() % num.small_value());
+  } else {
+    divide(*this, num, nullptr, this);
+  }
   return *this;
 }
 
-// friend unary operators
-number_t operator+(const number_t &num1, const number_t &num2) {
-  return number_t(num1._value + num2._value);
+number_t &number_t::operator^=(const number_t &num) {
+  if (is_small() && num.is_small()) {
+    assign(small_value() ^ num.small_value());
+  } else {
+    bitwise(num, std::bit_xor<uint64_t>());
+  }
+  return *this;
 }
 
-number_t operator-(const number_t &num1, const number_t &num2) {
-  return number_t(num1._value - num2._value);
+number_t &number_t::operator&=(const number_t &num) {
+  if (is_small() && num.is_small()) {
+    assign(small_value() & num.small_value());
+  } else {
+    bitwise(num, std::bit_and<uint64_t>());
+  }
+  return *this;
 }
 
-number_t operator*(const number_t &num1, const number_t &num2) {
-  return number_t(num1._value * num2._value);
+number_t &number_t::operator|=(const number_t &num) {
+  if (is_small() && num.is_small()) {
+    assign(small_value() | num.small_value());
+  } else {
+    bitwise(num, std::bit_or<uint64_t>());
+  }
+  return *this;
 }
 
+// friend binary operators, sums, differences and products are lazy and are in the header
 number_t operator/(const number_t &num1, const number_t &num2) {
-  return number_t(num1._value / num2._value);
+  number_t result(num1);
+  result /= num2;
+  return result;
 }
 
 number_t operator%(const number_t &num1, const number_t &num2) {
-  return number_t(num1._value % num2._value);
+  number_t result(num1);
+  result %= num2;
+  return result;
 }
 
 number_t operator^(const number_t &num1, const number_t &num2) {
-  return number_t(num1._value ^ num2._value);
+  number_t result(num1);
+  result ^= num2;
+  return result;
 }
 
 number_t operator&(const number_t &num1, const number_t &num2) {
-  return number_t(num1._value & num2._value);
+  number_t result(num1);
+  result &= num2;
+  return result;
 }
 
 number_t operator|(const number_t &num1, const number_t &num2) {
-  return number_t(num1._value | num2._value);
+  number_t result(num1);
+  result |= num2;
+  return result;
 }
 
 // increment, decrement
 number_t &number_t::operator++() {
-  _value++;
+  *this += 1;
   return *this;
 }
 
@@ -150,7 +1098,7 @@ number_t number_t::operator++(int) {
 }
 
 number_t &number_t::operator--() {
-  _value--;
+  *this -= 1;
   return *this;
 }
 
@@ -162,36 +1110,326 @@ number_t number_t::operator--(int) {
 
 // unary operators
 number_t number_t::operator-() const {
-  return number_t(-_value);
+  number_t result(*this);
+  result._negative = !_negative;
+  result.normalize();
+  return result;
 }
 
 number_t number_t::operator+() const {
-  return number_t(+_value);
+  return *this;
 }
 
 number_t number_t::operator!() const {
-  return number_t(!_value);
+  return number_t(_magnitude.size() == 0);
 }
 
 number_t number_t::operator~() const {
-  return number_t(~_value);
+  // ~x is -x - 1 in two's complement
+  number_t result = -*this;
+  --result;
+  return result;
 }
 
-// binary shifts
+// binary shifts, negative count shifts in the other direction
 number_t &number_t::operator<<=(const number_t &num) {
-  _value <<= num._value;
+  long bits = static_cast<long>(num);
+  if (bits >= 0) {
+    shift_left(bits);
+  } else {
+    shift_right(-static_cast<size_t>(bits));
+  }
   return *this;
 }
 
 number_t &number_t::operator>>=(const number_t &num) {
-  _value >>= num._value;
+  long bits = static_cast<long>(num);
+  if (bits >= 0) {
+    shift_right(bits);
+  } else {
+    shift_left(-static_cast<size_t>(bits));
+  }
   return *this;
 }
 
 number_t number_t::operator<<(const number_t &num) const {
-  return number_t(_value << num._value);
+  number_t result(*this);
+  result <<= num;
+  return result;
 }
 
 number_t number_t::operator>>(const number_t &num) const {
-  return number_t(_value >> num._value);
-}
\ No newline at end of file
+  number_t result(*this);
+  result >>= num;
+  return result;
+}
+
+// batch operations
+static constexpr size_t BATCH_LANES = 4;
+
+// four 64-bit lanes in one AVX2 register, two SSE2 registers or scalars
+struct lanes_t {
+#if defined(__AVX2__)
+  __m256i v;
+#elif defined(__SSE2__)
+  __m128i v[2];
+#else
+  uint64_t v[BATCH_LANES];
+#endif
+};
+
+#if defined(__AVX2__)
+static lanes_t load_lanes(const int64_t *values) {
+  return {_mm256_load_si256(reinterpret_cast<const __m256i *>(values))};
+}
+static void store_lanes(int64_t *values, lanes_t lanes) {
+  _mm256_store_si256(reinterpret_cast<__m256i *>(values), lanes.v);
+}
+static lanes_t broadcast_lanes(uint64_t value) {
+  return {_mm256_set1_epi64x(static_cast<int64_t>(value))};
+}
+#define LANES_BINARY(name, intrinsic)                                                                                  \
+  static lanes_t name(lanes_t a, lanes_t b) {                                                                          \
+    return {_mm256_##intrinsic(a.v, b.v)};                                                                             \
+  }
+LANES_BINARY(add_lanes, add_epi64)
+LANES_BINARY(subtract_lanes, sub_epi64)
+LANES_BINARY(xor_lanes, xor_si256)
+LANES_BINARY(and_lanes, and_si256)
+LANES_BINARY(or_lanes, or_si256)
+#undef LANES_BINARY
+static lanes_t shift_left_lanes(lanes_t a, unsigned bits) {
+  return {_mm256_sll_epi64(a.v, _mm_cvtsi32_si128(bits))};
+}
+static lanes_t shift_right_lanes(lanes_t a, unsigned bits) {
+  return {_mm256_srl_epi64(a.v, _mm_cvtsi32_si128(bits))};
+}
+// mask of lanes with the highest bit set
+static unsigned sign_mask(lanes_t a) {
+  return _mm256_movemask_pd(_mm256_castsi256_pd(a.v));
+}
+#elif defined(__SSE2__)
+static lanes_t load_lanes(const int64_t *values) {
+  const auto *data = reinterpret_cast<const __m128i *>(values);
+  return {{_mm_load_si128(data), _mm_load_si128(data + 1)}};
+}
+static void store_lanes(int64_t *values, lanes_t lanes) {
+  auto *data = reinterpret_cast<__m128i *>(values);
+  _mm_store_si128(data, lanes.v[0]);
+  _mm_store_si128(data + 1, lanes.v[1]);
+}
+static lanes_t broadcast_lanes(uint64_t value) {
+  __m128i v = _mm_set1_epi64x(static_cast<int64_t>(value));
+  return {{v, v}};
+}
+#define LANES_BINARY(name, intrinsic)                                                                                  \
+  static lanes_t name(lanes_t a, lanes_t b) {                                                                          \
+    return {{_mm_##intrinsic(a.v[0], b.v[0]), _mm_##intrinsic(a.v[1], b.v[1])}};                                       \
+  }
+LANES_BINARY(add_lanes, add_epi64)
+LANES_BINARY(subtract_lanes, sub_epi64)
+LANES_BINARY(xor_lanes, xor_si128)
+LANES_BINARY(and_lanes, and_si128)
+LANES_BINARY(or_lanes, or_si128)
+#undef LANES_BINARY
+static lanes_t shift_left_lanes(lanes_t a, unsigned bits) {
+  __m128i count = _mm_cvtsi32_si128(bits);
+  return {{_mm_sll_epi64(a.v[0], count), _mm_sll_epi64(a.v[1], count)}};
+}
+static lanes_t shift_right_lanes(lanes_t a, unsigned bits) {
+  __m128i count = _mm_cvtsi32_si128(bits);
+  return {{_mm_srl_epi64(a.v[0], count), _mm_srl_epi64(a.v[1], count)}};
+}
+static unsigned sign_mask(lanes_t a) {
+  return _mm_movemask_pd(_mm_castsi128_pd(a.v[0])) | _mm_movemask_pd(_mm_castsi128_pd(a.v[1])) << 2;
+}
+#else
+static lanes_t load_lanes(const int64_t *values) {
+  lanes_t lanes;
+  std::copy(values, values + BATCH_LANES, lanes.v);
+  return lanes;
+}
+static void store_lanes(int64_t *values, lanes_t lanes) {
+  std::copy(lanes.v, lanes.v + BATCH_LANES, values);
+}
+static lanes_t broadcast_lanes(uint64_t value) {
+  return {{value, value, value, value}};
+}
+#define LANES_BINARY(name, op)                                                                                         \
+  static lanes_t name(lanes_t a, lanes_t b) {                                                                          \
+    for (size_t lane = 0; lane < BATCH_LANES; ++lane) {                                                                \
+      a.v[lane] = a.v[lane] op b.v[lane];                                                                              \
+    }                                                                                                                  \
+    return a;                                                                                                          \
+  }
+LANES_BINARY(add_lanes, +)
+LANES_BINARY(subtract_lanes, -)
+LANES_BINARY(xor_lanes, ^)
+LANES_BINARY(and_lanes, &)
+LANES_BINARY(or_lanes, |)
+#undef LANES_BINARY
+// like SIMD shifts, all bits are shifted out by 64 bits and more
+static lanes_t shift_left_lanes(lanes_t a, unsigned bits) {
+  for (size_t lane = 0; lane < BATCH_LANES; ++lane) {
+    a.v[lane] = bits < 64 ? a.v[lane] << bits : 0;
+  }
+  return a;
+}
+static lanes_t shift_right_lanes(lanes_t a, unsigned bits) {
+  for (size_t lane = 0; lane < BATCH_LANES; ++lane) {
+    a.v[lane] = bits < 64 ? a.v[lane] >> bits : 0;
+  }
+  return a;
+}
+static unsigned sign_mask(lanes_t a) {
+  unsigned mask = 0;
+  for (size_t lane = 0; lane < BATCH_LANES; ++lane) {
+    mask |= static_cast<unsigned>(a.v[lane] >> 63) << lane;
+  }
+  return mask;
+}
+#endif
+
+// mask of nonzero lanes
+static unsigned nonzero_mask(lanes_t a) {
+  return sign_mask(or_lanes(a, subtract_lanes(broadcast_lanes(0), a)));
+}
+
+// signed comparison a < b of lanes, a - b overflows only if signs of a and b differ
+static unsigned less_mask(lanes_t a, lanes_t b) {
+  lanes_t difference = subtract_lanes(a, b);
+  lanes_t overflow = and_lanes(xor_lanes(a, b), xor_lanes(a, difference));
+  return sign_mask(xor_lanes(difference, overflow));
+}
+
+unsigned number_t::gather_small(const number_t *nums, size_t count, int64_t *values) {
+  unsigned mask = 0;
+  for (size_t lane = 0; lane < BATCH_LANES; ++lane) {
+    // lanes behind count are zeros
+    bool small = lane < count && nums[lane].is_small();
+    values[lane] = small ? nums[lane].small_value() : 0;
+    mask |= static_cast<unsigned>(small) << lane;
+  }
+  return mask;
+}
+
+template <typename kernel_t, typename fallback_t>
+void number_t::batch(const number_t *a, const number_t *b, number_t *result, size_t count, kernel_t kernel,
+                     fallback_t fallback) {
+  alignas(32) int64_t a_values[BATCH_LANES];
+  alignas(32) int64_t b_values[BATCH_LANES] = {};
+  alignas(32) int64_t result_values[BATCH_LANES];
+  for (size_t first = 0; first < count; first += BATCH_LANES) {
+    size_t lanes = std::min(BATCH_LANES, count - first);
+    unsigned small = gather_small(a + first, lanes, a_values);
+    if (b != nullptr) {
+      small &= gather_small(b + first, lanes, b_values);
+    }
+    // whole block is read before results are written, so result may be an operand
+    lanes_t values = kernel(load_lanes(a_values), load_lanes(b_values), &small);
+    store_lanes(result_values, values);
+    for (size_t lane = 0; lane < lanes; ++lane) {
+      if (small >> lane & 1) {
+        result[first + lane].assign(result_values[lane]);
+      } else {
+        fallback(a[first + lane], b == nullptr ? a[first + lane] : b[first + lane], result[first + lane]);
+      }
+    }
+  }
+}
+
+void number_t::batch_add(const number_t *a, const number_t *b, number_t *result, size_t count) {
+  batch(
+      a, b, result, count,
+      [](lanes_t x, lanes_t y, unsigned *mask) {
+        // sum overflows if its sign differs from signs of both operands
+        lanes_t sum = add_lanes(x, y);
+        *mask &= ~sign_mask(and_lanes(xor_lanes(x, sum), xor_lanes(y, sum)));
+        return sum;
+      },
+      [](const number_t &x, const number_t &y, number_t &sum) { sum = x + y; });
+}
+
+void number_t::batch_subtract(const number_t *a, const number_t *b, number_t *result, size_t count) {
+  batch(
+      a, b, result, count,
+      [](lanes_t x, lanes_t y, unsigned *mask) {
+        // difference overflows if signs of operands differ and its sign differs from sign of x
+        lanes_t difference = subtract_lanes(x, y);
+        *mask &= ~sign_mask(and_lanes(xor_lanes(x, y), xor_lanes(x, difference)));
+        return difference;
+      },
+      [](const number_t &x, const number_t &y, number_t &difference) { difference = x - y; });
+}
+
+// bitwise operations of int64_t values are the same as of infinite two's complement and never overflow
+void number_t::batch_xor(const number_t *a, const number_t *b, number_t *result, size_t count) {
+  batch(
+      a, b, result, count, [](lanes_t x, lanes_t y, unsigned *) { return xor_lanes(x, y); },
+      [](const number_t &x, const number_t &y, number_t &value) { value = x ^ y; });
+}
+
+void number_t::batch_and(const number_t *a, const number_t *b, number_t *result, size_t count) {
+  batch(
+      a, b, result, count, [](lanes_t x, lanes_t y, unsigned *) { return and_lanes(x, y); },
+      [](const number_t &x, const number_t &y, number_t &value) { value = x & y; });
+}
+
+void number_t::batch_or(const number_t *a, const number_t *b, number_t *result, size_t count) {
+  batch(
+      a, b, result, count, [](lanes_t x, lanes_t y, unsigned *) { return or_lanes(x, y); },
+      [](const number_t &x, const number_t &y, number_t &value) { value = x | y; });
+}
+
+void number_t::batch_shift_left(const number_t *a, size_t bits, number_t *result, size_t count) {
+  const number_t shift = static_cast<long>(bits);
+  batch(
+      a, nullptr, result, count,
+      [bits](lanes_t x, lanes_t, unsigned *mask) {
+        if (bits == 0) {
+          return x;
+        }
+        if (bits >= 63) {
+          // only zeros stay small
+          *mask &= ~nonzero_mask(x);
+          return broadcast_lanes(0);
+        }
+        // x << bits fits if x is in [-2^(63 - bits), 2^(63 - bits))
+        lanes_t biased = add_lanes(x, broadcast_lanes(uint64_t(1) << (63 - bits)));
+        *mask &= ~nonzero_mask(shift_right_lanes(biased, 64 - bits));
+        return shift_left_lanes(x, bits);
+      },
+      [&shift](const number_t &x, const number_t &, number_t &value) { value = x << shift; });
+}
+
+void number_t::batch_shift_right(const number_t *a, size_t bits, number_t *result, size_t count) {
+  const number_t shift = static_cast<long>(bits);
+  batch(
+      a, nullptr, result, count,
+      [bits](lanes_t x, lanes_t, unsigned *) {
+        // arithmetic shift by logical one: x >> bits = ((x ^ sign) >>> bits) ^ sign, floor like shift_right
+        lanes_t sign = subtract_lanes(broadcast_lanes(0), shift_right_lanes(x, 63));
+        return xor_lanes(shift_right_lanes(xor_lanes(x, sign), std::min<size_t>(bits, 63)), sign);
+      },
+      [&shift](const number_t &x, const number_t &, number_t &value) { value = x >> shift; });
+}
+
+void number_t::batch_compare(const number_t *a, const number_t *b, int *result, size_t count) {
+  alignas(32) int64_t a_values[BATCH_LANES];
+  alignas(32) int64_t b_values[BATCH_LANES];
+  for (size_t first = 0; first < count; first += BATCH_LANES) {
+    size_t lanes = std::min(BATCH_LANES, count - first);
+    unsigned small = gather_small(a + first, lanes, a_values) & gather_small(b + first, lanes, b_values);
+    lanes_t x = load_lanes(a_values);
+    lanes_t y = load_lanes(b_values);
+    unsigned less = less_mask(x, y);
+    unsigned greater = less_mask(y, x);
+    for (size_t lane = 0; lane < lanes; ++lane) {
+      if (small >> lane & 1) {
+        result[first + lane] = static_cast<int>(greater >> lane & 1) - static_cast<int>(less >> lane & 1);
+      } else {
+        result[first + lane] = compare(a[first + lane], b[first + lane]);
+      }
+    }
+  }
+}
@@ -1,14 +1,53 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <charconv>
 #include <iostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+class number_t;
+
+// operations which are evaluated lazily, see number_expr_t
+struct number_add_t;
+struct number_subtract_t;
+struct number_multiply_t;
+
+template <typename op_t, typename lhs_t, typename rhs_t>
+class number_expr_t;
 
 class number_t {
 public:
   number_t();
   number_t(long); // implicit conv
+  number_t(const number_t &);
+  number_t(number_t &&) noexcept;
+  /**
+   * Evaluate expression directly into the new number
+   */
+  template <typename op_t, typename lhs_t, typename rhs_t>
+  number_t(const number_expr_t<op_t, lhs_t, rhs_t> &expr) {
+    expr.evaluate_into(*this);
+  }
   void swap(number_t &);
   number_t &operator=(const number_t &);
+  number_t &operator=(number_t &&) noexcept;
+  /**
+   * Evaluate expression into storage of this number, through a temporary only if
+   * the expression refers to this number
+   */
+  template <typename op_t, typename lhs_t, typename rhs_t>
+  number_t &operator=(const number_expr_t<op_t, lhs_t, rhs_t> &expr) {
+    if (expr.refers_to(*this)) {
+      number_t tmp(expr);
+      swap(tmp);
+    } else {
+      expr.evaluate_into(*this);
+    }
+    return *this;
+  }
 
   explicit operator bool() const;
   explicit operator long() const;
@@ -24,18 +63,43 @@ public:
   friend std::ostream &operator<<(std::ostream &, const number_t &);
   friend std::istream &operator>>(std::istream &, number_t &);
 
-  number_t operator+=(const number_t &);
-  number_t operator-=(const number_t &);
-  number_t operator*=(const number_t &);
-  number_t operator/=(const number_t &);
-  number_t operator%=(const number_t &);
-  number_t operator^=(const number_t &);
-  number_t operator&=(const number_t &);
-  number_t operator|=(const number_t &);
-
-  friend number_t operator+(const number_t &, const number_t &);
-  friend number_t operator-(const number_t &, const number_t &);
-  friend number_t operator*(const number_t &, const number_t &);
+  /**
+   * Decimal conversions into and from caller's buffers like std::to_chars and std::from_chars:
+   * no locale, no leading whitespace and no '+' sign. to_chars fails with value_too_large
+   * if the buffer is too short, max_chars_size() characters are always enough
+   */
+  friend std::to_chars_result to_chars(char *first, char *last, const number_t &);
+  friend std::from_chars_result from_chars(const char *first, const char *last, number_t &);
+  size_t max_chars_size() const;
+
+  /**
+   * Element-wise operations over arrays of count numbers, result[i] = a[i] op b[i]. Values which fit
+   * into int64_t are processed four at a time with SIMD, lanes which overflow are found by a mask and
+   * recomputed by the operators like all other values. result may be a or b, other overlaps aren't allowed
+   */
+  static void batch_add(const number_t *a, const number_t *b, number_t *result, size_t count);
+  static void batch_subtract(const number_t *a, const number_t *b, number_t *result, size_t count);
+  static void batch_xor(const number_t *a, const number_t *b, number_t *result, size_t count);
+  static void batch_and(const number_t *a, const number_t *b, number_t *result, size_t count);
+  static void batch_or(const number_t *a, const number_t *b, number_t *result, size_t count);
+  static void batch_shift_left(const number_t *a, size_t bits, number_t *result, size_t count);
+  static void batch_shift_right(const number_t *a, size_t bits, number_t *result, size_t count);
+  // result[i] is -1, 0 or 1 if a[i] is less, equal or greater than b[i]
+  static void batch_compare(const number_t *a, const number_t *b, int *result, size_t count);
+
+  number_t &operator+=(const number_t &);
+  number_t &operator-=(const number_t &);
+  number_t &operator*=(const number_t &);
+  number_t &operator/=(const number_t &);
+  number_t &operator%=(const number_t &);
+  number_t &operator^=(const number_t &);
+  number_t &operator&=(const number_t &);
+  number_t &operator|=(const number_t &);
+
+  // sums, differences and products are lazy, they are evaluated on assignment or conversion
+  friend number_expr_t<number_add_t, number_t, number_t> operator+(const number_t &, const number_t &);
+  friend number_expr_t<number_subtract_t, number_t, number_t> operator-(const number_t &, const number_t &);
+  friend number_expr_t<number_multiply_t, number_t, number_t> operator*(const number_t &, const number_t &);
   friend number_t operator/(const number_t &, const number_t &);
   friend number_t operator%(const number_t &, const number_t &);
   friend number_t operator^(const number_t &, const number_t &);
@@ -57,6 +121,270 @@ public:
   number_t operator<<(const number_t &) const;
   number_t operator>>(const number_t &) const;
 
+  /**
+   * Sizes in 64-bit limbs from which asymptotically faster algorithms are used,
+   * number-benchmark measures them
+   */
+  struct thresholds_t {
+    // smaller operand of multiplication, below it schoolbook multiplication is used
+    size_t karatsuba{48};
+    size_t toom3{768};
+    // divisor and quotient, below it Knuth's division is used
+    size_t recursive_division{64};
+    // value, below it decimal conversions are done 19 digits at a time without splitting, at most 32
+    size_t radix_conversion{32};
+  };
+  static thresholds_t thresholds;
+
 private:
-  long _value{0};
-};
\ No newline at end of file
+  template <typename op_t, typename lhs_t, typename rhs_t>
+  friend class number_expr_t;
+
+  /**
+   * Magnitude as little-endian 64-bit limbs without leading zero limbs, zero has no limbs.
+   * Up to INLINE_LIMBS limbs are stored inside the object, longer values spill to heap
+   */
+  class limbs_t {
+  public:
+    static constexpr uint32_t INLINE_LIMBS = 2;
+
+    limbs_t() = default;
+    limbs_t(const limbs_t &other);
+    limbs_t(limbs_t &&other) noexcept;
+    limbs_t &operator=(const limbs_t &other);
+    limbs_t &operator=(limbs_t &&other) noexcept;
+    ~limbs_t();
+
+    size_t size() const {
+      return _size;
+    }
+    uint64_t *data() {
+      return _capacity > INLINE_LIMBS ? _heap : _inline;
+    }
+    const uint64_t *data() const {
+      return _capacity > INLINE_LIMBS ? _heap : _inline;
+    }
+    uint64_t &operator[](size_t index) {
+      return data()[index];
+    }
+    uint64_t operator[](size_t index) const {
+      return data()[index];
+    }
+
+    /**
+     * Change number of limbs, new limbs are zero
+     * @param size
+     */
+    void resize(size_t size);
+    /**
+     * Drop leading zero limbs
+     */
+    void normalize();
+    void assign(uint64_t limb) {
+      _size = limb != 0;
+      data()[0] = limb;
+    }
+    void swap(limbs_t &other);
+
+  private:
+    uint32_t _size{0};
+    uint32_t _capacity{INLINE_LIMBS};
+    union {
+      uint64_t _inline[INLINE_LIMBS]{};
+      uint64_t *_heap;
+    };
+  };
+
+  // values in [-2^63 + 1, 2^63 - 1] take the fast paths on int64_t
+  bool is_small() const {
+    return _magnitude.size() == 0 || (_magnitude.size() == 1 && _magnitude[0] <= INT64_MAX);
+  }
+  int64_t small_value() const {
+    int64_t value = _magnitude.size() == 0 ? 0 : static_cast<int64_t>(_magnitude[0]);
+    return _negative ? -value : value;
+  }
+  void assign(int64_t value);
+  void assign(bool negative, uint64_t low, uint64_t high);
+  // sign of zero is always positive
+  void normalize();
+
+  static int compare(const number_t &num1, const number_t &num2);
+  static number_t from_limbs(const uint64_t *limbs, size_t size);
+  size_t bit_length() const;
+  // non-negative number made of the lowest bits of non-negative num
+  static number_t low_bits(const number_t &num, size_t bits);
+
+  // result has a_size + b_size limbs and doesn't overlap operands
+  static void multiply_magnitudes(const uint64_t *a, size_t a_size, const uint64_t *b, size_t b_size, uint64_t *result);
+  // a_size >= b_size >= a_size / 2
+  static void multiply_karatsuba(const uint64_t *a, size_t a_size, const uint64_t *b, size_t b_size, uint64_t *result);
+  static void multiply_toom3(const uint64_t *a, size_t a_size, const uint64_t *b, size_t b_size, uint64_t *result);
+
+  // divisions of non-negative numbers
+  static void divide_schoolbook(const number_t &a, const number_t &b, number_t &quotient, number_t &remainder);
+  // Burnikel-Ziegler: a is split into digits of bit length of b, they are divided one by one
+  static void divide_recursive(const number_t &a, const number_t &b, number_t &quotient, number_t &remainder);
+  // a < b * 2^n, b has n bits
+  static void divide_2n_by_n(const number_t &a, const number_t &b, size_t n, number_t &quotient, number_t &remainder);
+  static void divide_3n_by_2n(const number_t &a12, const number_t &a3, const number_t &b, const number_t &b1,
+                              const number_t &b2, size_t n, number_t &quotient, number_t &remainder);
+  // decimal conversions of magnitudes, values above thresholds.radix_conversion are split on
+  // decimal_power(k) = 10^(19 * 2^k). write_decimal pads to width digits, returns null if last is reached
+  static const number_t &decimal_power(size_t k);
+  static char *write_decimal(const number_t &num, size_t width, char *first, char *last);
+  // result = digits in [first, last)
+  static void read_decimal(const char *first, const char *last, number_t &result);
+  // mask of nums which fit into int64_t, their values go to values
+  static unsigned gather_small(const number_t *nums, size_t count, int64_t *values);
+  // kernel computes a block of lanes and returns the mask of overflowing ones, fallback computes one element
+  template <typename kernel_t, typename fallback_t>
+  static void batch(const number_t *a, const number_t *b, number_t *result, size_t count, kernel_t kernel,
+                    fallback_t fallback);
+  // this += negate ? -num : num
+  void add(const number_t &num, bool negate);
+  void multiply(const number_t &num);
+  // result = num1 * num2 in storage of result, which must not be an operand
+  static void multiply_into(number_t &result, const number_t &num1, const number_t &num2);
+  // truncating division like for built-in integers, quotient or remainder may be null
+  static void divide(const number_t &dividend, const number_t &divisor, number_t *quotient, number_t *remainder);
+  // bitwise operators work on infinite two's complement representation
+  template <typename op_t>
+  void bitwise(const number_t &num, op_t op);
+  void shift_left(size_t bits);
+  // rounds towards minus infinity like arithmetic shift
+  void shift_right(size_t bits);
+
+  limbs_t _magnitude;
+  bool _negative{false};
+};
+
+struct number_add_t {
+  static void apply(number_t &result, const number_t &num) {
+    result += num;
+  }
+};
+
+struct number_subtract_t {
+  static void apply(number_t &result, const number_t &num) {
+    result -= num;
+  }
+};
+
+struct number_multiply_t {
+  static void apply(number_t &result, const number_t &num) {
+    result *= num;
+  }
+};
+
+/**
+ * Lazy lhs op rhs, operands are numbers or other expressions. Numbers are held by reference,
+ * so an expression must be used within the full-expression which created it (don't store it in auto)
+ */
+template <typename op_t, typename lhs_t, typename rhs_t>
+class number_expr_t {
+public:
+  number_expr_t(const lhs_t &lhs, const rhs_t &rhs) : _lhs(lhs), _rhs(rhs) {}
+
+  explicit operator bool() const {
+    return static_cast<bool>(number_t(*this));
+  }
+  explicit operator long() const {
+    return static_cast<long>(number_t(*this));
+  }
+  explicit operator std::string() const {
+    return static_cast<std::string>(number_t(*this));
+  }
+
+  number_t operator-() const {
+    return -number_t(*this);
+  }
+  number_t operator+() const {
+    return number_t(*this);
+  }
+  number_t operator!() const {
+    return !number_t(*this);
+  }
+  number_t operator~() const {
+    return ~number_t(*this);
+  }
+  number_t operator<<(const number_t &num) const {
+    return number_t(*this) << num;
+  }
+  number_t operator>>(const number_t &num) const {
+    return number_t(*this) >> num;
+  }
+
+  bool refers_to(const number_t &num) const {
+    return refers_to(_lhs, num) || refers_to(_rhs, num);
+  }
+
+  /**
+   * result = lhs op rhs, result must not be referred by expression
+   */
+  void evaluate_into(number_t &result) const {
+    if constexpr (std::is_same_v<op_t, number_multiply_t> && std::is_same_v<lhs_t, number_t> &&
+                  std::is_same_v<rhs_t, number_t>) {
+      number_t::multiply_into(result, _lhs, _rhs);
+    } else {
+      if constexpr (std::is_same_v<lhs_t, number_t>) {
+        result = _lhs;
+      } else {
+        _lhs.evaluate_into(result);
+      }
+      if constexpr (std::is_same_v<rhs_t, number_t>) {
+        op_t::apply(result, _rhs);
+      } else {
+        op_t::apply(result, number_t(_rhs));
+      }
+    }
+  }
+
+private:
+  static bool refers_to(const number_t &operand, const number_t &num) {
+    return &operand == &num;
+  }
+  template <typename expr_t>
+  static bool refers_to(const expr_t &operand, const number_t &num) {
+    return operand.refers_to(num);
+  }
+
+  // numbers by reference, expressions by value
+  std::conditional_t<std::is_same_v<lhs_t, number_t>, const number_t &, lhs_t> _lhs;
+  std::conditional_t<std::is_same_v<rhs_t, number_t>, const number_t &, rhs_t> _rhs;
+};
+
+inline number_expr_t<number_add_t, number_t, number_t> operator+(const number_t &num1, const number_t &num2) {
+  return {num1, num2};
+}
+
+inline number_expr_t<number_subtract_t, number_t, number_t> operator-(const number_t &num1, const number_t &num2) {
+  return {num1, num2};
+}
+
+inline number_expr_t<number_multiply_t, number_t, number_t> operator*(const number_t &num1, const number_t &num2) {
+  return {num1, num2};
+}
+
+// operators with expressions on either side build larger expressions
+#define NUMBER_EXPR_OPERATOR(op, op_type)                                                                              \
+  template <typename op_t, typename lhs_t, typename rhs_t>                                                             \
+  number_expr_t<op_type, number_expr_t<op_t, lhs_t, rhs_t>, number_t> operator op(                                     \
+      const number_expr_t<op_t, lhs_t, rhs_t> &expr, const number_t &num) {                                            \
+    return {expr, num};                                                                                                \
+  }                                                                                                                    \
+  template <typename op_t, typename lhs_t, typename rhs_t>                                                             \
+  number_expr_t<op_type, number_t, number_expr_t<op_t, lhs_t, rhs_t>> operator op(                                     \
+      const number_t &num, const number_expr_t<op_t, lhs_t, rhs_t> &expr) {                                            \
+    return {num, expr};                                                                                                \
+  }                                                                                                                    \
+  template <typename op1_t, typename lhs1_t, typename rhs1_t, typename op2_t, typename lhs2_t, typename rhs2_t>        \
+  number_expr_t<op_type, number_expr_t<op1_t, lhs1_t, rhs1_t>, number_expr_t<op2_t, lhs2_t, rhs2_t>> operator op(      \
+      const number_expr_t<op1_t, lhs1_t, rhs1_t> &expr1, const number_expr_t<op2_t, lhs2_t, rhs2_t> &expr2) {          \
+    return {expr1, expr2};                                                                                             \
+  }
+
+NUMBER_EXPR_OPERATOR(+, number_add_t)
+NUMBER_EXPR_OPERATOR(-, number_subtract_t)
+NUMBER_EXPR_OPERATOR(*, number_multiply_t)
+
+#undef NUMBER_EXPR_OPERATOR
@@ -0,0 +1,146 @@
+#include "gtest/gtest.h"
+
+#include "compressed-trie.h"
+#include "trie-naive.h"
+#include "trie-test-utils.h"
+#include "trie.h"
+
+TEST(CompressedTrie, EmptyTrie) {
+  compressed_trie_t actual;
+  trie_naive_t expected;
+  FULL_COMPARE(actual, expected);
+  ASSERT_FALSE(actual.find(""));
+  ASSERT_EQ(0, actual.count_with_prefix("a"));
+}
+
+TEST(CompressedTrie, SplitAndMergeEdges) {
+  compressed_trie_t actual;
+  trie_naive_t expected;
+
+  INSERT(actual, expected, "abacaba");
+  INSERT(actual, expected, "abad");
+  INSERT(actual, expected, "ab");
+  INSERT(actual, expected, "");
+  INSERT(actual, expected, "abacaba");
+  FULL_COMPARE(actual, expected);
+
+  // prefixes which end inside an edge label
+  for (const std::string prefix : {"a", "aba", "abac", "abaca", "abacabaa", "b", "abd"}) {
+    ASSERT_EQ(actual.count_with_prefix(prefix), expected.count_with_prefix(prefix));
+    ASSERT_EQ(actual.find(prefix), expected.find(prefix));
+  }
+
+  ERASE(actual, expected, "ab");
+  ERASE(actual, expected, "aba");
+  ERASE(actual, expected, "abad");
+  FULL_COMPARE(actual, expected);
+  ASSERT_EQ(actual.count_with_prefix("abac"), expected.count_with_prefix("abac"));
+
+  ERASE(actual, expected, "abacaba");
+  ERASE(actual, expected, "abacaba");
+  ERASE(actual, expected, "abacaba");
+  ERASE(actual, expected, "");
+  FULL_COMPARE(actual, expected);
+}
+
+TEST(CompressedTrie, CopyAndSwap) {
+  compressed_trie_t actual;
+  trie_naive_t expected;
+  INSERT(actual, expected, "abc");
+  INSERT(actual, expected, "abd");
+
+  compressed_trie_t copy = actual;
+  ERASE(actual, expected, "abc");
+  ASSERT_EQ(2, copy.size());
+  ASSERT_TRUE(copy.find("abc"));
+
+  copy = copy;
+  ASSERT_EQ(2, copy.size());
+
+  copy.swap(actual);
+  ASSERT_EQ(1, copy.size());
+  ASSERT_EQ(2, actual.size());
+
+  actual = copy;
+  FULL_COMPARE(actual, expected);
+
+  actual.clear();
+  expected.clear();
+  FULL_COMPARE(actual, expected);
+}
+
+TEST(CompressedTrie, RandomEraseAndInsert) {
+  compressed_trie_t actual;
+  trie_naive_t expected;
+
+  const auto gen_str = [](size_t len) {
+    std::string res;
+    std::generate_n(std::back_inserter(res), len, []() { return 'a' + rnd(0, 2); });
+    return res;
+  };
+
+  size_t iterations = 20000;
+  for (size_t i = 0; i < iterations; ++i) {
+    std::string key = gen_str(rnd(0, 8));
+    if (rnd(0, 2) != 0) {
+      INSERT(actual, expected, key);
+    } else {
+      ERASE(actual, expected, key);
+    }
+    std::string prefix = gen_str(rnd(0, 4));
+    ASSERT_EQ(actual.count_with_prefix(prefix), expected.count_with_prefix(prefix));
+  }
+  FULL_COMPARE(actual, expected);
+}
+
+TEST(CompressedTrie, PoolCompaction) {
+  compressed_trie_t actual;
+  trie_naive_t expected;
+
+  std::vector<std::string> keys;
+  for (size_t i = 0; i < 2000; ++i) {
+    std::string key = "key/" + std::to_string(rnd(0, 1000000)) + "/" + std::to_string(i);
+    keys.push_back(key);
+    INSERT(actual, expected, key);
+  }
+  size_t memory_before = actual.memory_usage();
+  for (size_t i = 0; i < keys.size(); ++i) {
+    if (i % 10 != 0) {
+      ERASE(actual, expected, keys[i]);
+    }
+  }
+  FULL_COMPARE(actual, expected);
+
+  // erased labels are reclaimed, so reinserting doesn't grow the trie
+  for (size_t i = 0; i < keys.size(); ++i) {
+    if (i % 10 != 0) {
+      INSERT(actual, expected, keys[i]);
+    }
+  }
+  FULL_COMPARE(actual, expected);
+  ASSERT_LE(actual.memory_usage(), 2 * memory_before);
+}
+
+TEST(CompressedTrie, MemoryUsage) {
+  compressed_trie_t compressed;
+  trie_t plain;
+  trie_naive_t naive;
+
+  // URL-like keys with long shared prefixes
+  for (size_t i = 0; i < 2000; ++i) {
+    std::string key = "https://example.com/catalog/item-" + std::to_string(rnd(0, 1000000)) + "/reviews?page=" +
+                      std::to_string(rnd(1, 20));
+    compressed.insert(key);
+    plain.insert(key);
+    naive.insert(key);
+  }
+  ASSERT_EQ(compressed.to_vector(), naive.to_vector());
+
+  ASSERT_LT(compressed.memory_usage(), plain.memory_usage());
+  ASSERT_LT(compressed.memory_usage(), naive.memory_usage());
+  std::cout << "compressed trie: " << compressed.memory_usage() << " bytes" << std::endl
+            << "trie: " << plain.memory_usage() << " bytes (" << plain.memory_usage() - compressed.memory_usage()
+            << " bytes saved)" << std::endl
+            << "naive trie: " << naive.memory_usage() << " bytes ("
+            << naive.memory_usage() - compressed.memory_usage() << " bytes saved)" << std::endl;
+}
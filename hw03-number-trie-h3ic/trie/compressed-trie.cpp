@@ -0,0 +1,282 @@
+#include "compressed-trie.h"
+
+#include <cassert>
+
+// pool is rebuilt once more than a half of it (and at least this much) is garbage
+static constexpr size_t MIN_POOL_GARBAGE_TO_COMPACT = 4096;
+
+compressed_trie_t::compressed_trie_t() : nodes(1) {}
+
+compressed_trie_t::~compressed_trie_t() = default;
+
+compressed_trie_t::compressed_trie_t(const compressed_trie_t &other) = default;
+
+compressed_trie_t &compressed_trie_t::operator=(const compressed_trie_t &other) {
+  compressed_trie_t tmp(other);
+  swap(tmp);
+  return *this;
+}
+
+unsigned char compressed_trie_t::first_symbol(uint32_t node) const {
+  return static_cast<unsigned char>(pool[nodes[node].label_offset]);
+}
+
+uint32_t compressed_trie_t::find_child(uint32_t node, unsigned char symbol, uint32_t *prev) const {
+  *prev = NO_NODE;
+  uint32_t child = nodes[node].first_child;
+  while (child != NO_NODE && first_symbol(child) < symbol) {
+    *prev = child;
+    child = nodes[child].next_sibling;
+  }
+  return child;
+}
+
+size_t compressed_trie_t::common_length(uint32_t node, const std::string &str, size_t pos) const {
+  const node_t &n = nodes[node];
+  size_t length = 0;
+  while (length < n.label_length && pos + length < str.size() &&
+         pool[n.label_offset + length] == str[pos + length]) {
+    ++length;
+  }
+  return length;
+}
+
+uint32_t compressed_trie_t::locate(const std::string &str, bool exact) const {
+  uint32_t node = 0;
+  size_t pos = 0;
+  while (pos < str.size()) {
+    uint32_t prev = NO_NODE;
+    uint32_t child = find_child(node, static_cast<unsigned char>(str[pos]), &prev);
+    if (child == NO_NODE || first_symbol(child) != static_cast<unsigned char>(str[pos])) {
+      return NO_NODE;
+    }
+    size_t length = common_length(child, str, pos);
+    if (length < nodes[child].label_length) {
+      // str ends inside the label: child is the subtree of all strings with prefix str
+      return (!exact && pos + length == str.size()) ? child : NO_NODE;
+    }
+    pos += length;
+    node = child;
+  }
+  return node;
+}
+
+uint32_t compressed_trie_t::new_node(uint32_t label_offset, uint32_t label_length) {
+  uint32_t node = free_list;
+  if (node == NO_NODE) {
+    node = nodes.size();
+    nodes.emplace_back();
+  } else {
+    free_list = nodes[node].next_sibling;
+    nodes[node] = node_t{};
+  }
+  nodes[node].label_offset = label_offset;
+  nodes[node].label_length = label_length;
+  return node;
+}
+
+void compressed_trie_t::free_node(uint32_t node) {
+  pool_garbage += nodes[node].label_length;
+  nodes[node].label_length = 0;
+  nodes[node].next_sibling = free_list;
+  free_list = node;
+}
+
+void compressed_trie_t::insert(const std::string &str) {
+  uint32_t node = 0;
+  size_t pos = 0;
+  ++nodes[node].subtree_count;
+  while (pos < str.size()) {
+    auto symbol = static_cast<unsigned char>(str[pos]);
+    uint32_t prev = NO_NODE;
+    uint32_t child = find_child(node, symbol, &prev);
+    if (child == NO_NODE || first_symbol(child) != symbol) {
+      // the rest of str becomes a new leaf
+      uint32_t leaf = new_node(pool.size(), str.size() - pos);
+      pool.append(str, pos, std::string::npos);
+      nodes[leaf].next_sibling = child;
+      nodes[leaf].subtree_count = 1;
+      nodes[leaf].end_count = 1;
+      if (prev == NO_NODE) {
+        nodes[node].first_child = leaf;
+      } else {
+        nodes[prev].next_sibling = leaf;
+      }
+      return;
+    }
+
+    size_t length = common_length(child, str, pos);
+    if (length < nodes[child].label_length) {
+      // split the edge: the common part of the label moves to a new middle node
+      uint32_t middle = new_node(nodes[child].label_offset, length);
+      nodes[middle].first_child = child;
+      nodes[middle].next_sibling = nodes[child].next_sibling;
+      nodes[middle].subtree_count = nodes[child].subtree_count;
+      nodes[child].label_offset += length;
+      nodes[child].label_length -= length;
+      nodes[child].next_sibling = NO_NODE;
+      if (prev == NO_NODE) {
+        nodes[node].first_child = middle;
+      } else {
+        nodes[prev].next_sibling = middle;
+      }
+      child = middle;
+    }
+    node = child;
+    pos += length;
+    ++nodes[node].subtree_count;
+  }
+  ++nodes[node].end_count;
+}
+
+void compressed_trie_t::merge_with_child(uint32_t node) {
+  uint32_t child = nodes[node].first_child;
+  node_t &n = nodes[node];
+  const node_t &c = nodes[child];
+  if (n.label_offset + n.label_length == c.label_offset) {
+    n.label_length += c.label_length;
+  } else {
+    // labels are not adjacent in pool, so the merged label is appended
+    std::string label = pool.substr(n.label_offset, n.label_length) + pool.substr(c.label_offset, c.label_length);
+    pool_garbage += label.size();
+    n.label_offset = pool.size();
+    n.label_length = label.size();
+    pool += label;
+  }
+  n.first_child = c.first_child;
+  n.end_count = c.end_count;
+  nodes[child].label_length = 0;
+  free_node(child);
+}
+
+bool compressed_trie_t::erase(const std::string &str) {
+  if (!find(str)) {
+    return false;
+  }
+  uint32_t node = 0;
+  size_t pos = 0;
+  --nodes[node].subtree_count;
+  while (pos < str.size()) {
+    uint32_t prev = NO_NODE;
+    uint32_t child = find_child(node, static_cast<unsigned char>(str[pos]), &prev);
+    pos += nodes[child].label_length;
+    if (--nodes[child].subtree_count == 0) {
+      // child is a leaf holding only this string
+      if (prev == NO_NODE) {
+        nodes[node].first_child = nodes[child].next_sibling;
+      } else {
+        nodes[prev].next_sibling = nodes[child].next_sibling;
+      }
+      free_node(child);
+      // node may be left with a single child and no strings of its own
+      if (node != 0 && nodes[node].end_count == 0 && nodes[nodes[node].first_child].next_sibling == NO_NODE) {
+        merge_with_child(node);
+      }
+      node = NO_NODE;
+      break;
+    }
+    node = child;
+  }
+  if (node != NO_NODE) {
+    --nodes[node].end_count;
+    if (node != 0 && nodes[node].end_count == 0 && nodes[nodes[node].first_child].next_sibling == NO_NODE) {
+      merge_with_child(node);
+    }
+  }
+
+  if (pool_garbage >= MIN_POOL_GARBAGE_TO_COMPACT && 2 * pool_garbage > pool.size()) {
+    compact_pool();
+  }
+  return true;
+}
+
+void compressed_trie_t::compact_pool() {
+  std::string compacted;
+  compacted.reserve(pool.size() - pool_garbage);
+  std::vector<uint32_t> stack = {0};
+  while (!stack.empty()) {
+    uint32_t node = stack.back();
+    stack.pop_back();
+    node_t &n = nodes[node];
+    uint32_t offset = compacted.size();
+    compacted.append(pool, n.label_offset, n.label_length);
+    n.label_offset = offset;
+    for (uint32_t child = n.first_child; child != NO_NODE; child = nodes[child].next_sibling) {
+      stack.push_back(child);
+    }
+  }
+  pool = std::move(compacted);
+  pool_garbage = 0;
+}
+
+void compressed_trie_t::clear() {
+  nodes.assign(1, node_t{});
+  free_list = NO_NODE;
+  pool.clear();
+  pool_garbage = 0;
+}
+
+bool compressed_trie_t::find(const std::string &str) const {
+  uint32_t node = locate(str, true);
+  return node != NO_NODE && nodes[node].end_count > 0;
+}
+
+size_t compressed_trie_t::count_with_prefix(const std::string &prefix) const {
+  uint32_t node = locate(prefix, false);
+  return node == NO_NODE ? 0 : nodes[node].subtree_count;
+}
+
+std::string compressed_trie_t::operator[](size_t index) const {
+  assert(index < size());
+  std::string result;
+  uint32_t node = 0;
+  // skip subtrees which hold fewer strings than index
+  while (index >= nodes[node].end_count) {
+    index -= nodes[node].end_count;
+    uint32_t child = nodes[node].first_child;
+    while (index >= nodes[child].subtree_count) {
+      index -= nodes[child].subtree_count;
+      child = nodes[child].next_sibling;
+    }
+    result.append(pool, nodes[child].label_offset, nodes[child].label_length);
+    node = child;
+  }
+  return result;
+}
+
+void compressed_trie_t::collect(uint32_t node, std::string &buffer, std::vector<std::string> &result) const {
+  result.insert(result.end(), nodes[node].end_count, buffer);
+  for (uint32_t child = nodes[node].first_child; child != NO_NODE; child = nodes[child].next_sibling) {
+    size_t length = buffer.size();
+    buffer.append(pool, nodes[child].label_offset, nodes[child].label_length);
+    collect(child, buffer, result);
+    buffer.resize(length);
+  }
+}
+
+std::vector<std::string> compressed_trie_t::to_vector() const {
+  std::vector<std::string> result;
+  result.reserve(size());
+  std::string buffer;
+  collect(0, buffer, result);
+  return result;
+}
+
+size_t compressed_trie_t::size() const {
+  return nodes[0].subtree_count;
+}
+
+bool compressed_trie_t::empty() const {
+  return size() == 0;
+}
+
+void compressed_trie_t::swap(compressed_trie_t &other) {
+  std::swap(nodes, other.nodes);
+  std::swap(free_list, other.free_list);
+  std::swap(pool, other.pool);
+  std::swap(pool_garbage, other.pool_garbage);
+}
+
+size_t compressed_trie_t::memory_usage() const {
+  return sizeof(*this) + nodes.capacity() * sizeof(node_t) + pool.capacity();
+}
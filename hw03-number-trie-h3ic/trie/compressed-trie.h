@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Radix (Patricia) trie with the same interface as trie_t: chains of nodes
+ * with a single child are merged into one edge, and edge labels are slices
+ * of a single shared string pool
+ */
+class compressed_trie_t {
+public:
+  compressed_trie_t();
+  ~compressed_trie_t();
+
+  compressed_trie_t(const compressed_trie_t &other);
+  compressed_trie_t &operator=(const compressed_trie_t &other);
+
+  void insert(const std::string &str);
+  bool erase(const std::string &str);
+  void clear();
+
+  bool find(const std::string &str) const;
+  size_t count_with_prefix(const std::string &prefix) const;
+  std::string operator[](size_t index) const;
+
+  std::vector<std::string> to_vector() const;
+
+  size_t size() const;
+  bool empty() const;
+
+  void swap(compressed_trie_t &other);
+
+  /**
+   * @return Number of bytes used by container, including heap memory
+   */
+  size_t memory_usage() const;
+
+private:
+  static constexpr uint32_t NO_NODE = UINT32_MAX;
+
+  /**
+   * Trie node, its edge label is pool[label_offset, label_offset + label_length).
+   * Children of a node form a singly linked list sorted by the first symbol
+   * of their labels
+   */
+  struct node_t {
+    uint32_t label_offset{0};
+    uint32_t label_length{0};
+    uint32_t first_child{NO_NODE};
+    uint32_t next_sibling{NO_NODE};
+    // number of strings in subtree of this node
+    uint32_t subtree_count{0};
+    // number of strings which end in this node
+    uint32_t end_count{0};
+  };
+
+  unsigned char first_symbol(uint32_t node) const;
+  uint32_t find_child(uint32_t node, unsigned char symbol, uint32_t *prev) const;
+  size_t common_length(uint32_t node, const std::string &str, size_t pos) const;
+  uint32_t locate(const std::string &str, bool exact) const;
+
+  uint32_t new_node(uint32_t label_offset, uint32_t label_length);
+  void free_node(uint32_t node);
+  void merge_with_child(uint32_t node);
+  void compact_pool();
+
+  void collect(uint32_t node, std::string &buffer, std::vector<std::string> &result) const;
+
+  // nodes[0] is the root with an empty label, free nodes are linked through next_sibling
+  std::vector<node_t> nodes;
+  uint32_t free_list{NO_NODE};
+  std::string pool;
+  // bytes of pool which no label refers to anymore
+  size_t pool_garbage{0};
+};
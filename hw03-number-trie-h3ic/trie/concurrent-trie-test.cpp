@@ -0,0 +1,95 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <thread>
+
+#include "concurrent-trie.h"
+#include "trie-test-utils.h"
+#include "trie.h"
+
+TEST(ConcurrentTrie, EmptyTrie) {
+  concurrent_trie_t actual;
+  trie_t expected;
+  FULL_COMPARE(actual, expected);
+  ASSERT_FALSE(actual.find(""));
+  ASSERT_FALSE(actual.erase(""));
+}
+
+TEST(ConcurrentTrie, RandomEraseAndInsert) {
+  concurrent_trie_t actual;
+  trie_t expected;
+  std::vector<std::string> strs = {"", "a", "aba", "abacaba", "caba", "baba", "zaba", "zzzz", "daba"};
+
+  for (size_t i = 0; i < 1000; ++i) {
+    std::string key = strs[rnd(0UL, strs.size() - 1)];
+    if (rnd(0, 1) == 0) {
+      INSERT(actual, expected, key);
+    } else {
+      ERASE(actual, expected, key);
+    }
+    FULL_COMPARE(actual, expected);
+  }
+
+  actual.clear();
+  expected.clear();
+  FULL_COMPARE(actual, expected);
+}
+
+TEST(ConcurrentTrie, ApplyBatch) {
+  concurrent_trie_t actual;
+  trie_t expected;
+  INSERT(actual, expected, "ab");
+  INSERT(actual, expected, "b");
+
+  ASSERT_EQ(actual.apply({"abc", "abd", "b"}, {"ab", "b", "x", "abd"}), 3);
+  expected.insert("abc");
+  expected.erase("ab");
+  FULL_COMPARE(actual, expected);
+}
+
+TEST(ConcurrentTrie, ReadersAndWriter) {
+  concurrent_trie_t trie;
+  // these strings are always in container, others are inserted and erased while readers run
+  std::vector<std::string> stable = {"a", "abc", "b", "bcd", "zz"};
+  trie.apply(stable, {});
+
+  std::vector<std::string> volatile_strs;
+  for (size_t i = 0; i < 64; ++i) {
+    volatile_strs.push_back("ab" + std::to_string(i));
+  }
+
+  std::atomic<bool> stop{false};
+  std::atomic<size_t> failures{0};
+  std::vector<std::thread> readers;
+  for (size_t reader = 0; reader < 4; ++reader) {
+    readers.emplace_back([&]() {
+      while (!stop.load()) {
+        for (const auto &str : stable) {
+          failures += !trie.find(str);
+        }
+        // "a" and "abc" are under "a" together with at most all volatile strings
+        size_t count = trie.count_with_prefix("a");
+        failures += count < 2 || count > 2 + volatile_strs.size();
+        failures += trie.size() < stable.size();
+      }
+    });
+  }
+
+  for (size_t i = 0; i < 2000; ++i) {
+    const std::string &str = volatile_strs[i % volatile_strs.size()];
+    if (trie.find(str)) {
+      trie.erase(str);
+    } else {
+      trie.insert(str);
+    }
+  }
+  stop = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  ASSERT_EQ(failures.load(), 0);
+  for (const auto &str : stable) {
+    ASSERT_TRUE(trie.find(str));
+  }
+}
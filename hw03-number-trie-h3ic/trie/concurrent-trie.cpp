@@ -0,0 +1,254 @@
+#include "concurrent-trie.h"
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <limits>
+#include <thread>
+
+concurrent_trie_t::concurrent_trie_t() : root(new node_t()) {}
+
+concurrent_trie_t::~concurrent_trie_t() {
+  delete_subtree(root.load());
+  for (auto &[retired_epoch, nodes] : retired) {
+    for (const node_t *node : nodes) {
+      delete node;
+    }
+  }
+}
+
+concurrent_trie_t::read_guard_t::read_guard_t(const concurrent_trie_t &trie)
+    : slot(claim_slot(trie)), root_node(trie.root.load()) {
+  // the root is read after the slot is taken, so the writer either sees the
+  // slot or the reader sees the new root
+}
+
+std::atomic<uint64_t> *concurrent_trie_t::read_guard_t::claim_slot(const concurrent_trie_t &trie) {
+  // every thread starts probing from its own slot, so readers rarely compete
+  static thread_local size_t hint = std::hash<std::thread::id>()(std::this_thread::get_id());
+  uint64_t epoch = trie.epoch.load();
+  for (size_t i = hint;; ++i) {
+    std::atomic<uint64_t> &slot = trie.readers[i % READER_SLOTS].epoch;
+    uint64_t expected = 0;
+    if (slot.load(std::memory_order_relaxed) == 0 && slot.compare_exchange_strong(expected, epoch)) {
+      hint = i;
+      return &slot;
+    }
+    // all slots are taken, the cpu is given to the readers holding them until one leaves
+    if ((i + 1 - hint) % READER_SLOTS == 0) {
+      std::this_thread::yield();
+      epoch = trie.epoch.load();
+    }
+  }
+}
+
+concurrent_trie_t::read_guard_t::~read_guard_t() {
+  slot->store(0, std::memory_order_release);
+}
+
+const concurrent_trie_t::node_t *concurrent_trie_t::find_child(const node_t *node, unsigned char symbol) {
+  auto it = std::lower_bound(node->children.begin(), node->children.end(), symbol,
+                             [](const auto &child, unsigned char value) { return child.first < value; });
+  return it != node->children.end() && it->first == symbol ? it->second : nullptr;
+}
+
+const concurrent_trie_t::node_t *concurrent_trie_t::find_node(const node_t *root, const std::string &str) {
+  const node_t *node = root;
+  for (char c : str) {
+    node = find_child(node, static_cast<unsigned char>(c));
+    if (node == nullptr) {
+      return nullptr;
+    }
+  }
+  return node;
+}
+
+const concurrent_trie_t::node_t *concurrent_trie_t::insert_copy(const node_t *root, const std::string &str,
+                                                                std::vector<const node_t *> &retired) {
+  // copies of the nodes on the path, every copy is linked to the next one below
+  node_t *new_root = new node_t(*root);
+  retired.push_back(root);
+  node_t *copy = new_root;
+  for (char c : str) {
+    ++copy->subtree_count;
+    auto symbol = static_cast<unsigned char>(c);
+    auto it = std::lower_bound(copy->children.begin(), copy->children.end(), symbol,
+                               [](const auto &child, unsigned char value) { return child.first < value; });
+    node_t *child = nullptr;
+    if (it != copy->children.end() && it->first == symbol) {
+      child = new node_t(*it->second);
+      retired.push_back(it->second);
+      it->second = child;
+    } else {
+      child = new node_t();
+      copy->children.insert(it, {symbol, child});
+    }
+    copy = child;
+  }
+  ++copy->subtree_count;
+  ++copy->end_count;
+  return new_root;
+}
+
+const concurrent_trie_t::node_t *concurrent_trie_t::erase_copy(const node_t *root, const std::string &str,
+                                                               std::vector<const node_t *> &retired) {
+  const node_t *end = find_node(root, str);
+  if (end == nullptr || end->end_count == 0) {
+    return root;
+  }
+  node_t *new_root = new node_t(*root);
+  retired.push_back(root);
+  node_t *copy = new_root;
+  --copy->subtree_count;
+  for (char c : str) {
+    auto symbol = static_cast<unsigned char>(c);
+    auto it = std::lower_bound(copy->children.begin(), copy->children.end(), symbol,
+                               [](const auto &child, unsigned char value) { return child.first < value; });
+    if (it->second->subtree_count == 1) {
+      // nothing but this string is left below, drop the whole branch
+      retire_subtree(it->second, retired);
+      copy->children.erase(it);
+      return new_root;
+    }
+    node_t *child = new node_t(*it->second);
+    retired.push_back(it->second);
+    it->second = child;
+    copy = child;
+    --copy->subtree_count;
+  }
+  --copy->end_count;
+  return new_root;
+}
+
+void concurrent_trie_t::retire_subtree(const node_t *node, std::vector<const node_t *> &retired) {
+  retired.push_back(node);
+  for (const auto &[symbol, child] : node->children) {
+    retire_subtree(child, retired);
+  }
+}
+
+void concurrent_trie_t::delete_subtree(const node_t *node) {
+  for (const auto &[symbol, child] : node->children) {
+    delete_subtree(child);
+  }
+  delete node;
+}
+
+void concurrent_trie_t::publish(const node_t *new_root, std::vector<const node_t *> replaced) {
+  root.store(new_root);
+  // readers which announced this epoch or an older one may still see replaced nodes
+  retired.emplace_back(epoch.fetch_add(1), std::move(replaced));
+  reclaim();
+}
+
+void concurrent_trie_t::reclaim() {
+  uint64_t oldest_reader = std::numeric_limits<uint64_t>::max();
+  for (const reader_slot_t &reader : readers) {
+    uint64_t reader_epoch = reader.epoch.load();
+    if (reader_epoch != 0) {
+      oldest_reader = std::min(oldest_reader, reader_epoch);
+    }
+  }
+  size_t reclaimed = 0;
+  while (reclaimed < retired.size() && retired[reclaimed].first < oldest_reader) {
+    for (const node_t *node : retired[reclaimed].second) {
+      delete node;
+    }
+    ++reclaimed;
+  }
+  retired.erase(retired.begin(), retired.begin() + reclaimed);
+}
+
+void concurrent_trie_t::insert(const std::string &str) {
+  apply({str}, {});
+}
+
+bool concurrent_trie_t::erase(const std::string &str) {
+  return apply({}, {str}) == 1;
+}
+
+size_t concurrent_trie_t::apply(const std::vector<std::string> &to_insert, const std::vector<std::string> &to_erase) {
+  std::lock_guard<std::mutex> lock(writer_mutex);
+  const node_t *old_root = root.load();
+  const node_t *new_root = old_root;
+  std::vector<const node_t *> replaced;
+  for (const auto &str : to_insert) {
+    new_root = insert_copy(new_root, str, replaced);
+  }
+  size_t erased = 0;
+  for (const auto &str : to_erase) {
+    const node_t *next_root = erase_copy(new_root, str, replaced);
+    erased += next_root != new_root;
+    new_root = next_root;
+  }
+  if (new_root != old_root) {
+    publish(new_root, std::move(replaced));
+  }
+  return erased;
+}
+
+void concurrent_trie_t::clear() {
+  std::lock_guard<std::mutex> lock(writer_mutex);
+  std::vector<const node_t *> replaced;
+  retire_subtree(root.load(), replaced);
+  publish(new node_t(), std::move(replaced));
+}
+
+bool concurrent_trie_t::find(const std::string &str) const {
+  read_guard_t guard(*this);
+  const node_t *node = find_node(guard.root(), str);
+  return node != nullptr && node->end_count > 0;
+}
+
+size_t concurrent_trie_t::count_with_prefix(const std::string &prefix) const {
+  read_guard_t guard(*this);
+  const node_t *node = find_node(guard.root(), prefix);
+  return node == nullptr ? 0 : node->subtree_count;
+}
+
+std::string concurrent_trie_t::operator[](size_t index) const {
+  read_guard_t guard(*this);
+  assert(index < guard.root()->subtree_count);
+  std::string result;
+  const node_t *node = guard.root();
+  // skip subtrees which hold fewer strings than index
+  while (index >= node->end_count) {
+    index -= node->end_count;
+    for (const auto &[symbol, child] : node->children) {
+      if (index < child->subtree_count) {
+        result += static_cast<char>(symbol);
+        node = child;
+        break;
+      }
+      index -= child->subtree_count;
+    }
+  }
+  return result;
+}
+
+void concurrent_trie_t::collect(const node_t *node, std::string &buffer, std::vector<std::string> &result) {
+  result.insert(result.end(), node->end_count, buffer);
+  for (const auto &[symbol, child] : node->children) {
+    buffer += static_cast<char>(symbol);
+    collect(child, buffer, result);
+    buffer.pop_back();
+  }
+}
+
+std::vector<std::string> concurrent_trie_t::to_vector() const {
+  read_guard_t guard(*this);
+  std::vector<std::string> result;
+  result.reserve(guard.root()->subtree_count);
+  std::string buffer;
+  collect(guard.root(), buffer, result);
+  return result;
+}
+
+size_t concurrent_trie_t::size() const {
+  read_guard_t guard(*this);
+  return guard.root()->subtree_count;
+}
+
+bool concurrent_trie_t::empty() const {
+  return size() == 0;
+}
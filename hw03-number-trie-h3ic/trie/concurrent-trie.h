@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Trie for one writer and many readers. Readers never take locks: nodes are
+ * immutable once published, a writer copies the path it changes and swaps
+ * the root atomically. Replaced nodes are freed once no reader which could see
+ * them is left (epoch-based reclamation).
+ * Writers are serialized by a mutex, the container must not be destroyed
+ * while it is used.
+ * At most READER_SLOTS (128) reads run at once, further readers wait until
+ * one of them finishes
+ */
+class concurrent_trie_t {
+public:
+  concurrent_trie_t();
+  ~concurrent_trie_t();
+
+  concurrent_trie_t(const concurrent_trie_t &other) = delete;
+  concurrent_trie_t &operator=(const concurrent_trie_t &other) = delete;
+
+  void insert(const std::string &str);
+  bool erase(const std::string &str);
+  void clear();
+
+  /**
+   * Apply all insertions and then all erasures of a batch as one new version,
+   * so readers see either none or all of them
+   * @param to_insert
+   * @param to_erase
+   * @return number of erased strings
+   */
+  size_t apply(const std::vector<std::string> &to_insert, const std::vector<std::string> &to_erase);
+
+  bool find(const std::string &str) const;
+  size_t count_with_prefix(const std::string &prefix) const;
+  std::string operator[](size_t index) const;
+
+  /**
+   * @return All strings of one version of container in lexicographic order
+   */
+  std::vector<std::string> to_vector() const;
+
+  size_t size() const;
+  bool empty() const;
+
+private:
+  struct node_t {
+    uint32_t subtree_count{0};
+    uint32_t end_count{0};
+    // sorted by symbol
+    std::vector<std::pair<unsigned char, const node_t *>> children;
+  };
+
+  /**
+   * Marks calling thread as a reader of the current version while alive
+   */
+  class read_guard_t {
+  public:
+    explicit read_guard_t(const concurrent_trie_t &trie);
+    ~read_guard_t();
+
+    read_guard_t(const read_guard_t &other) = delete;
+    read_guard_t &operator=(const read_guard_t &other) = delete;
+
+    // root of the version seen by the reader
+    const node_t *root() const {
+      return root_node;
+    }
+
+  private:
+    static std::atomic<uint64_t> *claim_slot(const concurrent_trie_t &trie);
+
+    std::atomic<uint64_t> *slot;
+    const node_t *root_node;
+  };
+
+  // padded so readers on different cores don't share cache lines
+  struct alignas(64) reader_slot_t {
+    // epoch seen by the reader in this slot, 0 if the slot is free
+    std::atomic<uint64_t> epoch{0};
+  };
+
+  // bound of simultaneous readers, a reader which finds all slots taken yields and retries
+  static constexpr size_t READER_SLOTS = 128;
+
+  static const node_t *find_child(const node_t *node, unsigned char symbol);
+  static const node_t *find_node(const node_t *root, const std::string &str);
+  static void collect(const node_t *node, std::string &buffer, std::vector<std::string> &result);
+  static void retire_subtree(const node_t *node, std::vector<const node_t *> &retired);
+  static void delete_subtree(const node_t *node);
+
+  // return the new root, replaced nodes are appended to retired
+  const node_t *insert_copy(const node_t *root, const std::string &str, std::vector<const node_t *> &retired);
+  const node_t *erase_copy(const node_t *root, const std::string &str, std::vector<const node_t *> &retired);
+
+  // publishes new root and frees nodes which can't be seen by readers any more
+  void publish(const node_t *root, std::vector<const node_t *> retired);
+  void reclaim();
+
+  std::atomic<const node_t *> root;
+  std::atomic<uint64_t> epoch{1};
+  mutable reader_slot_t readers[READER_SLOTS];
+
+  std::mutex writer_mutex;
+  // nodes replaced in the epoch, in increasing order of epochs
+  std::vector<std::pair<uint64_t, std::vector<const node_t *>>> retired;
+};
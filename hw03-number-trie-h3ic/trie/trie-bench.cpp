@@ -0,0 +1,198 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "compressed-trie.h"
+#include "trie-naive.h"
+#include "trie.h"
+
+enum keys_kind_t { RANDOM, SHARED_PREFIX, URL, NUMERIC };
+
+static std::string random_word(std::mt19937_64 &gen, size_t min_len, size_t max_len) {
+  std::string word(std::uniform_int_distribution<size_t>(min_len, max_len)(gen), 'a');
+  for (char &c : word) {
+    c = static_cast<char>('a' + gen() % 26);
+  }
+  return word;
+}
+
+static std::string make_key(keys_kind_t kind, std::mt19937_64 &gen) {
+  switch (kind) {
+  case RANDOM:
+    return random_word(gen, 4, 16);
+  case SHARED_PREFIX:
+    // a few long prefixes with short distinct tails
+    return "common-prefix-of-the-group-" + std::to_string(gen() % 16) + "/" + random_word(gen, 2, 6);
+  case URL: {
+    static const char *const schemes[] = {"http://", "https://"};
+    static const char *const zones[] = {".com", ".org", ".net", ".io"};
+    std::string url = schemes[gen() % 2];
+    url += "www." + random_word(gen, 3, 8) + zones[gen() % 4];
+    for (size_t segments = gen() % 4; segments > 0; --segments) {
+      url += "/" + random_word(gen, 2, 8);
+    }
+    return url;
+  }
+  case NUMERIC:
+    return std::to_string(gen() % 10000000000ULL);
+  }
+  return "";
+}
+
+// keys of the last requested kind and count, reused by consecutive benchmarks, only one set is kept to bound memory
+struct keys_cache_t {
+  keys_kind_t kind;
+  size_t count;
+  std::vector<std::string> strs;
+};
+
+static const std::vector<std::string> &keys(keys_kind_t kind, size_t count) {
+  static std::unique_ptr<keys_cache_t> cache;
+  if (!cache || cache->kind != kind || cache->count != count) {
+    cache.reset();
+    auto result = std::make_unique<keys_cache_t>();
+    result->kind = kind;
+    result->count = count;
+    std::mt19937_64 gen(kind * 1000003 + count);
+    result->strs.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+      result->strs.push_back(make_key(kind, gen));
+    }
+    cache = std::move(result);
+  }
+  return cache->strs;
+}
+
+template <typename trie_t>
+static trie_t build(const std::vector<std::string> &strs) {
+  trie_t trie;
+  for (const auto &str : strs) {
+    trie.insert(str);
+  }
+  return trie;
+}
+
+template <typename trie_t>
+static void report(benchmark::State &state, const trie_t &trie, size_t operations) {
+  state.SetItemsProcessed(state.iterations() * operations);
+  // memory of this benchmark's trie, the process peak RSS would only show the largest benchmark so far
+  state.counters["bytes_per_key"] = static_cast<double>(trie.memory_usage()) / std::max<size_t>(1, trie.size());
+  state.counters["memory_mb"] = trie.memory_usage() / (1024.0 * 1024.0);
+}
+
+template <typename trie_t>
+static void BM_insert(benchmark::State &state) {
+  const auto &strs = keys(static_cast<keys_kind_t>(state.range(1)), state.range(0));
+  trie_t trie;
+  for (auto _ : state) {
+    state.PauseTiming();
+    trie.clear();
+    state.ResumeTiming();
+    for (const auto &str : strs) {
+      trie.insert(str);
+    }
+  }
+  report(state, trie, strs.size());
+}
+
+template <typename trie_t>
+static void BM_erase(benchmark::State &state) {
+  const auto &strs = keys(static_cast<keys_kind_t>(state.range(1)), state.range(0));
+  const trie_t full = build<trie_t>(strs);
+  for (auto _ : state) {
+    state.PauseTiming();
+    trie_t trie = full;
+    state.ResumeTiming();
+    for (const auto &str : strs) {
+      benchmark::DoNotOptimize(trie.erase(str));
+    }
+  }
+  report(state, full, strs.size());
+}
+
+template <typename trie_t>
+static void BM_find(benchmark::State &state) {
+  const auto &strs = keys(static_cast<keys_kind_t>(state.range(1)), state.range(0));
+  const trie_t trie = build<trie_t>(strs);
+  for (auto _ : state) {
+    for (const auto &str : strs) {
+      benchmark::DoNotOptimize(trie.find(str));
+    }
+  }
+  report(state, trie, strs.size());
+}
+
+template <typename trie_t>
+static void BM_count_with_prefix(benchmark::State &state) {
+  const auto &strs = keys(static_cast<keys_kind_t>(state.range(1)), state.range(0));
+  const trie_t trie = build<trie_t>(strs);
+  std::vector<std::string> prefixes;
+  prefixes.reserve(strs.size());
+  for (const auto &str : strs) {
+    prefixes.push_back(str.substr(0, str.size() / 2));
+  }
+  for (auto _ : state) {
+    for (const auto &prefix : prefixes) {
+      benchmark::DoNotOptimize(trie.count_with_prefix(prefix));
+    }
+  }
+  report(state, trie, prefixes.size());
+}
+
+template <typename trie_t>
+static void BM_index(benchmark::State &state) {
+  const auto &strs = keys(static_cast<keys_kind_t>(state.range(1)), state.range(0));
+  const trie_t trie = build<trie_t>(strs);
+  std::mt19937_64 gen(state.range(0));
+  std::vector<size_t> indices(std::min<size_t>(strs.size(), 100000));
+  for (size_t &index : indices) {
+    index = gen() % strs.size();
+  }
+  for (auto _ : state) {
+    for (size_t index : indices) {
+      benchmark::DoNotOptimize(trie[index]);
+    }
+  }
+  report(state, trie, indices.size());
+}
+
+template <typename trie_t>
+static void BM_to_vector(benchmark::State &state) {
+  const auto &strs = keys(static_cast<keys_kind_t>(state.range(1)), state.range(0));
+  const trie_t trie = build<trie_t>(strs);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(trie.to_vector());
+  }
+  report(state, trie, strs.size());
+}
+
+// sizes 1e3 .. max_count for every kind of keys
+template <int64_t max_count>
+static void arguments(benchmark::internal::Benchmark *benchmark) {
+  benchmark->ArgNames({"keys", "kind"});
+  for (int kind : {RANDOM, SHARED_PREFIX, URL, NUMERIC}) {
+    for (int64_t count = 1000; count <= max_count; count *= 10) {
+      benchmark->Args({count, kind});
+    }
+  }
+  benchmark->Unit(benchmark::kMillisecond);
+}
+
+#define TRIE_BENCHMARKS(trie_type, max_count)                                                                          \
+  BENCHMARK_TEMPLATE(BM_insert, trie_type)->Apply(arguments<max_count>);                                               \
+  BENCHMARK_TEMPLATE(BM_erase, trie_type)->Apply(arguments<max_count>);                                                \
+  BENCHMARK_TEMPLATE(BM_find, trie_type)->Apply(arguments<max_count>);                                                 \
+  BENCHMARK_TEMPLATE(BM_count_with_prefix, trie_type)->Apply(arguments<max_count>);                                    \
+  BENCHMARK_TEMPLATE(BM_index, trie_type)->Apply(arguments<max_count>);                                                \
+  BENCHMARK_TEMPLATE(BM_to_vector, trie_type)->Apply(arguments<max_count>)
+
+TRIE_BENCHMARKS(trie_t, 10'000'000);
+TRIE_BENCHMARKS(compressed_trie_t, 10'000'000);
+// inserts and erases of the sorted vector are linear, so its runs are quadratic: 0.1 s at 1e4, 13 s at 1e5 keys
+TRIE_BENCHMARKS(trie_naive_t, 10'000);
+
+BENCHMARK_MAIN();
@@ -57,3 +57,14 @@ bool trie_naive_t::empty() const {
 void trie_naive_t::swap(trie_naive_t &other) {
   std::swap(line, other.line);
 }
+
+size_t trie_naive_t::memory_usage() const {
+  size_t result = sizeof(*this) + line.capacity() * sizeof(std::string);
+  for (const auto &str : line) {
+    // short strings are stored inside std::string itself
+    if (str.capacity() > std::string().capacity()) {
+      result += str.capacity() + 1;
+    }
+  }
+  return result;
+}
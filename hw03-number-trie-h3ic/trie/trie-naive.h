@@ -27,6 +27,8 @@ public:
 
   void swap(trie_naive_t &other);
 
+  size_t memory_usage() const;
+
 private:
   std::vector<std::string> line;
 };
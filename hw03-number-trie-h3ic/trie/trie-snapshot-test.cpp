@@ -0,0 +1,149 @@
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+#include "trie-snapshot.h"
+#include "trie.h"
+
+template <typename T = int>
+static T rnd(T min_val, T max_val) {
+  static std::mt19937_64 gen(231);
+  return std::uniform_int_distribution<T>(min_val, max_val)(gen);
+}
+
+#define SNAPSHOT_COMPARE(actual, expected)                                                                             \
+  do {                                                                                                                 \
+    ASSERT_EQ(actual.size(), expected.size());                                                                         \
+    ASSERT_EQ(actual.empty(), expected.empty());                                                                       \
+                                                                                                                       \
+    size_t count = expected.size();                                                                                    \
+    for (size_t i = 0; i < count; ++i) {                                                                               \
+      ASSERT_EQ(actual[i], expected[i]);                                                                               \
+      ASSERT_TRUE(actual.find(expected[i]));                                                                           \
+      ASSERT_EQ(actual.count_with_prefix(expected[i]), expected.count_with_prefix(expected[i]));                       \
+    }                                                                                                                  \
+    ASSERT_EQ(actual.count_with_prefix(""), expected.count_with_prefix(""));                                           \
+  } while (false)
+
+TEST(TrieSnapshot, EmptySnapshot) {
+  trie_snapshot_t snapshot;
+  ASSERT_TRUE(snapshot.empty());
+  ASSERT_FALSE(snapshot.find(""));
+  ASSERT_EQ(snapshot.count_with_prefix(""), 0);
+
+  trie_t trie;
+  std::vector<char> image = trie_snapshot_t::serialize(trie);
+  ASSERT_TRUE(snapshot.attach(image.data(), image.size()));
+  ASSERT_TRUE(snapshot.empty());
+  ASSERT_FALSE(snapshot.find(""));
+}
+
+TEST(TrieSnapshot, Attach) {
+  trie_t trie;
+  trie_t expected;
+  for (const std::string str : {"", "a", "aba", "aba", "abacaba", "b", "baba", "zzzz", "\xff"}) {
+    trie.insert(str);
+    expected.insert(str);
+  }
+  std::vector<char> image = trie_snapshot_t::serialize(trie);
+
+  trie_snapshot_t actual;
+  ASSERT_TRUE(actual.attach(image.data(), image.size()));
+  SNAPSHOT_COMPARE(actual, expected);
+  ASSERT_FALSE(actual.find("ab"));
+  ASSERT_FALSE(actual.find("zzzzz"));
+  ASSERT_EQ(actual.count_with_prefix("ab"), 3);
+  ASSERT_EQ(actual.count_with_prefix("c"), 0);
+}
+
+TEST(TrieSnapshot, RandomStrings) {
+  trie_t trie;
+  trie_t expected;
+  for (size_t i = 0; i < 3000; ++i) {
+    std::string str;
+    std::generate_n(std::back_inserter(str), rnd(0, 6), []() { return static_cast<char>(rnd(0, 255)); });
+    trie.insert(str);
+    expected.insert(str);
+  }
+  std::vector<char> image = trie_snapshot_t::serialize(trie);
+
+  trie_snapshot_t actual;
+  ASSERT_TRUE(actual.attach(image.data(), image.size()));
+  SNAPSHOT_COMPARE(actual, expected);
+}
+
+TEST(TrieSnapshot, SaveAndOpen) {
+  trie_t trie;
+  trie_t expected;
+  for (const std::string str : {"abc", "abd", "b", "", "abc"}) {
+    trie.insert(str);
+    expected.insert(str);
+  }
+  std::string path = testing::TempDir() + "trie-snapshot-test.bin";
+  ASSERT_TRUE(trie_snapshot_t::save(trie, path));
+
+  trie_snapshot_t opened;
+  ASSERT_TRUE(opened.open(path));
+  // the image stays mapped after the source trie is changed or the snapshot is moved
+  trie.clear();
+  trie_snapshot_t actual(std::move(opened));
+  ASSERT_TRUE(opened.empty());
+  SNAPSHOT_COMPARE(actual, expected);
+
+  actual.close();
+  ASSERT_TRUE(actual.empty());
+  std::remove(path.c_str());
+  ASSERT_FALSE(actual.open(path));
+}
+
+TEST(TrieSnapshot, RejectMalformedImage) {
+  trie_t trie;
+  trie.insert("abacaba");
+  std::vector<char> image = trie_snapshot_t::serialize(trie);
+
+  trie_snapshot_t snapshot;
+  ASSERT_FALSE(snapshot.attach(image.data(), image.size() - 1));
+  ASSERT_FALSE(snapshot.attach(image.data(), 3));
+
+  std::vector<char> bad_magic = image;
+  bad_magic[0] = 'X';
+  ASSERT_FALSE(snapshot.attach(bad_magic.data(), bad_magic.size()));
+  ASSERT_TRUE(snapshot.empty());
+
+  // nodes follow the 16-byte header, every node is first_child, subtree_count, end_count, children_count
+  const auto corrupted = [&image](size_t node, size_t offset, uint32_t value, size_t value_size = sizeof(uint32_t)) {
+    std::vector<char> result = image;
+    std::memcpy(result.data() + 16 + 16 * node + offset, &value, value_size);
+    return result;
+  };
+  for (const std::vector<char> &bad_nodes :
+       {corrupted(1, 0, 1000), corrupted(1, 0, 0), corrupted(2, 12, 500, sizeof(uint16_t)), corrupted(0, 4, 7),
+        corrupted(7, 8, 0), corrupted(3, 4, UINT32_MAX)}) {
+    ASSERT_FALSE(snapshot.attach(bad_nodes.data(), bad_nodes.size()));
+  }
+  ASSERT_TRUE(snapshot.attach(image.data(), image.size()));
+}
+
+TEST(TrieSnapshot, SaveReplacesOpenedImage) {
+  trie_t trie;
+  trie_t expected;
+  for (const std::string str : {"abc", "abd", "b"}) {
+    trie.insert(str);
+    expected.insert(str);
+  }
+  std::string path = testing::TempDir() + "trie-snapshot-replace-test.bin";
+  ASSERT_TRUE(trie_snapshot_t::save(trie, path));
+  trie_snapshot_t old_snapshot;
+  ASSERT_TRUE(old_snapshot.open(path));
+
+  trie_t new_trie;
+  new_trie.insert("zzz");
+  ASSERT_TRUE(trie_snapshot_t::save(new_trie, path));
+  trie_snapshot_t new_snapshot;
+  ASSERT_TRUE(new_snapshot.open(path));
+  SNAPSHOT_COMPARE(old_snapshot, expected);
+  SNAPSHOT_COMPARE(new_snapshot, new_trie);
+  std::remove(path.c_str());
+}
@@ -0,0 +1,257 @@
+#include "trie-snapshot.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static constexpr char MAGIC[8] = {'T', 'R', 'I', 'E', 'S', 'N', 'A', 'P'};
+
+static bool write_all(int fd, const char *data, size_t size) {
+  while (size > 0) {
+    ssize_t written = ::write(fd, data, size);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data += written;
+    size -= written;
+  }
+  return true;
+}
+
+// makes rename of a file in directory of path durable
+static bool sync_directory(const std::string &path) {
+  size_t slash = path.find_last_of('/');
+  std::string directory = slash == std::string::npos ? "." : path.substr(0, slash + 1);
+  int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+  if (fd < 0) {
+    return false;
+  }
+  bool result = fsync(fd) == 0;
+  ::close(fd);
+  return result;
+}
+
+trie_snapshot_t::trie_snapshot_t() = default;
+
+trie_snapshot_t::~trie_snapshot_t() {
+  close();
+}
+
+trie_snapshot_t::trie_snapshot_t(trie_snapshot_t &&other) noexcept
+    : nodes(std::exchange(other.nodes, nullptr)), nodes_count(std::exchange(other.nodes_count, 0)),
+      mapping(std::exchange(other.mapping, nullptr)), mapping_size(std::exchange(other.mapping_size, 0)) {}
+
+trie_snapshot_t &trie_snapshot_t::operator=(trie_snapshot_t &&other) noexcept {
+  if (this != &other) {
+    close();
+    nodes = std::exchange(other.nodes, nullptr);
+    nodes_count = std::exchange(other.nodes_count, 0);
+    mapping = std::exchange(other.mapping, nullptr);
+    mapping_size = std::exchange(other.mapping_size, 0);
+  }
+  return *this;
+}
+
+std::vector<char> trie_snapshot_t::serialize(const trie_t &trie) {
+  // breadth-first order: order[i] is the trie node which becomes i-th image node
+  std::vector<uint32_t> order{0};
+  std::vector<unsigned char> symbols{0};
+  std::vector<node_t> image_nodes;
+  image_nodes.reserve(trie.nodes.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    const trie_t::node_t &node = trie.nodes[order[i]];
+    node_t image_node{};
+    image_node.first_child = order.size();
+    image_node.subtree_count = node.subtree_count;
+    image_node.end_count = node.end_count;
+    image_node.children_count = node.children_count;
+    image_node.symbol = symbols[i];
+    image_nodes.push_back(image_node);
+
+    unsigned char symbol = 0;
+    for (size_t from = 0;; from = symbol + 1) {
+      uint32_t child = trie.find_child_from(order[i], from, &symbol);
+      if (child == trie_t::NO_NODE) {
+        break;
+      }
+      order.push_back(child);
+      symbols.push_back(symbol);
+    }
+  }
+
+  header_t header{};
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.nodes_count = image_nodes.size();
+
+  std::vector<char> image(sizeof(header_t) + image_nodes.size() * sizeof(node_t));
+  std::memcpy(image.data(), &header, sizeof(header));
+  std::memcpy(image.data() + sizeof(header), image_nodes.data(), image_nodes.size() * sizeof(node_t));
+  return image;
+}
+
+bool trie_snapshot_t::save(const trie_t &trie, const std::string &path) {
+  std::vector<char> image = serialize(trie);
+  // the old image may be mapped by readers, so it is replaced by rename instead of being rewritten
+  std::string tmp_path = path + ".tmp";
+  int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    return false;
+  }
+  bool written = write_all(fd, image.data(), image.size()) && fsync(fd) == 0;
+  ::close(fd);
+  if (!written || rename(tmp_path.c_str(), path.c_str()) != 0) {
+    std::remove(tmp_path.c_str());
+    return false;
+  }
+  return sync_directory(path);
+}
+
+bool trie_snapshot_t::open(const std::string &path) {
+  close();
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat file_stat {};
+  if (fstat(fd, &file_stat) != 0 || file_stat.st_size < static_cast<off_t>(sizeof(header_t))) {
+    ::close(fd);
+    return false;
+  }
+  size_t size = file_stat.st_size;
+  // pages are shared by all processes which map the same file
+  void *data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    return false;
+  }
+  if (!attach(data, size)) {
+    munmap(data, size);
+    return false;
+  }
+  mapping = data;
+  mapping_size = size;
+  return true;
+}
+
+bool trie_snapshot_t::attach(const void *data, size_t size) {
+  close();
+  if (size < sizeof(header_t) || reinterpret_cast<uintptr_t>(data) % alignof(node_t) != 0) {
+    return false;
+  }
+  header_t header;
+  std::memcpy(&header, data, sizeof(header));
+  if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION || header.nodes_count == 0 ||
+      size != sizeof(header_t) + static_cast<size_t>(header.nodes_count) * sizeof(node_t)) {
+    return false;
+  }
+  const auto *image_nodes = reinterpret_cast<const node_t *>(static_cast<const char *>(data) + sizeof(header_t));
+  if (!valid_nodes(image_nodes, header.nodes_count)) {
+    return false;
+  }
+  nodes = image_nodes;
+  nodes_count = header.nodes_count;
+  return true;
+}
+
+bool trie_snapshot_t::valid_nodes(const node_t *image_nodes, uint32_t count) {
+  // every node is checked, queries then stay inside the image: children follow their parent and are sorted,
+  // and counts add up, so that operator[] finds the child with the index
+  for (uint32_t i = 0; i < count; ++i) {
+    const node_t &node = image_nodes[i];
+    if (node.first_child > count || node.children_count > count - node.first_child ||
+        (node.children_count != 0 && node.first_child <= i)) {
+      return false;
+    }
+    uint64_t subtree_count = node.end_count;
+    for (uint32_t child = node.first_child; child < node.first_child + node.children_count; ++child) {
+      if (child > node.first_child && image_nodes[child - 1].symbol >= image_nodes[child].symbol) {
+        return false;
+      }
+      subtree_count += image_nodes[child].subtree_count;
+    }
+    if (subtree_count != node.subtree_count) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void trie_snapshot_t::close() {
+  if (mapping != nullptr) {
+    munmap(mapping, mapping_size);
+  }
+  nodes = nullptr;
+  nodes_count = 0;
+  mapping = nullptr;
+  mapping_size = 0;
+}
+
+uint32_t trie_snapshot_t::find_child(uint32_t node, unsigned char symbol) const {
+  const node_t *begin = nodes + nodes[node].first_child;
+  const node_t *end = begin + nodes[node].children_count;
+  const node_t *child =
+      std::lower_bound(begin, end, symbol, [](const node_t &n, unsigned char value) { return n.symbol < value; });
+  return child != end && child->symbol == symbol ? child - nodes : NO_NODE;
+}
+
+uint32_t trie_snapshot_t::find_node(const std::string &str) const {
+  if (nodes_count == 0) {
+    return NO_NODE;
+  }
+  uint32_t node = 0;
+  for (char c : str) {
+    node = find_child(node, static_cast<unsigned char>(c));
+    if (node == NO_NODE) {
+      return NO_NODE;
+    }
+  }
+  return node;
+}
+
+bool trie_snapshot_t::find(const std::string &str) const {
+  uint32_t node = find_node(str);
+  return node != NO_NODE && nodes[node].end_count > 0;
+}
+
+size_t trie_snapshot_t::count_with_prefix(const std::string &prefix) const {
+  uint32_t node = find_node(prefix);
+  return node == NO_NODE ? 0 : nodes[node].subtree_count;
+}
+
+std::string trie_snapshot_t::operator[](size_t index) const {
+  assert(index < size());
+  std::string result;
+  uint32_t node = 0;
+  // skip subtrees which hold fewer strings than index
+  while (index >= nodes[node].end_count) {
+    index -= nodes[node].end_count;
+    uint32_t child = nodes[node].first_child;
+    while (index >= nodes[child].subtree_count) {
+      index -= nodes[child].subtree_count;
+      ++child;
+    }
+    result += static_cast<char>(nodes[child].symbol);
+    node = child;
+  }
+  return result;
+}
+
+size_t trie_snapshot_t::size() const {
+  return nodes_count == 0 ? 0 : nodes[0].subtree_count;
+}
+
+bool trie_snapshot_t::empty() const {
+  return size() == 0;
+}
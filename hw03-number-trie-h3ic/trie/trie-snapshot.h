@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "trie.h"
+
+/**
+ * Read-only trie over a flat image which can be mapped from a file and queried
+ * without deserialization. Nodes are stored in breadth-first order, so children
+ * of every node are contiguous and sorted by symbol, and nodes refer to each
+ * other by indices, which makes the image position independent.
+ * The image is in host byte order
+ */
+class trie_snapshot_t {
+public:
+  trie_snapshot_t();
+  ~trie_snapshot_t();
+
+  trie_snapshot_t(const trie_snapshot_t &other) = delete;
+  trie_snapshot_t &operator=(const trie_snapshot_t &other) = delete;
+
+  trie_snapshot_t(trie_snapshot_t &&other) noexcept;
+  trie_snapshot_t &operator=(trie_snapshot_t &&other) noexcept;
+
+  /**
+   * @param trie
+   * @return Image of specified trie
+   */
+  static std::vector<char> serialize(const trie_t &trie);
+  /**
+   * Write image of specified trie to file, which is replaced atomically, so that snapshots which have
+   * the old file open keep their image
+   * @param trie
+   * @param path
+   * @return true on success
+   */
+  static bool save(const trie_t &trie, const std::string &path);
+
+  /**
+   * Map image from file, previous image is released. All nodes are checked, so opening reads the whole image
+   * @param path
+   * @return false if file can't be mapped or is not an image
+   */
+  bool open(const std::string &path);
+  /**
+   * Use image from memory without copying, it must outlive this snapshot
+   * and be aligned at least to 4 bytes
+   * @param data
+   * @param size
+   * @return false if data is not an image
+   */
+  bool attach(const void *data, size_t size);
+  /**
+   * Release image, snapshot becomes empty
+   */
+  void close();
+
+  bool find(const std::string &str) const;
+  size_t count_with_prefix(const std::string &prefix) const;
+  std::string operator[](size_t index) const;
+
+  size_t size() const;
+  bool empty() const;
+
+private:
+  static constexpr uint32_t VERSION = 1;
+  static constexpr uint32_t NO_NODE = UINT32_MAX;
+
+  struct header_t {
+    char magic[8];
+    uint32_t version;
+    uint32_t nodes_count;
+  };
+
+  struct node_t {
+    // children are [first_child, first_child + children_count)
+    uint32_t first_child;
+    uint32_t subtree_count;
+    uint32_t end_count;
+    uint16_t children_count;
+    // symbol on the edge from parent
+    uint8_t symbol;
+    uint8_t padding;
+  };
+
+  // links stay inside the image and counts are consistent
+  static bool valid_nodes(const node_t *image_nodes, uint32_t count);
+
+  uint32_t find_child(uint32_t node, unsigned char symbol) const;
+  uint32_t find_node(const std::string &str) const;
+
+  // nodes[0] is the root, empty snapshot has no nodes
+  const node_t *nodes{nullptr};
+  uint32_t nodes_count{0};
+  // mapped file, if image was opened from file
+  void *mapping{nullptr};
+  size_t mapping_size{0};
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "gtest/gtest.h"
+
+#include <random>
+
+// helpers of trie tests, which compare a trie with a reference implementation
+
+template <typename T = int>
+static T rnd(T min_val, T max_val) {
+  static std::mt19937_64 gen(321);
+  return std::uniform_int_distribution<T>(min_val, max_val)(gen);
+}
+
+#define FULL_COMPARE(actual, expected)                                                                                 \
+  do {                                                                                                                 \
+    ASSERT_EQ(actual.size(), expected.size());                                                                         \
+    ASSERT_EQ(actual.empty(), expected.empty());                                                                       \
+                                                                                                                       \
+    size_t count = expected.size();                                                                                    \
+    for (size_t i = 0; i < count; ++i) {                                                                               \
+      ASSERT_EQ(actual[i], expected[i]);                                                                               \
+      ASSERT_TRUE(actual.find(expected[i]));                                                                           \
+      ASSERT_TRUE(expected.find(expected[i]));                                                                         \
+      ASSERT_EQ(actual.count_with_prefix(expected[i]), expected.count_with_prefix(expected[i]));                       \
+    }                                                                                                                  \
+    ASSERT_EQ(actual.to_vector(), expected.to_vector());                                                               \
+    ASSERT_EQ(actual.count_with_prefix(""), expected.count_with_prefix(""));                                           \
+  } while (false)
+
+#define ERASE(actual, expected, str) ASSERT_EQ(actual.erase(str), expected.erase(str))
+
+#define INSERT(actual, expected, str)                                                                                  \
+  actual.insert(str);                                                                                                  \
+  expected.insert(str)
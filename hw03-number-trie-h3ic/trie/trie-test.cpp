@@ -1,38 +1,9 @@
 #include "gtest/gtest.h"
 
-#include <random>
-
 #include "trie-naive.h"
+#include "trie-test-utils.h"
 #include "trie.h"
 
-template <typename T = int>
-static T rnd(T min_val, T max_val) {
-  static std::mt19937_64 gen(321);
-  return std::uniform_int_distribution<T>(min_val, max_val)(gen);
-}
-
-#define FULL_COMPARE(actual, expected)                                         \
-  do {                                                                         \
-    ASSERT_EQ(actual.size(), expected.size());                                 \
-    ASSERT_EQ(actual.empty(), expected.empty());                               \
-                                                                               \
-    size_t count = expected.size();                                            \
-    for (size_t i = 0; i < count; ++i) {                                       \
-      ASSERT_EQ(actual[i], expected[i]);                                       \
-      ASSERT_TRUE(actual.find(expected[i]));                                   \
-      ASSERT_TRUE(expected.find(expected[i]));                                 \
-    }                                                                          \
-    ASSERT_EQ(actual.to_vector(), expected.to_vector());                       \
-    ASSERT_EQ(actual.count_with_prefix(""), expected.count_with_prefix(""));   \
-  } while (false)
-
-#define ERASE(actual, expected, str)                                           \
-  ASSERT_EQ(actual.erase(str), expected.erase(str))
-
-#define INSERT(actual, expected, str)                                          \
-  actual.insert(str);                                                          \
-  expected.insert(str)
-
 #define HEADER_TEST(actual, expected, ...)                                     \
   trie_t actual;                                                               \
   trie_naive_t expected;                                                       \
@@ -152,6 +123,76 @@ TEST(Trie, Swap) {
   FULL_COMPARE(actual2, expected2);
 }
 
+TEST(Trie, BuildSorted) {
+  std::vector<std::string> strs = {"", "", "a", "aba", "abacaba", "abacaba", "b", "baba", "zz", "zzzz"};
+  trie_t actual;
+  actual.insert("garbage");
+  actual.build_sorted(strs.begin(), strs.end());
+
+  trie_naive_t expected;
+  for (const auto &str : strs) {
+    expected.insert(str);
+  }
+  FULL_COMPARE(actual, expected);
+  ASSERT_EQ(actual.count_with_prefix("ab"), expected.count_with_prefix("ab"));
+
+  // built trie stays modifiable
+  INSERT(actual, expected, "abb");
+  ERASE(actual, expected, "abacaba");
+  ERASE(actual, expected, "zzzz");
+  FULL_COMPARE(actual, expected);
+}
+
+TEST(Trie, BuildSortedRandom) {
+  std::vector<std::string> strs;
+  for (size_t i = 0; i < 10000; ++i) {
+    std::string str;
+    std::generate_n(std::back_inserter(str), rnd(0, 8), []() { return static_cast<char>(rnd(0, 255)); });
+    strs.push_back(str);
+  }
+  std::sort(strs.begin(), strs.end(), [](const std::string &a, const std::string &b) {
+    return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(), [](char x, char y) {
+      return static_cast<unsigned char>(x) < static_cast<unsigned char>(y);
+    });
+  });
+
+  trie_t actual;
+  actual.build_sorted(strs.begin(), strs.end());
+  trie_t inserted;
+  for (const auto &str : strs) {
+    inserted.insert(str);
+  }
+  ASSERT_EQ(actual.to_vector(), strs);
+  ASSERT_EQ(actual.to_vector(), inserted.to_vector());
+}
+
+TEST(Trie, Iterator) {
+  SIMPLE_TEST("", "a", "aba", "aba", "caba", "baba", "zaba", "zzzz");
+  std::vector<std::string> iterated;
+  for (std::string_view str : actual) {
+    iterated.emplace_back(str);
+  }
+  ASSERT_EQ(iterated, expected.to_vector());
+
+  trie_t empty;
+  ASSERT_TRUE(empty.begin() == empty.end());
+}
+
+TEST(Trie, ForEachWithPrefix) {
+  SIMPLE_TEST("", "a", "ab", "aba", "aba", "abc", "b", "bab");
+  const auto collect = [&actual](const std::string &prefix) {
+    std::vector<std::string> result;
+    actual.for_each_with_prefix(prefix, [&result](std::string_view str) { result.emplace_back(str); });
+    return result;
+  };
+
+  ASSERT_EQ(collect(""), expected.to_vector());
+  ASSERT_EQ(collect("ab"), std::vector<std::string>({"ab", "aba", "aba", "abc"}));
+  ASSERT_EQ(collect("aba"), std::vector<std::string>({"aba", "aba"}));
+  ASSERT_EQ(collect("b"), std::vector<std::string>({"b", "bab"}));
+  ASSERT_TRUE(collect("c").empty());
+}
+
 TEST(Trie, StressTest) {
   trie_t actual;
 
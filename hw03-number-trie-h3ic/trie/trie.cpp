@@ -1 +1,611 @@
 #include "trie.h"
+
+#include <algorithm>
+#include <cassert>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+trie_t::trie_t() : nodes(1) {}
+
+trie_t::~trie_t() = default;
+
+trie_t::trie_t(const trie_t &other) = default;
+
+trie_t &trie_t::operator=(const trie_t &other) {
+  trie_t tmp(other);
+  swap(tmp);
+  return *this;
+}
+
+template <typename T>
+uint32_t trie_t::pool_t<T>::allocate() {
+  if (free_items.empty()) {
+    items.emplace_back();
+    return items.size() - 1;
+  }
+  uint32_t item = free_items.back();
+  free_items.pop_back();
+  return item;
+}
+
+template <typename T>
+void trie_t::pool_t<T>::release(uint32_t item) {
+  free_items.push_back(item);
+}
+
+template <typename T>
+size_t trie_t::pool_t<T>::memory_usage() const {
+  return items.capacity() * sizeof(T) + free_items.capacity() * sizeof(uint32_t);
+}
+
+uint32_t trie_t::new_node() {
+  uint32_t node = free_list;
+  if (node == NO_NODE) {
+    node = nodes.size();
+    nodes.emplace_back();
+  } else {
+    free_list = nodes[node].children;
+    nodes[node] = node_t{};
+  }
+  return node;
+}
+
+void trie_t::free_node(uint32_t node) {
+  change_kind(node, LEAF);
+  nodes[node].children = free_list;
+  free_list = node;
+}
+
+uint32_t trie_t::find_child(uint32_t node, unsigned char symbol) const {
+  const node_t &n = nodes[node];
+  switch (n.kind) {
+  case LEAF:
+    return NO_NODE;
+  case NODE4: {
+    const node4_t &children = nodes4.items[n.children];
+    for (size_t i = 0; i < n.children_count; ++i) {
+      if (children.keys[i] == symbol) {
+        return children.children[i];
+      }
+    }
+    return NO_NODE;
+  }
+  case NODE16: {
+    const node16_t &children = nodes16.items[n.children];
+#if defined(__SSE2__)
+    // compare all 16 keys at once
+    __m128i keys = _mm_loadu_si128(reinterpret_cast<const __m128i *>(children.keys.data()));
+    __m128i equal = _mm_cmpeq_epi8(keys, _mm_set1_epi8(static_cast<char>(symbol)));
+    unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(equal)) & ((1U << n.children_count) - 1);
+    return mask == 0 ? NO_NODE : children.children[__builtin_ctz(mask)];
+#else
+    for (size_t i = 0; i < n.children_count; ++i) {
+      if (children.keys[i] == symbol) {
+        return children.children[i];
+      }
+    }
+    return NO_NODE;
+#endif
+  }
+  case NODE48: {
+    const node48_t &children = nodes48.items[n.children];
+    uint8_t slot = children.slots[symbol];
+    return slot == 0 ? NO_NODE : children.children[slot - 1];
+  }
+  case NODE256:
+    return nodes256.items[n.children].children[symbol];
+  }
+  return NO_NODE;
+}
+
+uint32_t trie_t::find_child_from(uint32_t node, size_t from, unsigned char *found) const {
+  const node_t &n = nodes[node];
+  switch (n.kind) {
+  case LEAF:
+    return NO_NODE;
+  case NODE4: {
+    const node4_t &children = nodes4.items[n.children];
+    for (size_t i = 0; i < n.children_count; ++i) {
+      if (children.keys[i] >= from) {
+        *found = children.keys[i];
+        return children.children[i];
+      }
+    }
+    return NO_NODE;
+  }
+  case NODE16: {
+    const node16_t &children = nodes16.items[n.children];
+    for (size_t i = 0; i < n.children_count; ++i) {
+      if (children.keys[i] >= from) {
+        *found = children.keys[i];
+        return children.children[i];
+      }
+    }
+    return NO_NODE;
+  }
+  case NODE48: {
+    const node48_t &children = nodes48.items[n.children];
+    for (size_t symbol = from; symbol < children.slots.size(); ++symbol) {
+      if (children.slots[symbol] != 0) {
+        *found = symbol;
+        return children.children[children.slots[symbol] - 1];
+      }
+    }
+    return NO_NODE;
+  }
+  case NODE256: {
+    const node256_t &children = nodes256.items[n.children];
+    for (size_t symbol = from; symbol < children.children.size(); ++symbol) {
+      if (children.children[symbol] != NO_NODE) {
+        *found = symbol;
+        return children.children[symbol];
+      }
+    }
+    return NO_NODE;
+  }
+  }
+  return NO_NODE;
+}
+
+template <typename visitor_t>
+void trie_t::for_each_child(uint32_t node, visitor_t visitor) const {
+  const node_t &n = nodes[node];
+  switch (n.kind) {
+  case LEAF:
+    return;
+  case NODE4: {
+    const node4_t &children = nodes4.items[n.children];
+    for (size_t i = 0; i < n.children_count; ++i) {
+      if (!visitor(children.keys[i], children.children[i])) {
+        return;
+      }
+    }
+    return;
+  }
+  case NODE16: {
+    const node16_t &children = nodes16.items[n.children];
+    for (size_t i = 0; i < n.children_count; ++i) {
+      if (!visitor(children.keys[i], children.children[i])) {
+        return;
+      }
+    }
+    return;
+  }
+  case NODE48: {
+    const node48_t &children = nodes48.items[n.children];
+    for (size_t symbol = 0; symbol < children.slots.size(); ++symbol) {
+      uint8_t slot = children.slots[symbol];
+      if (slot != 0 && !visitor(static_cast<unsigned char>(symbol), children.children[slot - 1])) {
+        return;
+      }
+    }
+    return;
+  }
+  case NODE256: {
+    const node256_t &children = nodes256.items[n.children];
+    for (size_t symbol = 0; symbol < children.children.size(); ++symbol) {
+      uint32_t child = children.children[symbol];
+      if (child != NO_NODE && !visitor(static_cast<unsigned char>(symbol), child)) {
+        return;
+      }
+    }
+    return;
+  }
+  }
+}
+
+void trie_t::change_kind(uint32_t node, node_kind_t kind) {
+  if (nodes[node].kind == kind) {
+    return;
+  }
+  // children in order of symbols, at most 48 when kind is smaller than NODE256
+  std::array<std::pair<unsigned char, uint32_t>, 256> children;
+  size_t count = 0;
+  for_each_child(node, [&](unsigned char symbol, uint32_t child) {
+    children[count++] = {symbol, child};
+    return true;
+  });
+
+  node_t &n = nodes[node];
+  switch (n.kind) {
+  case LEAF:
+    break;
+  case NODE4:
+    nodes4.release(n.children);
+    break;
+  case NODE16:
+    nodes16.release(n.children);
+    break;
+  case NODE48:
+    nodes48.release(n.children);
+    break;
+  case NODE256:
+    nodes256.release(n.children);
+    break;
+  }
+
+  n.kind = kind;
+  n.children = NO_NODE;
+  switch (kind) {
+  case LEAF:
+    break;
+  case NODE4: {
+    n.children = nodes4.allocate();
+    node4_t &container = nodes4.items[n.children];
+    for (size_t i = 0; i < count; ++i) {
+      container.keys[i] = children[i].first;
+      container.children[i] = children[i].second;
+    }
+    break;
+  }
+  case NODE16: {
+    n.children = nodes16.allocate();
+    node16_t &container = nodes16.items[n.children];
+    for (size_t i = 0; i < count; ++i) {
+      container.keys[i] = children[i].first;
+      container.children[i] = children[i].second;
+    }
+    break;
+  }
+  case NODE48: {
+    n.children = nodes48.allocate();
+    node48_t &container = nodes48.items[n.children];
+    container.slots.fill(0);
+    container.children.fill(NO_NODE);
+    for (size_t i = 0; i < count; ++i) {
+      container.slots[children[i].first] = i + 1;
+      container.children[i] = children[i].second;
+    }
+    break;
+  }
+  case NODE256: {
+    n.children = nodes256.allocate();
+    node256_t &container = nodes256.items[n.children];
+    container.children.fill(NO_NODE);
+    for (size_t i = 0; i < count; ++i) {
+      container.children[children[i].first] = children[i].second;
+    }
+    break;
+  }
+  }
+}
+
+template <typename container_t>
+static void insert_sorted(container_t &container, size_t count, unsigned char symbol, uint32_t child) {
+  size_t pos = count;
+  while (pos > 0 && container.keys[pos - 1] > symbol) {
+    container.keys[pos] = container.keys[pos - 1];
+    container.children[pos] = container.children[pos - 1];
+    --pos;
+  }
+  container.keys[pos] = symbol;
+  container.children[pos] = child;
+}
+
+template <typename container_t>
+static void erase_sorted(container_t &container, size_t count, unsigned char symbol) {
+  size_t pos = std::find(container.keys.begin(), container.keys.begin() + count, symbol) - container.keys.begin();
+  for (; pos + 1 < count; ++pos) {
+    container.keys[pos] = container.keys[pos + 1];
+    container.children[pos] = container.children[pos + 1];
+  }
+}
+
+void trie_t::add_child(uint32_t node, unsigned char symbol, uint32_t child) {
+  // grow container if it is full
+  uint16_t count = nodes[node].children_count;
+  switch (nodes[node].kind) {
+  case LEAF:
+    change_kind(node, NODE4);
+    break;
+  case NODE4:
+    if (count == 4) {
+      change_kind(node, NODE16);
+    }
+    break;
+  case NODE16:
+    if (count == 16) {
+      change_kind(node, NODE48);
+    }
+    break;
+  case NODE48:
+    if (count == 48) {
+      change_kind(node, NODE256);
+    }
+    break;
+  case NODE256:
+    break;
+  }
+
+  node_t &n = nodes[node];
+  switch (n.kind) {
+  case LEAF:
+    break;
+  case NODE4:
+    insert_sorted(nodes4.items[n.children], count, symbol, child);
+    break;
+  case NODE16:
+    insert_sorted(nodes16.items[n.children], count, symbol, child);
+    break;
+  case NODE48: {
+    node48_t &container = nodes48.items[n.children];
+    size_t slot = std::find(container.children.begin(), container.children.end(), NO_NODE) -
+                  container.children.begin();
+    container.children[slot] = child;
+    container.slots[symbol] = slot + 1;
+    break;
+  }
+  case NODE256:
+    nodes256.items[n.children].children[symbol] = child;
+    break;
+  }
+  ++n.children_count;
+}
+
+void trie_t::remove_child(uint32_t node, unsigned char symbol) {
+  node_t &n = nodes[node];
+  switch (n.kind) {
+  case LEAF:
+    return;
+  case NODE4:
+    erase_sorted(nodes4.items[n.children], n.children_count, symbol);
+    break;
+  case NODE16:
+    erase_sorted(nodes16.items[n.children], n.children_count, symbol);
+    break;
+  case NODE48: {
+    node48_t &container = nodes48.items[n.children];
+    container.children[container.slots[symbol] - 1] = NO_NODE;
+    container.slots[symbol] = 0;
+    break;
+  }
+  case NODE256:
+    nodes256.items[n.children].children[symbol] = NO_NODE;
+    break;
+  }
+  uint16_t count = --n.children_count;
+
+  // shrink container, leaving some slack to avoid changing kind back and forth
+  if (n.kind == NODE4 && count == 0) {
+    change_kind(node, LEAF);
+  } else if (n.kind == NODE16 && count <= 3) {
+    change_kind(node, NODE4);
+  } else if (n.kind == NODE48 && count <= 12) {
+    change_kind(node, NODE16);
+  } else if (n.kind == NODE256 && count <= 40) {
+    change_kind(node, NODE48);
+  }
+}
+
+void trie_t::insert(const std::string &str) {
+  uint32_t node = 0;
+  ++nodes[node].subtree_count;
+  for (char c : str) {
+    auto symbol = static_cast<unsigned char>(c);
+    uint32_t child = find_child(node, symbol);
+    if (child == NO_NODE) {
+      child = new_node();
+      add_child(node, symbol, child);
+    }
+    node = child;
+    ++nodes[node].subtree_count;
+  }
+  ++nodes[node].end_count;
+}
+
+bool trie_t::erase(const std::string &str) {
+  if (!find(str)) {
+    return false;
+  }
+  uint32_t node = 0;
+  --nodes[node].subtree_count;
+  for (char c : str) {
+    auto symbol = static_cast<unsigned char>(c);
+    uint32_t child = find_child(node, symbol);
+    if (--nodes[child].subtree_count == 0) {
+      // the rest of the path holds only this string: unlink and free it
+      remove_child(node, symbol);
+      while (child != NO_NODE) {
+        uint32_t next = NO_NODE;
+        for_each_child(child, [&next](unsigned char, uint32_t grandchild) {
+          next = grandchild;
+          return false;
+        });
+        free_node(child);
+        child = next;
+      }
+      return true;
+    }
+    node = child;
+  }
+  --nodes[node].end_count;
+  return true;
+}
+
+void trie_t::append_sorted(std::string_view str, std::string &previous, std::vector<uint32_t> &path) {
+  assert(previous <= str);
+  size_t common = std::mismatch(previous.begin(), previous.end(), str.begin(), str.end()).first - previous.begin();
+
+  // nodes below the common prefix are complete, add their counts to parents
+  while (path.size() > common + 1) {
+    uint32_t child = path.back();
+    path.pop_back();
+    nodes[path.back()].subtree_count += nodes[child].subtree_count;
+  }
+  // new symbols are greater than the symbols of existing children
+  for (size_t i = common; i < str.size(); ++i) {
+    uint32_t child = new_node();
+    add_child(path.back(), static_cast<unsigned char>(str[i]), child);
+    path.push_back(child);
+  }
+  ++nodes[path.back()].end_count;
+  ++nodes[path.back()].subtree_count;
+
+  previous.resize(common);
+  previous.append(str.substr(common));
+}
+
+void trie_t::finish_sorted(std::vector<uint32_t> &path) {
+  while (path.size() > 1) {
+    uint32_t child = path.back();
+    path.pop_back();
+    nodes[path.back()].subtree_count += nodes[child].subtree_count;
+  }
+}
+
+void trie_t::clear() {
+  trie_t().swap(*this);
+}
+
+uint32_t trie_t::find_node(const std::string &str) const {
+  uint32_t node = 0;
+  for (char c : str) {
+    node = find_child(node, static_cast<unsigned char>(c));
+    if (node == NO_NODE) {
+      return NO_NODE;
+    }
+  }
+  return node;
+}
+
+bool trie_t::find(const std::string &str) const {
+  uint32_t node = find_node(str);
+  return node != NO_NODE && nodes[node].end_count > 0;
+}
+
+size_t trie_t::count_with_prefix(const std::string &prefix) const {
+  uint32_t node = find_node(prefix);
+  return node == NO_NODE ? 0 : nodes[node].subtree_count;
+}
+
+std::string trie_t::operator[](size_t index) const {
+  assert(index < size());
+  std::string result;
+  uint32_t node = 0;
+  // skip subtrees which hold fewer strings than index
+  while (index >= nodes[node].end_count) {
+    index -= nodes[node].end_count;
+    uint32_t next = NO_NODE;
+    for_each_child(node, [&](unsigned char symbol, uint32_t child) {
+      if (index < nodes[child].subtree_count) {
+        result += static_cast<char>(symbol);
+        next = child;
+        return false;
+      }
+      index -= nodes[child].subtree_count;
+      return true;
+    });
+    node = next;
+  }
+  return result;
+}
+
+trie_t::const_iterator::const_iterator(const trie_t *trie, uint32_t node, const std::string &prefix)
+    : trie(trie), path{{node, 0}}, buffer(prefix), repeats(trie->nodes[node].end_count) {
+  if (repeats == 0) {
+    advance();
+  }
+}
+
+void trie_t::const_iterator::advance() {
+  // depth-first search, a node is visited before its children
+  while (!path.empty()) {
+    frame_t &top = path.back();
+    unsigned char symbol = 0;
+    uint32_t child = trie->find_child_from(top.node, top.next_symbol, &symbol);
+    if (child == NO_NODE) {
+      path.pop_back();
+      if (path.empty()) {
+        buffer.clear();
+      } else {
+        buffer.pop_back();
+      }
+      continue;
+    }
+    top.next_symbol = symbol + 1;
+    path.push_back({child, 0});
+    buffer += static_cast<char>(symbol);
+    repeats = trie->nodes[child].end_count;
+    if (repeats > 0) {
+      return;
+    }
+  }
+  repeats = 0;
+}
+
+trie_t::const_iterator &trie_t::const_iterator::operator++() {
+  assert(repeats > 0);
+  if (--repeats == 0) {
+    advance();
+  }
+  return *this;
+}
+
+trie_t::const_iterator trie_t::const_iterator::operator++(int) {
+  const_iterator result = *this;
+  ++*this;
+  return result;
+}
+
+bool trie_t::const_iterator::operator==(const const_iterator &other) const {
+  return path.size() == other.path.size() && repeats == other.repeats && buffer == other.buffer;
+}
+
+bool trie_t::const_iterator::operator!=(const const_iterator &other) const {
+  return !(*this == other);
+}
+
+trie_t::const_iterator trie_t::begin() const {
+  return const_iterator(this, 0, "");
+}
+
+trie_t::const_iterator trie_t::end() const {
+  return const_iterator();
+}
+
+trie_t::const_iterator trie_t::begin_with_prefix(const std::string &prefix) const {
+  uint32_t node = find_node(prefix);
+  return node == NO_NODE ? end() : const_iterator(this, node, prefix);
+}
+
+void trie_t::collect(uint32_t node, std::string &buffer, std::vector<std::string> &result) const {
+  result.insert(result.end(), nodes[node].end_count, buffer);
+  for_each_child(node, [&](unsigned char symbol, uint32_t child) {
+    buffer += static_cast<char>(symbol);
+    collect(child, buffer, result);
+    buffer.pop_back();
+    return true;
+  });
+}
+
+std::vector<std::string> trie_t::to_vector() const {
+  std::vector<std::string> result;
+  result.reserve(size());
+  std::string buffer;
+  collect(0, buffer, result);
+  return result;
+}
+
+size_t trie_t::size() const {
+  return nodes[0].subtree_count;
+}
+
+bool trie_t::empty() const {
+  return size() == 0;
+}
+
+void trie_t::swap(trie_t &other) {
+  std::swap(nodes, other.nodes);
+  std::swap(free_list, other.free_list);
+  std::swap(nodes4, other.nodes4);
+  std::swap(nodes16, other.nodes16);
+  std::swap(nodes48, other.nodes48);
+  std::swap(nodes256, other.nodes256);
+}
+
+size_t trie_t::memory_usage() const {
+  return sizeof(*this) + nodes.capacity() * sizeof(node_t) + nodes4.memory_usage() + nodes16.memory_usage() +
+         nodes48.memory_usage() + nodes256.memory_usage();
+}
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <string>
+#include <string_view>
 #include <vector>
 
-#include <map>
-
 class trie_t {
 public:
   trie_t();
@@ -67,6 +70,175 @@ public:
    */
   void swap(trie_t &other);
 
+  /**
+   * @return Number of bytes used by container, including heap memory
+   */
+  size_t memory_usage() const;
+
+  /**
+   * Replace content with strings from [begin, end) which must be sorted in
+   * lexicographic order. Nodes are built in one pass without looking up children
+   * @param begin
+   * @param end
+   */
+  template <typename iterator_t>
+  void build_sorted(iterator_t begin, iterator_t end) {
+    clear();
+    std::string previous;
+    std::vector<uint32_t> path{0};
+    for (; begin != end; ++begin) {
+      append_sorted(*begin, previous, path);
+    }
+    finish_sorted(path);
+  }
+
+  /**
+   * Iterates over strings in lexicographic order, a string inserted several times
+   * is visited several times. Dereferencing gives a view into the buffer of iterator,
+   * it is valid until iterator is changed. Modification of container invalidates iterators
+   */
+  class const_iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::string_view;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const std::string_view *;
+    using reference = std::string_view;
+
+    const_iterator() = default;
+
+    std::string_view operator*() const {
+      return buffer;
+    }
+
+    const_iterator &operator++();
+    const_iterator operator++(int);
+
+    bool operator==(const const_iterator &other) const;
+    bool operator!=(const const_iterator &other) const;
+
+  private:
+    friend class trie_t;
+
+    const_iterator(const trie_t *trie, uint32_t node, const std::string &prefix);
+    // moves to the next node in which some string ends
+    void advance();
+
+    struct frame_t {
+      uint32_t node;
+      // children with smaller symbols are already visited
+      uint16_t next_symbol;
+    };
+
+    const trie_t *trie{nullptr};
+    // nodes from the starting node to the current one, empty for end iterator
+    std::vector<frame_t> path;
+    std::string buffer;
+    // how many more times the current string is visited
+    uint32_t repeats{0};
+  };
+
+  const_iterator begin() const;
+  const_iterator end() const;
+
+  /**
+   * Call visitor(std::string_view) for every string which starts with prefix,
+   * in lexicographic order
+   * @param prefix
+   * @param visitor
+   */
+  template <typename visitor_t>
+  void for_each_with_prefix(const std::string &prefix, visitor_t visitor) const {
+    for (const_iterator it = begin_with_prefix(prefix), last = end(); it != last; ++it) {
+      visitor(*it);
+    }
+  }
+
 private:
+  friend class trie_snapshot_t;
+
+  static constexpr uint32_t NO_NODE = UINT32_MAX;
+
+  /**
+   * Kind of children container of a node: a node keeps its children in the
+   * smallest container which fits them, containers grow and shrink as
+   * children are added and removed
+   */
+  enum node_kind_t : uint8_t { LEAF, NODE4, NODE16, NODE48, NODE256 };
+
+  // up to 4 and up to 16 children, keys are sorted
+  struct node4_t {
+    std::array<uint8_t, 4> keys;
+    std::array<uint32_t, 4> children;
+  };
+  struct node16_t {
+    std::array<uint8_t, 16> keys;
+    std::array<uint32_t, 16> children;
+  };
+  // up to 48 children, slots[symbol] is (index in children + 1) or 0
+  struct node48_t {
+    std::array<uint8_t, 256> slots;
+    std::array<uint32_t, 48> children;
+  };
+  // child per symbol or NO_NODE
+  struct node256_t {
+    std::array<uint32_t, 256> children;
+  };
+
+  /**
+   * Containers of one kind, they refer to each other by 32-bit indices
+   */
+  template <typename T>
+  struct pool_t {
+    std::vector<T> items;
+    std::vector<uint32_t> free_items;
+
+    uint32_t allocate();
+    void release(uint32_t item);
+    size_t memory_usage() const;
+  };
+
+  struct node_t {
+    // index of children container in the pool of node kind
+    uint32_t children{NO_NODE};
+    // number of strings in subtree of this node
+    uint32_t subtree_count{0};
+    // number of strings which end in this node
+    uint32_t end_count{0};
+    uint16_t children_count{0};
+    node_kind_t kind{LEAF};
+  };
+
+  uint32_t find_node(const std::string &str) const;
+  uint32_t find_child(uint32_t node, unsigned char symbol) const;
+  // child with the smallest symbol not less than from, its symbol is stored in found
+  uint32_t find_child_from(uint32_t node, size_t from, unsigned char *found) const;
+  /**
+   * Calls visitor(symbol, child) for children of node in order of symbols
+   * while it returns true
+   */
+  template <typename visitor_t>
+  void for_each_child(uint32_t node, visitor_t visitor) const;
+
+  void add_child(uint32_t node, unsigned char symbol, uint32_t child);
+  void remove_child(uint32_t node, unsigned char symbol);
+  void change_kind(uint32_t node, node_kind_t kind);
+
+  uint32_t new_node();
+  void free_node(uint32_t node);
+
+  // path holds nodes of previous string, they get subtree counts when they leave it
+  void append_sorted(std::string_view str, std::string &previous, std::vector<uint32_t> &path);
+  void finish_sorted(std::vector<uint32_t> &path);
+  const_iterator begin_with_prefix(const std::string &prefix) const;
+
+  void collect(uint32_t node, std::string &buffer, std::vector<std::string> &result) const;
 
+  // nodes[0] is the root, free nodes are linked through children
+  std::vector<node_t> nodes;
+  uint32_t free_list{NO_NODE};
+  pool_t<node4_t> nodes4;
+  pool_t<node16_t> nodes16;
+  pool_t<node48_t> nodes48;
+  pool_t<node256_t> nodes256;
 };
@@ -0,0 +1,109 @@
+#include "gtest/gtest.h"
+
+#include <random>
+#include <thread>
+
+#include "concurrent-phone-book.h"
+#include "utils.h"
+
+static std::string random_string(std::mt19937 &gen, size_t max_len) {
+  std::string result(1 + gen() % max_len, 'a');
+  for (char &c : result) {
+    c = static_cast<char>('a' + gen() % 4);
+  }
+  return result;
+}
+
+TEST(Concurrent, SameAsPhoneBook) {
+  phone_book_t book;
+  concurrent_phone_book_t concurrent_book;
+  std::mt19937 gen(26);
+  for (size_t i = 0; i < 3000; ++i) {
+    std::string number = random_string(gen, 5);
+    switch (gen() % 4) {
+    case 0: {
+      std::string name = random_string(gen, 3);
+      ASSERT_EQ(concurrent_book.create_user(number, name), book.create_user(number, name));
+      break;
+    }
+    case 1: {
+      call_t call{number, static_cast<double>(gen() % 10)};
+      ASSERT_EQ(concurrent_book.add_call(call), book.add_call(call));
+      break;
+    }
+    case 2: {
+      std::vector<call_t> calls(gen() % 10);
+      for (call_t &call : calls) {
+        call = {random_string(gen, 5), static_cast<double>(gen() % 10)};
+      }
+      ASSERT_EQ(concurrent_book.add_calls(calls.data(), calls.size()), book.add_calls(calls.data(), calls.size()));
+      break;
+    }
+    default: {
+      std::string prefix = number.substr(0, gen() % 3);
+      size_t count = gen() % 20;
+      ASSERT_EQ(concurrent_book.search_users_by_number(prefix, count), book.search_users_by_number(prefix, count));
+      ASSERT_EQ(concurrent_book.search_users_by_name(prefix, count), book.search_users_by_name(prefix, count));
+      size_t start_pos = gen() % 100;
+      ASSERT_EQ(concurrent_book.get_calls(start_pos, count), book.get_calls(start_pos, count));
+    }
+    }
+    ASSERT_EQ(concurrent_book.size(), book.size());
+  }
+  ASSERT_EQ(concurrent_book.get_calls(0, SIZE_MAX), book.get_calls(0, SIZE_MAX));
+
+  concurrent_book.clear();
+  ASSERT_TRUE(concurrent_book.empty());
+  ASSERT_TRUE(concurrent_book.get_calls(0, 10).empty());
+}
+
+TEST(Concurrent, ParallelIngestAndQueries) {
+  concurrent_phone_book_t book;
+  static constexpr size_t threads_count = 4;
+  static constexpr size_t users_per_thread = 200;
+  static constexpr size_t calls_per_thread = 2000;
+
+  // thread t owns users "t-i" and calls them with durations growing in ORDER of its calls
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < threads_count; ++t) {
+    threads.emplace_back([&book, t]() {
+      for (size_t i = 0; i < users_per_thread; ++i) {
+        book.create_user(std::to_string(t) + "-" + std::to_string(i), "user");
+      }
+      for (size_t i = 0; i < calls_per_thread; ++i) {
+        call_t call{std::to_string(t) + "-" + std::to_string(i % users_per_thread), static_cast<double>(i)};
+        if (i % 2 == 0) {
+          book.add_call(call);
+        } else {
+          book.add_calls(&call, 1);
+        }
+      }
+    });
+  }
+  std::atomic<bool> done{false};
+  std::thread reader([&]() {
+    while (!done) {
+      ASSERT_LE(book.search_users_by_number("0-", 10).size(), 10);
+      ASSERT_LE(book.search_users_by_name("user", 10).size(), 10);
+      book.get_calls(0, 100);
+    }
+  });
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  done = true;
+  reader.join();
+
+  ASSERT_EQ(book.size(), threads_count * users_per_thread);
+  std::vector<call_t> calls = book.get_calls(0, SIZE_MAX);
+  ASSERT_EQ(calls.size(), threads_count * calls_per_thread);
+  std::vector<double> last_duration(threads_count, -1);
+  for (const call_t &call : calls) {
+    size_t t = call.number[0] - '0';
+    ASSERT_GT(call.duration_s, last_duration[t]);
+    last_duration[t] = call.duration_s;
+  }
+  std::vector<user_info_t> top = book.search_users_by_number("", 1);
+  ASSERT_EQ(top.size(), 1);
+  ASSERT_EQ(top[0].user.number.substr(1), "-199");
+}
@@ -0,0 +1,154 @@
+#include "concurrent-phone-book.h"
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <mutex>
+
+size_t concurrent_phone_book_t::shard_of(std::string_view number) {
+  // high bits, the low ones choose slots of user_index_t inside of shard
+  size_t hash = std::hash<std::string_view>()(number);
+  return (hash >> 32 ^ hash >> 48) % SHARDS_COUNT;
+}
+
+bool concurrent_phone_book_t::create_user(const std::string &number, const std::string &name) {
+  shard_t &shard = shards[shard_of(number)];
+  std::unique_lock lock(shard.mutex);
+  return shard.book.create_user(number, name);
+}
+
+bool concurrent_phone_book_t::add_call(const call_t &call) {
+  shard_t &shard = shards[shard_of(call.number)];
+  std::unique_lock lock(shard.mutex);
+  if (!shard.book.add_call(call)) {
+    return false;
+  }
+  // sequence number is taken under the lock, so every taken number is stored when all shards are locked
+  shard.call_sequence.push_back(calls_count.fetch_add(1));
+  return true;
+}
+
+std::vector<size_t> concurrent_phone_book_t::add_calls(const call_t *calls, size_t count) {
+  // calls are split by shard, the involved shards are locked in ascending order to avoid deadlocks
+  std::array<std::vector<call_t>, SHARDS_COUNT> shard_calls;
+  std::array<std::vector<size_t>, SHARDS_COUNT> shard_positions;
+  for (size_t i = 0; i < count; ++i) {
+    size_t shard = shard_of(calls[i].number);
+    shard_calls[shard].push_back(calls[i]);
+    shard_positions[shard].push_back(i);
+  }
+  std::array<std::unique_lock<std::shared_mutex>, SHARDS_COUNT> locks;
+  for (size_t shard = 0; shard < SHARDS_COUNT; ++shard) {
+    if (!shard_calls[shard].empty()) {
+      locks[shard] = std::unique_lock(shards[shard].mutex);
+    }
+  }
+
+  std::vector<bool> accepted(count, true);
+  for (size_t shard = 0; shard < SHARDS_COUNT; ++shard) {
+    if (shard_calls[shard].empty()) {
+      // no calls, so the shard isn't locked
+      continue;
+    }
+    for (size_t rejected : shards[shard].book.add_calls(shard_calls[shard].data(), shard_calls[shard].size())) {
+      accepted[shard_positions[shard][rejected]] = false;
+    }
+  }
+  // accepted calls of the batch get consecutive sequence numbers in ORDER
+  uint64_t sequence = calls_count.fetch_add(std::count(accepted.begin(), accepted.end(), true));
+  std::vector<size_t> rejected;
+  for (size_t i = 0; i < count; ++i) {
+    if (accepted[i]) {
+      shards[shard_of(calls[i].number)].call_sequence.push_back(sequence++);
+    } else {
+      rejected.push_back(i);
+    }
+  }
+  return rejected;
+}
+
+std::vector<call_t> concurrent_phone_book_t::get_calls(size_t start_pos, size_t count) const {
+  std::array<std::shared_lock<std::shared_mutex>, SHARDS_COUNT> locks;
+  for (size_t shard = 0; shard < SHARDS_COUNT; ++shard) {
+    locks[shard] = std::shared_lock(shards[shard].mutex);
+  }
+  // with all shards locked sequence numbers of stored calls are exactly [0, calls_count)
+  size_t total = calls_count.load();
+  if (start_pos >= total) {
+    return {};
+  }
+  count = std::min(count, total - start_pos);
+  std::vector<call_t> result(count);
+  for (const shard_t &shard : shards) {
+    size_t first = std::lower_bound(shard.call_sequence.begin(), shard.call_sequence.end(), start_pos) -
+                   shard.call_sequence.begin();
+    call_page_t page = shard.book.get_calls_page(first, count);
+    for (size_t i = 0; i < page.size() && shard.call_sequence[first + i] < start_pos + count; ++i) {
+      call_view_t call = page[i];
+      result[shard.call_sequence[first + i] - start_pos] = {std::string(call.number), call.duration_s};
+    }
+  }
+  return result;
+}
+
+template <typename compare_t, typename search_t>
+std::vector<user_info_t> concurrent_phone_book_t::merge_search(size_t count, compare_t compare,
+                                                               search_t search) const {
+  std::vector<user_info_t> result;
+  for (const shard_t &shard : shards) {
+    std::vector<user_info_t> found;
+    {
+      std::shared_lock lock(shard.mutex);
+      found = search(shard.book);
+    }
+    std::vector<user_info_t> merged;
+    merged.reserve(std::min(count, result.size() + found.size()));
+    std::merge(std::make_move_iterator(result.begin()), std::make_move_iterator(result.end()),
+               std::make_move_iterator(found.begin()), std::make_move_iterator(found.end()),
+               std::back_inserter(merged), compare);
+    if (merged.size() > count) {
+      merged.resize(count);
+    }
+    result.swap(merged);
+  }
+  return result;
+}
+
+std::vector<user_info_t> concurrent_phone_book_t::search_users_by_number(const std::string &number_prefix,
+                                                                         size_t count) const {
+  return merge_search(count, compare_by_number(), [&](const phone_book_t &book) {
+    return book.search_users_by_number(number_prefix, count);
+  });
+}
+
+std::vector<user_info_t> concurrent_phone_book_t::search_users_by_name(const std::string &name_prefix,
+                                                                       size_t count) const {
+  return merge_search(count, compare_by_name(), [&](const phone_book_t &book) {
+    return book.search_users_by_name(name_prefix, count);
+  });
+}
+
+void concurrent_phone_book_t::clear() {
+  std::array<std::unique_lock<std::shared_mutex>, SHARDS_COUNT> locks;
+  for (size_t shard = 0; shard < SHARDS_COUNT; ++shard) {
+    locks[shard] = std::unique_lock(shards[shard].mutex);
+  }
+  for (shard_t &shard : shards) {
+    shard.book.clear();
+    shard.call_sequence.clear();
+  }
+  calls_count = 0;
+}
+
+size_t concurrent_phone_book_t::size() const {
+  size_t result = 0;
+  for (const shard_t &shard : shards) {
+    std::shared_lock lock(shard.mutex);
+    result += shard.book.size();
+  }
+  return result;
+}
+
+bool concurrent_phone_book_t::empty() const {
+  return size() == 0;
+}
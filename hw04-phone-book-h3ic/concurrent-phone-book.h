@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#include "phone-book.h"
+
+/**
+ * Phone book for concurrent ingest and queries. Users are sharded by hash of number, every shard is
+ * a phone_book_t behind its own reader-writer lock. Calls get global sequence numbers while their shard
+ * is locked, so get_calls returns them in ORDER of addition across all shards
+ */
+class concurrent_phone_book_t {
+public:
+  static constexpr size_t SHARDS_COUNT = 16;
+
+  concurrent_phone_book_t() = default;
+
+  concurrent_phone_book_t(const concurrent_phone_book_t &other) = delete;
+  concurrent_phone_book_t &operator=(const concurrent_phone_book_t &other) = delete;
+
+  /**
+   * The same as phone_book_t::create_user
+   */
+  bool create_user(const std::string &number, const std::string &name);
+
+  /**
+   * The same as phone_book_t::add_call
+   */
+  bool add_call(const call_t &call);
+
+  /**
+   * The same as phone_book_t::add_calls, calls of the batch get consecutive positions in ORDER
+   */
+  std::vector<size_t> add_calls(const call_t *calls, size_t count);
+
+  /**
+   * The same as phone_book_t::get_calls, all shards are locked for reading, so calls are consistent
+   */
+  std::vector<call_t> get_calls(size_t start_pos, size_t count) const;
+
+  /**
+   * The same as phone_book_t search methods, the first count users of every shard are merged
+   */
+  std::vector<user_info_t> search_users_by_number(const std::string &number_prefix, size_t count) const;
+  std::vector<user_info_t> search_users_by_name(const std::string &name_prefix, size_t count) const;
+
+  void clear();
+  size_t size() const;
+  bool empty() const;
+
+private:
+  struct alignas(64) shard_t {
+    mutable std::shared_mutex mutex;
+    phone_book_t book;
+    // global sequence numbers of book's calls in ORDER
+    std::vector<uint64_t> call_sequence;
+  };
+
+  static size_t shard_of(std::string_view number);
+
+  template <typename compare_t, typename search_t>
+  std::vector<user_info_t> merge_search(size_t count, compare_t compare, search_t search) const;
+
+  std::array<shard_t, SHARDS_COUNT> shards{};
+  std::atomic<uint64_t> calls_count{0};
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "phone-book.h"
+
+/**
+ * Deterministic data for hard tests and benchmarks: generator_t and gen_str produce the same users
+ * and calls for the same seed, hasher_t folds results into a hash
+ */
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wstrict-aliasing"
+class hasher_t {
+public:
+  hasher_t() = default;
+
+  hasher_t &add(uint64_t val) {
+    const uint64_t m = 0xc6a4a7935bd1e995ULL;
+    const int r = 47;
+
+    val *= m;
+    val ^= val >> r;
+    val *= m;
+
+    internal_hash ^= val;
+    internal_hash *= m;
+
+    internal_hash += 0xe6546b64;
+    return *this;
+  }
+
+  hasher_t &add(double val) {
+    return add(*reinterpret_cast<uint64_t *>(&val));
+  }
+
+  template <typename T>
+  hasher_t &add(const std::vector<T> &v) {
+    add(v.size());
+    for (const auto &val : v) {
+      add(val);
+    }
+    return *this;
+  }
+
+  hasher_t &add(const std::string &s) {
+    return add(std::vector<uint64_t>(s.begin(), s.end()));
+  }
+
+  hasher_t &add(const call_t &c) {
+    return add("call").add(c.number).add(c.duration_s);
+  }
+  hasher_t &add(const user_t &u) {
+    return add("user").add(u.number).add(u.name);
+  }
+  hasher_t &add(const user_info_t &u) {
+    return add("user_info_t").add(u.user).add(u.total_call_duration_s);
+  }
+
+  uint64_t get() const {
+    return internal_hash;
+  }
+
+private:
+  uint64_t internal_hash{0x63a36acaf108d0db};
+};
+
+#pragma GCC diagnostic pop
+
+class generator_t {
+public:
+  explicit generator_t(uint32_t seed = 0xcdf8a2dd) : seed(seed % MOD) {}
+
+  uint32_t operator()() {
+    seed = (A * seed + B) % MOD;
+    return static_cast<uint32_t>(seed);
+  }
+
+private:
+  static constexpr uint64_t MOD = 1e9;
+  static constexpr uint64_t A = 0x6b253d97 % MOD;
+  static constexpr uint64_t B = 0x468e9f20 % MOD;
+
+  uint64_t seed{};
+};
+
+inline std::string gen_str(size_t min_len, size_t max_len, generator_t &gen) {
+  assert(min_len <= max_len);
+  size_t len = min_len + gen() % (max_len - min_len + 1);
+  std::string res;
+  res.reserve(len);
+  for (size_t i = 0; i < len; ++i) {
+    res += 'a' + gen() % ('z' - 'a' + 1);
+  }
+  return res;
+}
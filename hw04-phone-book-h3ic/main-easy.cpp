@@ -513,3 +513,121 @@ TEST(Easy, ClearSizeEmpty) {
   ASSERT_EQ(book.search_users_by_number("", 100), std::vector<user_info_t>());
   ASSERT_EQ(book.search_users_by_name("", 100), std::vector<user_info_t>());
 }
+
+TEST(Easy, CopyAndAssignment) {
+  phone_book_t book;
+  for (size_t i = 0; i < 100; ++i) {
+    ASSERT_TRUE(book.create_user(std::to_string(i), "user" + std::to_string(i)));
+  }
+  phone_book_t copy(book);
+  ASSERT_TRUE(copy.add_call({"42", 10}));
+  ASSERT_FALSE(copy.create_user("42", "Ivan"));
+  ASSERT_TRUE(copy.create_user("100", "Ivan"));
+  ASSERT_EQ(copy.search_users_by_number("42", 1), std::vector<user_info_t>({{{"42", "user42"}, 10}}));
+  ASSERT_EQ(book.search_users_by_number("42", 1), std::vector<user_info_t>({{{"42", "user42"}, 0}}));
+  ASSERT_FALSE(book.add_call({"100", 10}));
+
+  book.clear();
+  ASSERT_FALSE(book.add_call({"42", 10}));
+  ASSERT_TRUE(book.create_user("42", "Anna"));
+  ASSERT_TRUE(book.add_call({"42", 5}));
+  ASSERT_EQ(book.search_users_by_number("", 10), std::vector<user_info_t>({{{"42", "Anna"}, 5}}));
+
+  book = copy;
+  ASSERT_EQ(book.size(), 101);
+  ASSERT_TRUE(book.add_call({"100", 1}));
+  ASSERT_FALSE(book.create_user("0", "Anna"));
+  ASSERT_EQ(book.search_users_by_number("100", 1), std::vector<user_info_t>({{{"100", "Ivan"}, 1}}));
+}
+
+TEST(Easy, CallPages) {
+  phone_book_t book;
+  ASSERT_TRUE(book.get_calls_page(0, 10).empty());
+
+  ASSERT_TRUE(book.create_user("123", "Ivan"));
+  ASSERT_TRUE(book.create_user("321", "Anton"));
+  ASSERT_TRUE(book.add_call({"123", 1}));
+  ASSERT_FALSE(book.add_call({"1", 2}));
+  ASSERT_TRUE(book.add_call({"321", 3}));
+  ASSERT_TRUE(book.add_call({"123", 4}));
+
+  call_page_t page = book.get_calls_page(1, 10);
+  ASSERT_EQ(page.size(), 2);
+  ASSERT_EQ(page[0].number, "321");
+  ASSERT_EQ(page[0].duration_s, 3);
+  ASSERT_EQ(page[1].number, "123");
+  ASSERT_EQ(page.durations_s()[1], 4);
+  ASSERT_EQ(book.get_calls_page(0, 2).size(), 2);
+  ASSERT_TRUE(book.get_calls_page(3, 10).empty());
+  ASSERT_TRUE(book.get_calls_page(1, 0).empty());
+  ASSERT_EQ(book.get_calls(1, SIZE_MAX), std::vector<call_t>({{"321", 3}, {"123", 4}}));
+}
+
+TEST(Easy, BatchIngestion) {
+  std::vector<user_t> users = {{"123", "Ivan"}, {"321", "Anton"}, {"123", "Anna"}, {"1", "Anna"}, {"321", "Oleg"}};
+  std::vector<call_t> calls = {{"123", 0.1}, {"2", 1}, {"1", 0.2}, {"123", 0.7}, {"321", 5}, {"3", 1}, {"123", 0.3}};
+
+  phone_book_t book;
+  phone_book_t batch_book;
+  for (const user_t &user : users) {
+    book.create_user(user.number, user.name);
+  }
+  for (const call_t &call : calls) {
+    book.add_call(call);
+  }
+  ASSERT_EQ(batch_book.create_users(users.data(), users.size()), std::vector<size_t>({2, 4}));
+  ASSERT_EQ(batch_book.add_calls(calls.data(), calls.size()), std::vector<size_t>({1, 5}));
+  ASSERT_TRUE(batch_book.add_calls(calls.data(), 0).empty());
+
+  ASSERT_EQ(batch_book.size(), book.size());
+  ASSERT_EQ(batch_book.get_calls(0, 100), book.get_calls(0, 100));
+  ASSERT_EQ(batch_book.search_users_by_number("", 100), book.search_users_by_number("", 100));
+  ASSERT_EQ(batch_book.search_users_by_name("", 100), book.search_users_by_name("", 100));
+  ASSERT_EQ(batch_book.search_users_by_number("", 1), std::vector<user_info_t>({{{"321", "Anton"}, 5}}));
+}
+
+TEST(Easy, BatchIngestionIntoFilledBook) {
+  std::vector<user_t> old_users = {{"12", "Ivan"}, {"1234", "Oleg"}, {"5", "Anna"}};
+  std::vector<call_t> calls = {{"12", 1}, {"5", 2}};
+  std::vector<user_t> users = {{"123", "Anna"}, {"12", "Boris"}, {"1", "Ivan"}, {"124", "Anna"}, {"50", "Ivan"},
+                               {"123", "Petr"}, {"0", "Anna"}};
+
+  phone_book_t book;
+  phone_book_t batch_book;
+  for (phone_book_t *target : {&book, &batch_book}) {
+    ASSERT_TRUE(target->create_users(old_users.data(), old_users.size()).empty());
+    ASSERT_TRUE(target->add_calls(calls.data(), calls.size()).empty());
+  }
+  for (const user_t &user : users) {
+    book.create_user(user.number, user.name);
+  }
+  ASSERT_EQ(batch_book.create_users(users.data(), users.size()), std::vector<size_t>({1, 5}));
+
+  ASSERT_EQ(batch_book.size(), book.size());
+  for (const char *prefix : {"", "1", "12", "123", "5", "0", "9"}) {
+    ASSERT_EQ(batch_book.search_users_by_number(prefix, 100), book.search_users_by_number(prefix, 100));
+    ASSERT_EQ(batch_book.search_users_by_number(prefix, 1), book.search_users_by_number(prefix, 1));
+  }
+  for (const char *prefix : {"", "A", "Anna", "I", "Z"}) {
+    ASSERT_EQ(batch_book.search_users_by_name(prefix, 100), book.search_users_by_name(prefix, 100));
+  }
+  ASSERT_TRUE(batch_book.add_call({"124", 3}));
+  ASSERT_TRUE(book.add_call({"124", 3}));
+  ASSERT_EQ(batch_book.search_users_by_number("1", 100), book.search_users_by_number("1", 100));
+  ASSERT_EQ(batch_book.search_users_by_name("Anna", 100), book.search_users_by_name("Anna", 100));
+}
+
+TEST(Easy, MemoryUsage) {
+  phone_book_t book;
+  size_t empty_usage = book.memory_usage();
+  ASSERT_GE(empty_usage, sizeof(phone_book_t));
+
+  std::string long_name(1000, 'a');
+  ASSERT_TRUE(book.create_user("123", long_name));
+  ASSERT_TRUE(book.add_call({"123", 1}));
+  ASSERT_GE(book.memory_usage(), empty_usage + long_name.size());
+
+  book.clear();
+  phone_book_t copy(book);
+  ASSERT_EQ(copy.memory_usage(), empty_usage);
+}
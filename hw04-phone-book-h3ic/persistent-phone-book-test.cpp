@@ -0,0 +1,282 @@
+#include "gtest/gtest.h"
+
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <random>
+
+#include <sys/resource.h>
+
+#include "persistent-phone-book.h"
+#include "utils.h"
+
+static std::string random_string(std::mt19937 &gen, size_t max_len) {
+  std::string result(1 + gen() % max_len, 'a');
+  for (char &c : result) {
+    c = static_cast<char>('a' + gen() % 4);
+  }
+  return result;
+}
+
+static std::string temp_path(const std::string &name) {
+  std::string path = testing::TempDir() + "persistent-phone-book-" + name;
+  std::remove((path + ".log").c_str());
+  std::remove((path + ".snapshot").c_str());
+  return path;
+}
+
+// the same random operations are applied to both books
+static void apply_random(std::mt19937 &gen, size_t count, persistent_phone_book_t *book, phone_book_t *reference) {
+  for (size_t i = 0; i < count; ++i) {
+    std::string number = random_string(gen, 4);
+    if (gen() % 3 == 0) {
+      std::string name = random_string(gen, 3);
+      ASSERT_EQ(book->create_user(number, name), reference->create_user(number, name));
+    } else {
+      call_t call{number, static_cast<double>(gen() % 10)};
+      ASSERT_EQ(book->add_call(call), reference->add_call(call));
+    }
+  }
+}
+
+static void expect_same(const phone_book_t &book, const phone_book_t &reference) {
+  ASSERT_EQ(book.size(), reference.size());
+  ASSERT_EQ(book.get_calls(0, SIZE_MAX), reference.get_calls(0, SIZE_MAX));
+  for (const char *prefix : {"", "a", "ab", "ba", "ddd"}) {
+    ASSERT_EQ(book.search_users_by_number(prefix, SIZE_MAX), reference.search_users_by_number(prefix, SIZE_MAX));
+    ASSERT_EQ(book.search_users_by_name(prefix, SIZE_MAX), reference.search_users_by_name(prefix, SIZE_MAX));
+  }
+}
+
+static size_t file_size(const std::string &path) {
+  std::ifstream in(path, std::ios::binary | std::ios::ate);
+  return in ? static_cast<size_t>(in.tellg()) : 0;
+}
+
+static std::string read_file(const std::string &path) {
+  std::ifstream in(path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+static void write_file(const std::string &path, const std::string &content) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out << content;
+}
+
+TEST(Persistent, ReopenReplaysLog) {
+  std::string path = temp_path("replay");
+  phone_book_t reference;
+  std::mt19937 gen(27);
+  {
+    // small groups, so that some records are written before close
+    persistent_phone_book_t book(100);
+    ASSERT_TRUE(book.open(path));
+    apply_random(gen, 2000, &book, &reference);
+  }
+  persistent_phone_book_t book;
+  ASSERT_TRUE(book.open(path));
+  expect_same(book.book(), reference);
+
+  ASSERT_TRUE(book.clear());
+  reference.clear();
+  apply_random(gen, 100, &book, &reference);
+  book.close();
+  ASSERT_TRUE(book.open(path));
+  expect_same(book.book(), reference);
+}
+
+TEST(Persistent, SnapshotAndLog) {
+  std::string path = temp_path("snapshot");
+  phone_book_t reference;
+  std::mt19937 gen(28);
+  {
+    persistent_phone_book_t book;
+    ASSERT_TRUE(book.open(path));
+    ASSERT_TRUE(book.snapshot());
+    apply_random(gen, 2000, &book, &reference);
+    ASSERT_TRUE(book.snapshot());
+    apply_random(gen, 500, &book, &reference);
+  }
+  persistent_phone_book_t book;
+  ASSERT_TRUE(book.open(path));
+  expect_same(book.book(), reference);
+
+  // indexes loaded from the snapshot keep working
+  apply_random(gen, 500, &book, &reference);
+  expect_same(book.book(), reference);
+  ASSERT_TRUE(book.snapshot());
+  book.close();
+  ASSERT_TRUE(book.open(path));
+  expect_same(book.book(), reference);
+}
+
+TEST(Persistent, TornTailIsDropped) {
+  std::string path = temp_path("torn");
+  phone_book_t reference;
+  {
+    persistent_phone_book_t book;
+    ASSERT_TRUE(book.open(path));
+    ASSERT_TRUE(book.create_user("123", "Ivan"));
+    ASSERT_TRUE(book.add_call({"123", 5}));
+    reference.create_user("123", "Ivan");
+    reference.add_call({"123", 5});
+  }
+  size_t valid_size = file_size(path + ".log");
+  {
+    persistent_phone_book_t book;
+    ASSERT_TRUE(book.open(path));
+    ASSERT_TRUE(book.add_call({"123", 7}));
+  }
+  // the last record is cut in the middle and followed by garbage
+  std::string log = read_file(path + ".log");
+  write_file(path + ".log", log.substr(0, log.size() - 3) + "garbage");
+
+  persistent_phone_book_t book;
+  ASSERT_TRUE(book.open(path));
+  expect_same(book.book(), reference);
+  ASSERT_EQ(file_size(path + ".log"), valid_size);
+
+  ASSERT_TRUE(book.add_call({"123", 9}));
+  reference.add_call({"123", 9});
+  book.close();
+  ASSERT_TRUE(book.open(path));
+  expect_same(book.book(), reference);
+}
+
+TEST(Persistent, CrashBeforeLogRotation) {
+  std::string path = temp_path("rotation");
+  phone_book_t reference;
+  std::mt19937 gen(29);
+  std::string old_log;
+  {
+    persistent_phone_book_t book;
+    ASSERT_TRUE(book.open(path));
+    apply_random(gen, 300, &book, &reference);
+    ASSERT_TRUE(book.sync());
+    old_log = read_file(path + ".log");
+    ASSERT_TRUE(book.snapshot());
+  }
+  // as if the process died after renaming the snapshot, the old log is covered by the snapshot
+  write_file(path + ".log", old_log);
+  {
+    persistent_phone_book_t book;
+    ASSERT_TRUE(book.open(path));
+    expect_same(book.book(), reference);
+    apply_random(gen, 100, &book, &reference);
+  }
+  persistent_phone_book_t book;
+  ASSERT_TRUE(book.open(path));
+  expect_same(book.book(), reference);
+}
+
+TEST(Persistent, ChangesNeedOpenLog) {
+  std::string path = temp_path("closed");
+  persistent_phone_book_t book;
+  ASSERT_FALSE(book.create_user("123", "Ivan"));
+  ASSERT_FALSE(book.add_call({"123", 5}));
+  ASSERT_FALSE(book.clear());
+  ASSERT_FALSE(book.sync());
+  ASSERT_EQ(book.book().size(), 0);
+
+  ASSERT_TRUE(book.open(path));
+  ASSERT_TRUE(book.create_user("123", "Ivan"));
+  book.close();
+  ASSERT_FALSE(book.add_call({"123", 5}));
+  ASSERT_EQ(book.book().get_calls(0, SIZE_MAX).size(), 0);
+}
+
+TEST(Persistent, FailedLogRejectsChanges) {
+  std::string path = temp_path("failed");
+  phone_book_t reference;
+  std::mt19937 gen(30);
+  persistent_phone_book_t book(100);
+  ASSERT_TRUE(book.open(path));
+  apply_random(gen, 100, &book, &reference);
+  // random numbers are shorter
+  ASSERT_TRUE(book.create_user("00000", "caller"));
+  reference.create_user("00000", "caller");
+  ASSERT_TRUE(book.sync());
+
+  // writes beyond the file size limit fail with EFBIG instead of the signal
+  rlimit old_limit{};
+  ASSERT_EQ(getrlimit(RLIMIT_FSIZE, &old_limit), 0);
+  rlimit limit = old_limit;
+  limit.rlim_cur = file_size(path + ".log") + 50;
+  auto old_handler = std::signal(SIGXFSZ, SIG_IGN);
+  ASSERT_EQ(setrlimit(RLIMIT_FSIZE, &limit), 0);
+  size_t changes = 0;
+  call_t call{"00000", 1};
+  while (changes < 100 && book.add_call(call)) {
+    ++changes;
+  }
+  ASSERT_EQ(setrlimit(RLIMIT_FSIZE, &old_limit), 0);
+  std::signal(SIGXFSZ, old_handler);
+  // changes are buffered until the first group is written, it crosses the limit
+  ASSERT_GT(changes, 0);
+  ASSERT_LT(changes, 100);
+  for (size_t i = 0; i <= changes; ++i) {
+    reference.add_call(call);
+  }
+
+  // the failed change stays in memory, later ones are rejected even though the disk has room again
+  ASSERT_FALSE(book.sync());
+  ASSERT_FALSE(book.create_user("new", "user"));
+  ASSERT_FALSE(book.add_call(call));
+  expect_same(book.book(), reference);
+
+  ASSERT_TRUE(book.snapshot());
+  ASSERT_TRUE(book.add_call({"00000", 2}));
+  reference.add_call({"00000", 2});
+  book.close();
+  ASSERT_TRUE(book.open(path));
+  expect_same(book.book(), reference);
+}
+
+TEST(Persistent, RejectsForeignFiles) {
+  std::string path = temp_path("foreign");
+  write_file(path + ".snapshot", "not a snapshot of phone book");
+  persistent_phone_book_t book;
+  ASSERT_FALSE(book.open(path));
+
+  std::remove((path + ".snapshot").c_str());
+  write_file(path + ".log", "not a log of phone book, but long enough");
+  ASSERT_FALSE(book.open(path));
+}
+
+TEST(Persistent, RejectsCorruptedSnapshot) {
+  std::string path = temp_path("corrupted");
+  {
+    persistent_phone_book_t book;
+    ASSERT_TRUE(book.open(path));
+    for (const char *number : {"1", "12", "123", "2"}) {
+      ASSERT_TRUE(book.create_user(number, "name"));
+    }
+    ASSERT_TRUE(book.add_call({"12", 5}));
+    ASSERT_TRUE(book.snapshot());
+  }
+  const std::string image = read_file(path + ".snapshot");
+  persistent_phone_book_t book;
+  for (size_t position : {size_t{64}, image.size() / 2, image.size() - 1}) {
+    std::string corrupted = image;
+    corrupted[position] ^= 1;
+    write_file(path + ".snapshot", corrupted);
+    ASSERT_FALSE(book.open(path));
+  }
+
+  // node of the last user is out of bounds, but checksum matches: FNV-1a of the image after the 64-byte header
+  std::string corrupted = image;
+  corrupted.replace(corrupted.size() - 4, 4, 4, '\xff');
+  uint32_t hash = 2166136261u;
+  for (size_t i = 64; i < corrupted.size(); ++i) {
+    hash = (hash ^ static_cast<unsigned char>(corrupted[i])) * 16777619u;
+  }
+  corrupted.replace(12, 4, reinterpret_cast<const char *>(&hash), 4);
+  write_file(path + ".snapshot", corrupted);
+  ASSERT_FALSE(book.open(path));
+
+  write_file(path + ".snapshot", image);
+  ASSERT_TRUE(book.open(path));
+  ASSERT_EQ(book.book().size(), 4u);
+  ASSERT_EQ(book.book().get_calls(0, SIZE_MAX).size(), 1u);
+}
@@ -0,0 +1,421 @@
+#include "persistent-phone-book.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static constexpr char LOG_MAGIC[8] = {'P', 'B', 'O', 'O', 'K', 'L', 'O', 'G'};
+static constexpr char SNAPSHOT_MAGIC[8] = {'P', 'B', 'O', 'O', 'K', 'S', 'N', 'P'};
+
+// FNV-1a, continued from hash
+static uint32_t checksum(uint32_t hash, std::string_view data) {
+  for (char c : data) {
+    hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+  }
+  return hash;
+}
+
+static constexpr uint32_t CHECKSUM_BASIS = 2166136261u;
+
+static size_t align8(size_t size) {
+  return (size + 7) / 8 * 8;
+}
+
+static bool write_all(int fd, const char *data, size_t size) {
+  while (size > 0) {
+    ssize_t written = ::write(fd, data, size);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data += written;
+    size -= written;
+  }
+  return true;
+}
+
+// exists is false if there is no such file
+static bool read_file(const std::string &path, std::vector<char> *content, bool *exists) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    *exists = false;
+    return errno == ENOENT;
+  }
+  *exists = true;
+  content->clear();
+  char buffer[64 * 1024];
+  while (true) {
+    ssize_t count = ::read(fd, buffer, sizeof(buffer));
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    if (count <= 0) {
+      ::close(fd);
+      return count == 0;
+    }
+    content->insert(content->end(), buffer, buffer + count);
+  }
+}
+
+// makes rename of a file in directory of path durable
+static bool sync_directory(const std::string &path) {
+  size_t slash = path.find_last_of('/');
+  std::string directory = slash == std::string::npos ? "." : path.substr(0, slash + 1);
+  int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+  if (fd < 0) {
+    return false;
+  }
+  bool result = fsync(fd) == 0;
+  ::close(fd);
+  return result;
+}
+
+// replaces file at path with content atomically
+static bool replace_file(const std::string &path, const std::vector<char> &content) {
+  std::string tmp_path = path + ".tmp";
+  int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    return false;
+  }
+  bool written = write_all(fd, content.data(), content.size()) && fsync(fd) == 0;
+  ::close(fd);
+  return written && rename(tmp_path.c_str(), path.c_str()) == 0 && sync_directory(path);
+}
+
+template <typename element_t>
+static void append_section(std::vector<char> *image, const element_t *data, size_t count) {
+  const char *bytes = reinterpret_cast<const char *>(data);
+  image->insert(image->end(), bytes, bytes + count * sizeof(element_t));
+  image->resize(align8(image->size()));
+}
+
+persistent_phone_book_t::persistent_phone_book_t(size_t group_commit_size) : group_commit_size(group_commit_size) {}
+
+persistent_phone_book_t::~persistent_phone_book_t() {
+  close();
+}
+
+bool persistent_phone_book_t::open(const std::string &path) {
+  close();
+  phone_book.clear();
+  log_path = path + ".log";
+  snapshot_path = path + ".snapshot";
+
+  uint64_t snapshot_generation = 0;
+  if (!load_snapshot(snapshot_path, &snapshot_generation)) {
+    phone_book.clear();
+    return false;
+  }
+  std::vector<char> log;
+  bool log_exists = false;
+  if (!read_file(log_path, &log, &log_exists)) {
+    return false;
+  }
+  if (!log_exists) {
+    return start_log(snapshot_generation + 1);
+  }
+  log_header_t header{};
+  if (log.size() < sizeof(header)) {
+    // the log was being created
+    return start_log(snapshot_generation + 1);
+  }
+  std::memcpy(&header, log.data(), sizeof(header));
+  if (std::memcmp(header.magic, LOG_MAGIC, sizeof(LOG_MAGIC)) != 0 || header.version != VERSION) {
+    return false;
+  }
+  if (header.generation <= snapshot_generation) {
+    // the snapshot was written, but the next log wasn't started, all records are in the snapshot
+    return start_log(snapshot_generation + 1);
+  }
+  if (header.generation != snapshot_generation + 1) {
+    // the log follows a missing snapshot
+    return false;
+  }
+
+  size_t valid_size = replay(log);
+  log_fd = ::open(log_path.c_str(), O_WRONLY | O_APPEND);
+  if (log_fd < 0) {
+    return false;
+  }
+  if (valid_size != log.size() && (ftruncate(log_fd, valid_size) != 0 || fsync(log_fd) != 0)) {
+    close();
+    return false;
+  }
+  log_generation = header.generation;
+  return true;
+}
+
+void persistent_phone_book_t::close() {
+  if (log_fd < 0) {
+    return;
+  }
+  sync();
+  ::close(log_fd);
+  log_fd = -1;
+  log_failed = false;
+  pending.clear();
+}
+
+bool persistent_phone_book_t::create_user(const std::string &number, const std::string &name) {
+  if (log_fd < 0 || log_failed || !phone_book.create_user(number, name)) {
+    return false;
+  }
+  uint32_t number_size = number.size();
+  return append(USER,
+                {std::string_view(reinterpret_cast<const char *>(&number_size), sizeof(number_size)), number, name});
+}
+
+bool persistent_phone_book_t::add_call(const call_t &call) {
+  if (log_fd < 0 || log_failed || !phone_book.add_call(call)) {
+    return false;
+  }
+  return append(CALL, {std::string_view(reinterpret_cast<const char *>(&call.duration_s), sizeof(call.duration_s)),
+                       call.number});
+}
+
+bool persistent_phone_book_t::clear() {
+  if (log_fd < 0 || log_failed) {
+    return false;
+  }
+  phone_book.clear();
+  return append(CLEAR, {});
+}
+
+bool persistent_phone_book_t::sync() {
+  if (log_fd < 0 || log_failed) {
+    return false;
+  }
+  if (pending.empty()) {
+    return true;
+  }
+  // records are kept on failure, a retry would append them after a torn record, which replay stops at
+  log_failed = !write_all(log_fd, pending.data(), pending.size()) || fdatasync(log_fd) != 0;
+  if (!log_failed) {
+    pending.clear();
+  }
+  return !log_failed;
+}
+
+bool persistent_phone_book_t::append(record_type_t type, std::initializer_list<std::string_view> parts) {
+  record_header_t header{};
+  header.type = type;
+  header.checksum = CHECKSUM_BASIS;
+  for (std::string_view part : parts) {
+    header.size += part.size();
+    header.checksum = checksum(header.checksum, part);
+  }
+  const char *header_bytes = reinterpret_cast<const char *>(&header);
+  pending.insert(pending.end(), header_bytes, header_bytes + sizeof(header));
+  for (std::string_view part : parts) {
+    pending.insert(pending.end(), part.begin(), part.end());
+  }
+  return pending.size() < group_commit_size || sync();
+}
+
+size_t persistent_phone_book_t::replay(const std::vector<char> &log) {
+  size_t position = sizeof(log_header_t);
+  while (log.size() - position >= sizeof(record_header_t)) {
+    record_header_t header;
+    std::memcpy(&header, log.data() + position, sizeof(header));
+    if (log.size() - position - sizeof(header) < header.size) {
+      break;
+    }
+    std::string_view payload(log.data() + position + sizeof(header), header.size);
+    if (checksum(CHECKSUM_BASIS, payload) != header.checksum) {
+      break;
+    }
+    if (header.type == USER && payload.size() >= sizeof(uint32_t)) {
+      uint32_t number_size;
+      std::memcpy(&number_size, payload.data(), sizeof(number_size));
+      payload.remove_prefix(sizeof(number_size));
+      if (number_size > payload.size()) {
+        break;
+      }
+      phone_book.create_user(std::string(payload.substr(0, number_size)), std::string(payload.substr(number_size)));
+    } else if (header.type == CALL && payload.size() >= sizeof(double)) {
+      call_t call;
+      std::memcpy(&call.duration_s, payload.data(), sizeof(call.duration_s));
+      call.number = payload.substr(sizeof(double));
+      phone_book.add_call(call);
+    } else if (header.type == CLEAR && payload.empty()) {
+      phone_book.clear();
+    } else {
+      break;
+    }
+    position += sizeof(header) + header.size;
+  }
+  return position;
+}
+
+bool persistent_phone_book_t::snapshot() {
+  // the snapshot has all changes of a failed log too, and the log is replaced by the next one
+  if (log_fd < 0 || (!sync() && !log_failed)) {
+    return false;
+  }
+  const std::vector<user_info_t> &users_info = phone_book.users_info;
+
+  snapshot_header_t header{};
+  std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+  header.version = VERSION;
+  header.log_generation = log_generation;
+  header.users_count = users_info.size();
+  header.calls_count = phone_book.call_users.size();
+  header.index_slots_count = phone_book.users_index.slots.size();
+  header.trie_nodes_count = phone_book.users_by_number.nodes.size();
+
+  std::vector<snapshot_user_t> users(users_info.size());
+  std::string strings;
+  for (size_t i = 0; i < users_info.size(); ++i) {
+    const user_t &user = users_info[i].user;
+    users[i] = {strings.size(), static_cast<uint32_t>(user.number.size()), static_cast<uint32_t>(user.name.size()),
+                users_info[i].total_call_duration_s};
+    strings += user.number;
+    strings += user.name;
+  }
+  header.strings_size = strings.size();
+  std::vector<uint32_t> name_order(phone_book.users_by_name.begin(), phone_book.users_by_name.end());
+
+  std::vector<char> image(sizeof(header));
+  std::memcpy(image.data(), &header, sizeof(header));
+  append_section(&image, users.data(), users.size());
+  append_section(&image, strings.data(), strings.size());
+  append_section(&image, name_order.data(), name_order.size());
+  append_section(&image, phone_book.call_users.data(), phone_book.call_users.size());
+  append_section(&image, phone_book.call_durations.data(), phone_book.call_durations.size());
+  append_section(&image, phone_book.users_index.slots.data(), phone_book.users_index.slots.size());
+  append_section(&image, phone_book.users_by_number.nodes.data(), phone_book.users_by_number.nodes.size());
+  append_section(&image, phone_book.users_by_number.user_nodes.data(), phone_book.users_by_number.user_nodes.size());
+  header.checksum = checksum(CHECKSUM_BASIS, std::string_view(image.data() + sizeof(header), image.size() - sizeof(header)));
+  std::memcpy(image.data(), &header, sizeof(header));
+  if (!replace_file(snapshot_path, image)) {
+    return false;
+  }
+  // a crash here leaves the old log, which is skipped by its generation
+  return start_log(log_generation + 1);
+}
+
+bool persistent_phone_book_t::load_snapshot(const std::string &snapshot_path, uint64_t *generation) {
+  *generation = 0;
+  int fd = ::open(snapshot_path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return errno == ENOENT;
+  }
+  struct stat file_stat {};
+  if (fstat(fd, &file_stat) != 0 || file_stat.st_size < static_cast<off_t>(sizeof(snapshot_header_t))) {
+    ::close(fd);
+    return false;
+  }
+  size_t size = file_stat.st_size;
+  void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    return false;
+  }
+  const char *bytes = static_cast<const char *>(data);
+  snapshot_header_t header;
+  std::memcpy(&header, bytes, sizeof(header));
+
+  // counts are bounded by the file size first, so that section sizes don't overflow
+  bool valid = std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) == 0 && header.version == VERSION &&
+               header.users_count <= size && header.calls_count <= size && header.strings_size <= size &&
+               header.index_slots_count <= size && header.trie_nodes_count <= size && header.trie_nodes_count > 0 &&
+               (header.index_slots_count & (header.index_slots_count - 1)) == 0 &&
+               header.index_slots_count >= 2 * header.users_count;
+
+  // offsets of sections in the file, every section is 8-byte aligned
+  size_t users_offset = sizeof(header);
+  size_t strings_offset = users_offset + header.users_count * sizeof(snapshot_user_t);
+  size_t name_order_offset = strings_offset + align8(header.strings_size);
+  size_t call_users_offset = name_order_offset + align8(header.users_count * sizeof(uint32_t));
+  size_t call_durations_offset = call_users_offset + align8(header.calls_count * sizeof(uint32_t));
+  size_t slots_offset = call_durations_offset + header.calls_count * sizeof(double);
+  size_t nodes_offset = slots_offset + header.index_slots_count * sizeof(user_index_t::slot_t);
+  size_t user_nodes_offset = nodes_offset + align8(header.trie_nodes_count * sizeof(number_trie_t::node_t));
+  valid = valid && size == user_nodes_offset + align8(header.users_count * sizeof(uint32_t)) &&
+          header.checksum == checksum(CHECKSUM_BASIS, std::string_view(bytes + users_offset, size - users_offset));
+
+  // every position and node index is checked too, so that even an image with a matching checksum can't index out of bounds
+  const auto *users = reinterpret_cast<const snapshot_user_t *>(bytes + users_offset);
+  const char *strings = bytes + strings_offset;
+  const auto *name_order = reinterpret_cast<const uint32_t *>(bytes + name_order_offset);
+  const auto *call_users = reinterpret_cast<const uint32_t *>(bytes + call_users_offset);
+  const auto *slots = reinterpret_cast<const user_index_t::slot_t *>(bytes + slots_offset);
+  const auto *nodes = reinterpret_cast<const number_trie_t::node_t *>(bytes + nodes_offset);
+  const auto *user_nodes = reinterpret_cast<const uint32_t *>(bytes + user_nodes_offset);
+  for (size_t i = 0; valid && i < header.users_count; ++i) {
+    valid = users[i].strings_offset + users[i].number_size + users[i].name_size <= header.strings_size &&
+            name_order[i] < header.users_count && user_nodes[i] < header.trie_nodes_count;
+  }
+  for (size_t i = 0; valid && i < header.calls_count; ++i) {
+    valid = call_users[i] < header.users_count;
+  }
+  // probing stops at an empty slot, so there must be as many used slots as users
+  size_t used_slots = 0;
+  for (size_t i = 0; valid && i < header.index_slots_count; ++i) {
+    valid = slots[i].position_plus_one <= header.users_count;
+    used_slots += slots[i].position_plus_one != 0;
+  }
+  valid = valid && used_slots == header.users_count;
+  auto is_node = [&header](uint32_t node) { return node == number_trie_t::NONE || node < header.trie_nodes_count; };
+  auto is_user = [&header](uint32_t user) { return user == number_trie_t::NONE || user < header.users_count; };
+  for (size_t i = 0; valid && i < header.trie_nodes_count; ++i) {
+    valid = is_node(nodes[i].parent) && is_node(nodes[i].first_child) && is_node(nodes[i].next_sibling) &&
+            is_user(nodes[i].user) && is_user(nodes[i].best);
+  }
+  if (valid) {
+    std::vector<user_info_t> &users_info = phone_book.users_info;
+    users_info.resize(header.users_count);
+    for (size_t i = 0; i < header.users_count; ++i) {
+      const char *number = strings + users[i].strings_offset;
+      users_info[i].user.number.assign(number, users[i].number_size);
+      users_info[i].user.name.assign(number + users[i].number_size, users[i].name_size);
+      users_info[i].total_call_duration_s = users[i].total_call_duration_s;
+    }
+    const auto *call_durations = reinterpret_cast<const double *>(bytes + call_durations_offset);
+    phone_book.call_users.assign(call_users, call_users + header.calls_count);
+    phone_book.call_durations.assign(call_durations, call_durations + header.calls_count);
+
+    phone_book.users_index.slots.assign(slots, slots + header.index_slots_count);
+    phone_book.users_index.used = header.users_count;
+
+    phone_book.users_by_number.nodes.assign(nodes, nodes + header.trie_nodes_count);
+    phone_book.users_by_number.user_nodes.assign(user_nodes, user_nodes + header.users_count);
+
+    // positions are already sorted, so every insertion at the end takes constant time
+    for (size_t i = 0; i < header.users_count; ++i) {
+      phone_book.users_by_name.insert(phone_book.users_by_name.end(), name_order[i]);
+    }
+    *generation = header.log_generation;
+  }
+  munmap(data, size);
+  return valid;
+}
+
+bool persistent_phone_book_t::start_log(uint64_t generation) {
+  if (log_fd >= 0) {
+    ::close(log_fd);
+    log_fd = -1;
+  }
+  pending.clear();
+  log_failed = false;
+  log_header_t header{};
+  std::memcpy(header.magic, LOG_MAGIC, sizeof(LOG_MAGIC));
+  header.version = VERSION;
+  header.generation = generation;
+  const char *header_bytes = reinterpret_cast<const char *>(&header);
+  if (!replace_file(log_path, std::vector<char>(header_bytes, header_bytes + sizeof(header)))) {
+    return false;
+  }
+  log_fd = ::open(log_path.c_str(), O_WRONLY | O_APPEND);
+  if (log_fd < 0) {
+    return false;
+  }
+  log_generation = generation;
+  return true;
+}
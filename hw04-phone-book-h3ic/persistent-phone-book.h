@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "phone-book.h"
+
+/**
+ * Phone book which survives restarts. Changes are appended to a binary log <path>.log and are fsynced
+ * in groups, snapshot() writes users, calls and indexes to <path>.snapshot, which is mapped and copied
+ * on open without rebuilding the indexes, and starts a new log. open() loads the snapshot and replays
+ * the log written after it.
+ * Every log and snapshot have a generation number, the snapshot covers its log generation, so a crash
+ * between writing a snapshot and starting the next log doesn't apply changes twice.
+ * Files are in host byte order
+ */
+class persistent_phone_book_t {
+public:
+  /**
+   * @param group_commit_size -- buffered log bytes, which are written and fsynced together
+   */
+  explicit persistent_phone_book_t(size_t group_commit_size = 64 * 1024);
+  ~persistent_phone_book_t();
+
+  persistent_phone_book_t(const persistent_phone_book_t &other) = delete;
+  persistent_phone_book_t &operator=(const persistent_phone_book_t &other) = delete;
+
+  /**
+   * Load phone book from snapshot and log with specified path prefix, missing files mean empty book.
+   * Incomplete or corrupted tail of the log, which a crash may leave, is dropped
+   * @param path
+   * @return false if files can't be read or written or aren't a snapshot and a log
+   */
+  bool open(const std::string &path);
+
+  /**
+   * Sync and close files, the book stays in memory and can't be changed until the next open()
+   */
+  void close();
+
+  /**
+   * The same as phone_book_t methods, changes are durable after the next sync().
+   * Nothing is changed if no log is open or the log has failed. If the log fails on this change, it stays in memory,
+   * but false is returned
+   */
+  bool create_user(const std::string &number, const std::string &name);
+  bool add_call(const call_t &call);
+  bool clear();
+
+  /**
+   * Write and fsync all buffered log records. If it fails, the log may end with a torn record, so it fails every
+   * next sync() and change, until snapshot() or open()
+   * @return true on success
+   */
+  bool sync();
+
+  /**
+   * Write snapshot of the whole book and start an empty log, also after the log has failed
+   * @return true on success
+   */
+  bool snapshot();
+
+  /**
+   * @return phone book for queries
+   */
+  const phone_book_t &book() const {
+    return phone_book;
+  }
+
+private:
+  // version 2 added checksum of snapshot
+  static constexpr uint32_t VERSION = 2;
+
+  enum record_type_t : uint8_t { USER = 1, CALL = 2, CLEAR = 3 };
+
+  struct log_header_t {
+    char magic[8];
+    uint32_t version;
+    uint32_t padding;
+    uint64_t generation;
+  };
+
+  // record is followed by size bytes of payload
+  struct record_header_t {
+    uint8_t type;
+    uint8_t padding[3];
+    uint32_t size;
+    uint32_t checksum;
+  };
+
+  struct snapshot_header_t {
+    char magic[8];
+    uint32_t version;
+    // of the image after the header
+    uint32_t checksum;
+    uint64_t log_generation;
+    uint64_t users_count;
+    uint64_t calls_count;
+    uint64_t strings_size;
+    uint64_t index_slots_count;
+    uint64_t trie_nodes_count;
+  };
+
+  struct snapshot_user_t {
+    // number and name are strings[strings_offset, strings_offset + number_size + name_size)
+    uint64_t strings_offset;
+    uint32_t number_size;
+    uint32_t name_size;
+    double total_call_duration_s;
+  };
+
+  // record payload is concatenation of parts, returns false if the log has failed
+  bool append(record_type_t type, std::initializer_list<std::string_view> parts);
+  // replays records after the log header, returns size of the valid part of log
+  size_t replay(const std::vector<char> &log);
+  bool load_snapshot(const std::string &snapshot_path, uint64_t *generation);
+  bool start_log(uint64_t generation);
+
+  phone_book_t phone_book{};
+  std::string log_path{};
+  std::string snapshot_path{};
+  int log_fd{-1};
+  // a write or fsync of the log has failed
+  bool log_failed{false};
+  uint64_t log_generation{0};
+  size_t group_commit_size;
+  std::vector<char> pending{};
+};
@@ -0,0 +1,209 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "generators.h"
+#include "phone-book.h"
+
+enum query_t { NUMBER_PREFIX, NAME_PREFIX, CALLS, CALLS_PAGE };
+
+static constexpr size_t PAGE_SIZE = 100;
+static constexpr size_t SEARCH_COUNT = 10;
+
+// latencies of every SAMPLE_PERIOD-th operation, which are reported as percentiles. Other operations run without
+// reading the clock, which would otherwise dominate operations of a few tens of nanoseconds
+class latencies_t {
+public:
+  static constexpr size_t SAMPLE_PERIOD = 64;
+  // later samples overwrite the earliest ones, so that memory doesn't grow with iterations
+  static constexpr size_t MAX_SAMPLES = 1 << 16;
+
+  latencies_t() {
+    samples.reserve(MAX_SAMPLES);
+    // the cheapest of back to back clock reads is subtracted from every sample
+    clock_overhead = std::chrono::steady_clock::duration::max();
+    for (int i = 0; i < 1000; ++i) {
+      auto start = std::chrono::steady_clock::now();
+      clock_overhead = std::min(clock_overhead, std::chrono::steady_clock::now() - start);
+    }
+  }
+
+  template <typename operation_t>
+  void measure(operation_t operation) {
+    if (operations_count++ % SAMPLE_PERIOD != 0) {
+      operation();
+      return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    operation();
+    auto sample = std::max((std::chrono::steady_clock::now() - start) - clock_overhead, {});
+    size_t index = operations_count / SAMPLE_PERIOD;
+    if (samples.size() < MAX_SAMPLES) {
+      samples.push_back(sample.count());
+    } else {
+      samples[index % MAX_SAMPLES] = sample.count();
+    }
+  }
+
+  void report(benchmark::State &state) {
+    if (samples.empty()) {
+      return;
+    }
+    state.counters["p50_ns"] = percentile(0.5);
+    state.counters["p99_ns"] = percentile(0.99);
+  }
+
+private:
+  double percentile(double fraction) {
+    auto nth = samples.begin() + static_cast<size_t>(fraction * (samples.size() - 1));
+    std::nth_element(samples.begin(), nth, samples.end());
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::duration(*nth)).count();
+  }
+
+  std::vector<std::chrono::steady_clock::rep> samples;
+  std::chrono::steady_clock::duration clock_overhead;
+  size_t operations_count{0};
+};
+
+// memory of this benchmark's book, the process peak RSS would only show the largest benchmark so far
+static void report_memory(benchmark::State &state, const phone_book_t &book) {
+  state.counters["bytes_per_user"] = static_cast<double>(book.memory_usage()) / std::max<size_t>(1, book.size());
+}
+
+// users like in hard tests, numbers are long enough to be mostly distinct at 1e7 users
+static std::vector<user_t> make_users(size_t count, uint32_t seed) {
+  generator_t gen(seed);
+  std::vector<user_t> users(count);
+  for (user_t &user : users) {
+    user = {gen_str(6, 12, gen), gen_str(4, 12, gen)};
+  }
+  return users;
+}
+
+static std::vector<call_t> make_calls(const std::vector<user_t> &users, size_t count, uint32_t seed) {
+  generator_t gen(seed);
+  std::vector<call_t> calls(count);
+  for (call_t &call : calls) {
+    call = {users[gen() % users.size()].number, gen() % 1000 / 100.0};
+  }
+  return calls;
+}
+
+// book with users_count users and as many calls, only the last one is kept to bound memory
+struct fixture_t {
+  size_t users_count;
+  std::vector<user_t> users;
+  phone_book_t book;
+};
+
+static fixture_t &fixture(size_t users_count) {
+  static std::unique_ptr<fixture_t> cache;
+  if (!cache || cache->users_count != users_count) {
+    cache.reset();
+    auto result = std::make_unique<fixture_t>();
+    result->users_count = users_count;
+    result->users = make_users(users_count, users_count);
+    std::vector<call_t> calls = make_calls(result->users, users_count, users_count + 1);
+    for (const user_t &user : result->users) {
+      result->book.create_user(user.number, user.name);
+    }
+    for (const call_t &call : calls) {
+      result->book.add_call(call);
+    }
+    cache = std::move(result);
+  }
+  return *cache;
+}
+
+static void BM_create_user(benchmark::State &state) {
+  size_t users_count = state.range(0);
+  std::vector<user_t> users = make_users(users_count, users_count);
+  latencies_t latencies;
+  phone_book_t book;
+  for (auto _ : state) {
+    state.PauseTiming();
+    book = phone_book_t();
+    state.ResumeTiming();
+    for (const user_t &user : users) {
+      latencies.measure([&]() { book.create_user(user.number, user.name); });
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * users_count);
+  latencies.report(state);
+  report_memory(state, book);
+}
+
+static void BM_add_call(benchmark::State &state) {
+  fixture_t &data = fixture(state.range(0));
+  // calls are added to the cached book, which isn't used after this benchmark with the same size
+  std::vector<call_t> calls = make_calls(data.users, 1 << 16, 28);
+  latencies_t latencies;
+  for (auto _ : state) {
+    for (const call_t &call : calls) {
+      latencies.measure([&]() { data.book.add_call(call); });
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * calls.size());
+  latencies.report(state);
+  report_memory(state, data.book);
+}
+
+static void BM_query(benchmark::State &state) {
+  const fixture_t &data = fixture(state.range(0));
+  auto query = static_cast<query_t>(state.range(1));
+  generator_t gen(state.range(0));
+  latencies_t latencies;
+  for (auto _ : state) {
+    const user_t &user = data.users[gen() % data.users.size()];
+    size_t start_pos = gen() % data.users_count;
+    latencies.measure([&]() {
+      switch (query) {
+      case NUMBER_PREFIX:
+        benchmark::DoNotOptimize(data.book.search_users_by_number(user.number.substr(0, 3), SEARCH_COUNT));
+        break;
+      case NAME_PREFIX:
+        benchmark::DoNotOptimize(data.book.search_users_by_name(user.name.substr(0, 3), SEARCH_COUNT));
+        break;
+      case CALLS:
+        benchmark::DoNotOptimize(data.book.get_calls(start_pos, PAGE_SIZE));
+        break;
+      case CALLS_PAGE: {
+        call_page_t page = data.book.get_calls_page(start_pos, PAGE_SIZE);
+        benchmark::DoNotOptimize(page.durations_s());
+        break;
+      }
+      }
+    });
+  }
+  state.SetItemsProcessed(state.iterations());
+  latencies.report(state);
+  report_memory(state, data.book);
+}
+
+static void users_arguments(benchmark::internal::Benchmark *benchmark) {
+  benchmark->ArgName("users");
+  for (int64_t users = 10'000; users <= 10'000'000; users *= 10) {
+    benchmark->Arg(users);
+  }
+}
+
+// sizes are the outer loop, so that the cached book is built once per size
+static void query_arguments(benchmark::internal::Benchmark *benchmark) {
+  benchmark->ArgNames({"users", "query"});
+  for (int64_t users = 10'000; users <= 10'000'000; users *= 10) {
+    for (int64_t query : {NUMBER_PREFIX, NAME_PREFIX, CALLS, CALLS_PAGE}) {
+      benchmark->Args({users, query});
+    }
+  }
+}
+
+BENCHMARK(BM_create_user)->Apply(users_arguments)->Unit(benchmark::kMillisecond);
+// queries go before BM_add_call, which changes the cached book
+BENCHMARK(BM_query)->Apply(query_arguments);
+BENCHMARK(BM_add_call)->Apply(users_arguments)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
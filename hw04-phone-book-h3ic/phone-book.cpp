@@ -1,95 +1,397 @@
 #include "phone-book.h"
 
-bool phone_book_t::create_user(const std::string &number, const std::string &name) {
-  for (auto const &user_info : users_info) {
-    if (user_info.user.number == number) {
-      return false;
+#include <cassert>
+#include <functional>
+
+static bool is_better(uint32_t position1, uint32_t position2, const std::vector<user_info_t> &users_info) {
+  return position2 == UINT32_MAX || compare_by_number()(users_info[position1], users_info[position2]);
+}
+
+uint32_t number_trie_t::find_child(uint32_t node, char symbol) const {
+  uint32_t child = nodes[node].first_child;
+  while (child != NONE && nodes[child].symbol != symbol) {
+    child = nodes[child].next_sibling;
+  }
+  return child;
+}
+
+void number_trie_t::update_best(uint32_t node, const std::vector<user_info_t> &users_info) {
+  uint32_t best = nodes[node].user;
+  for (uint32_t child = nodes[node].first_child; child != NONE; child = nodes[child].next_sibling) {
+    if (is_better(nodes[child].best, best, users_info)) {
+      best = nodes[child].best;
+    }
+  }
+  nodes[node].best = best;
+}
+
+void number_trie_t::insert(uint32_t position, const std::vector<user_info_t> &users_info) {
+  add_nodes(position, users_info);
+  update(position, users_info);
+}
+
+void number_trie_t::insert(std::vector<uint32_t> positions, const std::vector<user_info_t> &users_info) {
+  for (uint32_t position : positions) {
+    add_nodes(position, users_info);
+  }
+  // a user is first in a node only if all earlier users of the batch are not, so it stops where they passed
+  std::sort(positions.begin(), positions.end(), [&users_info](uint32_t position1, uint32_t position2) {
+    return is_better(position1, position2, users_info);
+  });
+  for (uint32_t position : positions) {
+    for (uint32_t node = user_nodes[position]; node != NONE && is_better(position, nodes[node].best, users_info);
+         node = nodes[node].parent) {
+      nodes[node].best = position;
+    }
+  }
+}
+
+void number_trie_t::add_nodes(uint32_t position, const std::vector<user_info_t> &users_info) {
+  uint32_t node = 0;
+  for (char symbol : users_info[position].user.number) {
+    uint32_t child = find_child(node, symbol);
+    if (child == NONE) {
+      assert(nodes.size() < NONE);
+      child = static_cast<uint32_t>(nodes.size());
+      node_t new_node;
+      new_node.parent = node;
+      new_node.next_sibling = nodes[node].first_child;
+      new_node.symbol = symbol;
+      nodes.push_back(new_node);
+      nodes[node].first_child = child;
+    }
+    node = child;
+  }
+  nodes[node].user = position;
+  if (user_nodes.size() <= position) {
+    user_nodes.resize(position + 1, NONE);
+  }
+  user_nodes[position] = node;
+}
+
+void number_trie_t::update(uint32_t position, const std::vector<user_info_t> &users_info) {
+  // ancestors where the user wasn't the first and still isn't don't change, nor do their ancestors
+  for (uint32_t node = user_nodes[position]; node != NONE; node = nodes[node].parent) {
+    if (nodes[node].best == position) {
+      update_best(node, users_info);
+    } else if (is_better(position, nodes[node].best, users_info)) {
+      nodes[node].best = position;
+    } else {
+      break;
+    }
+  }
+}
+
+std::vector<uint32_t> number_trie_t::search(std::string_view prefix, size_t count,
+                                            const std::vector<user_info_t> &users_info) const {
+  std::vector<uint32_t> result;
+  uint32_t node = 0;
+  for (size_t i = 0; i < prefix.size() && node != NONE; ++i) {
+    node = find_child(node, prefix[i]);
+  }
+  if (node == NONE || nodes[node].best == NONE) {
+    return result;
+  }
+
+  // heap of single users (node is NONE) and subtrees represented by their first users,
+  // the top one is the next user in order
+  struct entry_t {
+    uint32_t position;
+    uint32_t node;
+  };
+  const auto later = [&users_info](const entry_t &entry1, const entry_t &entry2) {
+    return is_better(entry2.position, entry1.position, users_info);
+  };
+  std::vector<entry_t> heap = {{nodes[node].best, node}};
+  while (!heap.empty() && result.size() < count) {
+    std::pop_heap(heap.begin(), heap.end(), later);
+    entry_t entry = heap.back();
+    heap.pop_back();
+    if (entry.node == NONE) {
+      result.push_back(entry.position);
+      continue;
+    }
+    const node_t &expanded = nodes[entry.node];
+    if (expanded.user != NONE) {
+      heap.push_back({expanded.user, NONE});
+      std::push_heap(heap.begin(), heap.end(), later);
+    }
+    for (uint32_t child = expanded.first_child; child != NONE; child = nodes[child].next_sibling) {
+      if (nodes[child].best != NONE) {
+        heap.push_back({nodes[child].best, child});
+        std::push_heap(heap.begin(), heap.end(), later);
+      }
+    }
+  }
+  return result;
+}
+
+void number_trie_t::clear() {
+  nodes.assign(1, node_t());
+  user_nodes.clear();
+}
+
+size_t number_trie_t::memory_usage() const {
+  return sizeof(*this) + nodes.capacity() * sizeof(node_t) + user_nodes.capacity() * sizeof(uint32_t);
+}
+
+phone_book_t::phone_book_t(const phone_book_t &other)
+    : users_info(other.users_info), call_users(other.call_users), call_durations(other.call_durations),
+      users_index(other.users_index),
+      users_by_number(other.users_by_number),
+      users_by_name(other.users_by_name.begin(), other.users_by_name.end(), name_order_t{&users_info}) {}
+
+phone_book_t &phone_book_t::operator=(const phone_book_t &other) {
+  if (this != &other) {
+    users_info = other.users_info;
+    call_users = other.call_users;
+    call_durations = other.call_durations;
+    users_index = other.users_index;
+    users_by_number = other.users_by_number;
+    // sorted range is inserted in linear time
+    users_by_name = std::set<uint32_t, name_order_t>(other.users_by_name.begin(), other.users_by_name.end(),
+                                                     name_order_t{&users_info});
+  }
+  return *this;
+}
+
+uint32_t user_index_t::hash(std::string_view number) {
+  size_t hash = std::hash<std::string_view>()(number);
+  return static_cast<uint32_t>(hash ^ hash >> 32);
+}
+
+size_t user_index_t::probe(std::string_view number, uint32_t hash,
+                           const std::vector<user_info_t> &users_info) const {
+  // linear probing, capacity is a power of two
+  size_t mask = slots.size() - 1;
+  for (size_t i = hash & mask;; i = (i + 1) & mask) {
+    const slot_t &slot = slots[i];
+    if (slot.position_plus_one == 0 ||
+        (slot.hash == hash && users_info[slot.position_plus_one - 1].user.number == number)) {
+      return i;
+    }
+  }
+}
+
+void user_index_t::grow() {
+  std::vector<slot_t> old_slots(std::max<size_t>(16, 2 * slots.size()));
+  old_slots.swap(slots);
+  size_t mask = slots.size() - 1;
+  for (const slot_t &slot : old_slots) {
+    if (slot.position_plus_one != 0) {
+      size_t i = slot.hash & mask;
+      while (slots[i].position_plus_one != 0) {
+        i = (i + 1) & mask;
+      }
+      slots[i] = slot;
     }
   }
+}
+
+size_t user_index_t::find(std::string_view number, const std::vector<user_info_t> &users_info) const {
+  if (slots.empty()) {
+    return NOT_FOUND;
+  }
+  const slot_t &slot = slots[probe(number, hash(number), users_info)];
+  return slot.position_plus_one == 0 ? NOT_FOUND : slot.position_plus_one - 1;
+}
+
+bool user_index_t::insert(std::string_view number, size_t position, const std::vector<user_info_t> &users_info) {
+  assert(position < UINT32_MAX);
+  // load factor is at most 1/2
+  if (2 * (used + 1) > slots.size()) {
+    grow();
+  }
+  uint32_t number_hash = hash(number);
+  slot_t &slot = slots[probe(number, number_hash, users_info)];
+  if (slot.position_plus_one != 0) {
+    return false;
+  }
+  slot = {static_cast<uint32_t>(position + 1), number_hash};
+  ++used;
+  return true;
+}
+
+void user_index_t::reserve(size_t users_count) {
+  while (2 * users_count > slots.size()) {
+    grow();
+  }
+}
+
+void user_index_t::clear() {
+  slots.clear();
+  used = 0;
+}
+
+size_t user_index_t::memory_usage() const {
+  return sizeof(*this) + slots.capacity() * sizeof(slot_t);
+}
+
+bool phone_book_t::create_user(const std::string &number, const std::string &name) {
+  if (!users_index.insert(number, users_info.size(), users_info)) {
+    return false;
+  }
   user_info_t user_info;
   user_info.user.number = number;
   user_info.user.name = name;
-  users_info.push_back(user_info);
+  users_info.push_back(std::move(user_info));
+  users_by_number.insert(static_cast<uint32_t>(users_info.size() - 1), users_info);
+  users_by_name.insert(static_cast<uint32_t>(users_info.size() - 1));
   return true;
 }
 
 bool phone_book_t::add_call(const call_t &call) {
-  auto call_number = call.number;
-  for (auto &user_info : users_info) {
-    if (user_info.user.number == std::string(call_number)) {
-      calls.push_back(call);
-      user_info.total_call_duration_s += call.duration_s;
-      return true;
-    }
+  size_t position = users_index.find(call.number, users_info);
+  if (position == user_index_t::NOT_FOUND) {
+    return false;
   }
-  return false;
+  call_users.push_back(static_cast<uint32_t>(position));
+  call_durations.push_back(call.duration_s);
+  // only this user moves in name index, its node is reused
+  auto node = users_by_name.extract(static_cast<uint32_t>(position));
+  users_info[position].total_call_duration_s += call.duration_s;
+  users_by_name.insert(std::move(node));
+  users_by_number.update(static_cast<uint32_t>(position), users_info);
+  return true;
 }
 
-std::vector<call_t> phone_book_t::get_calls(size_t start_pos, size_t count) const {
-  size_t calls_size = calls.size();
-  size_t chunk = start_pos + count;
-  if (chunk <= calls_size and count > 0) {
-    return std::vector<call_t>(calls.begin() + int(start_pos), calls.begin() + int(chunk));
-  } else if (chunk > calls_size and start_pos < calls_size) {
-    return std::vector<call_t>(calls.begin() + int(start_pos), calls.end());
-  } else {
-    return std::vector<call_t>{};
+std::vector<size_t> phone_book_t::create_users(const user_t *users, size_t count) {
+  users_info.reserve(users_info.size() + count);
+  users_index.reserve(users_info.size() + count);
+  std::vector<size_t> rejected;
+  std::vector<uint32_t> created;
+  for (size_t i = 0; i < count; ++i) {
+    if (!users_index.insert(users[i].number, users_info.size(), users_info)) {
+      rejected.push_back(i);
+      continue;
+    }
+    created.push_back(static_cast<uint32_t>(users_info.size()));
+    user_info_t user_info;
+    user_info.user = users[i];
+    users_info.push_back(std::move(user_info));
+  }
+  users_by_number.insert(created, users_info);
+
+  // inserted in descending order, every user goes right before the previous one, which is a constant time hint
+  // unless older users are between them
+  std::sort(created.begin(), created.end(), name_order_t{&users_info});
+  auto hint = users_by_name.end();
+  for (auto it = created.rbegin(); it != created.rend(); ++it) {
+    hint = users_by_name.insert(hint, *it);
   }
+  return rejected;
 }
 
-struct compare_by_number {
-  bool operator()(const user_info_t &info1, const user_info_t &info2) const {
-    return (info1.total_call_duration_s > info2.total_call_duration_s) ||
-           ((info1.total_call_duration_s == info2.total_call_duration_s) && (info1.user.name < info2.user.name)) ||
-           ((info1.total_call_duration_s == info2.total_call_duration_s) && (info1.user.name == info2.user.name) &&
-            (info1.user.number < info2.user.number));
+std::vector<size_t> phone_book_t::add_calls(const call_t *calls, size_t count) {
+  call_users.reserve(call_users.size() + count);
+  call_durations.reserve(call_durations.size() + count);
+  std::vector<size_t> rejected;
+  size_t first_call = call_users.size();
+  for (size_t i = 0; i < count; ++i) {
+    size_t position = users_index.find(calls[i].number, users_info);
+    if (position == user_index_t::NOT_FOUND) {
+      rejected.push_back(i);
+    } else {
+      call_users.push_back(static_cast<uint32_t>(position));
+      call_durations.push_back(calls[i].duration_s);
+    }
   }
-};
 
-std::vector<user_info_t> phone_book_t::search_users_by_number(const std::string &number_prefix, size_t count) const {
-  std::vector<user_info_t> result = {};
-  std::vector<user_info_t> users_info_sorted = users_info;
-  std::sort(users_info_sorted.begin(), users_info_sorted.end(), compare_by_number());
-  for (const auto &contact : users_info_sorted) {
-    if (contact.user.number.rfind(number_prefix, 0) == 0) {
-      result.push_back(contact);
+  // calls are grouped by user, durations are summed in ORDER like by add_call, so the totals are the same
+  std::vector<uint32_t> added(call_users.size() - first_call);
+  for (size_t i = 0; i < added.size(); ++i) {
+    added[i] = static_cast<uint32_t>(first_call + i);
+  }
+  std::stable_sort(added.begin(), added.end(),
+                   [this](uint32_t call1, uint32_t call2) { return call_users[call1] < call_users[call2]; });
+  for (size_t group = 0; group < added.size();) {
+    uint32_t position = call_users[added[group]];
+    auto node = users_by_name.extract(position);
+    for (; group < added.size() && call_users[added[group]] == position; ++group) {
+      users_info[position].total_call_duration_s += call_durations[added[group]];
     }
+    users_by_name.insert(std::move(node));
+    users_by_number.update(position, users_info);
   }
-  if (result.size() <= count) {
-    return result;
-  } else {
-    return std::vector<user_info_t>(result.begin(), result.begin() + int(count));
+  return rejected;
+}
+
+call_page_t phone_book_t::get_calls_page(size_t start_pos, size_t count) const {
+  size_t calls_size = call_users.size();
+  if (start_pos >= calls_size) {
+    return {};
   }
+  count = std::min(count, calls_size - start_pos);
+  return {&users_info, call_users.data() + start_pos, call_durations.data() + start_pos, count};
 }
 
-struct compare_by_name {
-  bool operator()(const user_info_t &info1, const user_info_t &info2) const {
-    return (info1.user.name < info2.user.name) ||
-           ((info1.user.name == info2.user.name) && (info1.total_call_duration_s > info2.total_call_duration_s)) ||
-           ((info1.user.name == info2.user.name) && (info1.total_call_duration_s == info2.total_call_duration_s) &&
-            (info1.user.number < info2.user.number));
+std::vector<call_t> phone_book_t::get_calls(size_t start_pos, size_t count) const {
+  call_page_t page = get_calls_page(start_pos, count);
+  std::vector<call_t> result;
+  result.reserve(page.size());
+  for (size_t i = 0; i < page.size(); ++i) {
+    call_view_t call = page[i];
+    result.push_back({std::string(call.number), call.duration_s});
   }
-};
+  return result;
+}
 
-std::vector<user_info_t> phone_book_t::search_users_by_name(const std::string &name_prefix, size_t count) const {
+std::vector<user_info_t> phone_book_t::search_users_by_number(const std::string &number_prefix, size_t count) const {
   std::vector<user_info_t> result = {};
-  std::vector<user_info_t> users_info_sorted = users_info;
-  std::sort(users_info_sorted.begin(), users_info_sorted.end(), compare_by_name());
-  for (const auto &contact : users_info_sorted) {
-    if (contact.user.name.rfind(name_prefix, 0) == 0) {
-      result.push_back(contact);
-    }
+  for (uint32_t position : users_by_number.search(number_prefix, count, users_info)) {
+    result.push_back(users_info[position]);
   }
-  if (result.size() <= count) {
-    return result;
-  } else {
-    return std::vector<user_info_t>(result.begin(), result.begin() + int(count));
+  return result;
+}
+
+std::vector<user_info_t> phone_book_t::search_users_by_name(const std::string &name_prefix, size_t count) const {
+  // name index is in order of the result, users with prefix are its range
+  std::vector<user_info_t> result = {};
+  for (auto it = users_by_name.lower_bound(name_prefix);
+       it != users_by_name.end() && result.size() < count && users_info[*it].user.name.rfind(name_prefix, 0) == 0;
+       ++it) {
+    result.push_back(users_info[*it]);
   }
+  return result;
+}
+
+bool name_order_t::operator()(uint32_t position1, uint32_t position2) const {
+  return compare_by_name()((*users_info)[position1], (*users_info)[position2]);
+}
+
+bool name_order_t::operator()(uint32_t position, std::string_view prefix) const {
+  return (*users_info)[position].user.name < prefix;
+}
+
+bool name_order_t::operator()(std::string_view prefix, uint32_t position) const {
+  return prefix < (*users_info)[position].user.name;
 }
 
 void phone_book_t::clear() {
   users_info.clear();
-  calls.clear();
+  call_users.clear();
+  call_durations.clear();
+  users_index.clear();
+  users_by_number.clear();
+  users_by_name.clear();
+}
+
+// heap memory of string, short strings are stored inside of it
+static size_t heap_usage(const std::string &str) {
+  const char *object = reinterpret_cast<const char *>(&str);
+  bool inside = str.data() >= object && str.data() < object + sizeof(str);
+  return inside ? 0 : str.capacity() + 1;
+}
+
+size_t phone_book_t::memory_usage() const {
+  size_t result = sizeof(*this) + users_info.capacity() * sizeof(user_info_t) +
+                  call_users.capacity() * sizeof(uint32_t) + call_durations.capacity() * sizeof(double) +
+                  users_index.memory_usage() + users_by_number.memory_usage();
+  for (const user_info_t &info : users_info) {
+    result += heap_usage(info.user.number) + heap_usage(info.user.name);
+  }
+  // node of std::set is estimated as its value, three pointers and color
+  return result + users_by_name.size() * (sizeof(uint32_t) + 4 * sizeof(void *));
 }
 
 size_t phone_book_t::size() const {
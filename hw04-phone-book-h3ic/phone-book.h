@@ -1,7 +1,10 @@
 #pragma once
 
+#include <cstdint>
 #include <iostream>
+#include <set>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <algorithm>
 
@@ -50,6 +53,194 @@ struct user_info_t {
   }
 };
 
+/**
+ * Order of search_users_by_number results: total call duration (descending), name, number
+ */
+struct compare_by_number {
+  bool operator()(const user_info_t &info1, const user_info_t &info2) const {
+    return (info1.total_call_duration_s > info2.total_call_duration_s) ||
+           ((info1.total_call_duration_s == info2.total_call_duration_s) && (info1.user.name < info2.user.name)) ||
+           ((info1.total_call_duration_s == info2.total_call_duration_s) && (info1.user.name == info2.user.name) &&
+            (info1.user.number < info2.user.number));
+  }
+};
+
+/**
+ * Order of search_users_by_name results: name, total call duration (descending), number
+ */
+struct compare_by_name {
+  bool operator()(const user_info_t &info1, const user_info_t &info2) const {
+    return (info1.user.name < info2.user.name) ||
+           ((info1.user.name == info2.user.name) && (info1.total_call_duration_s > info2.total_call_duration_s)) ||
+           ((info1.user.name == info2.user.name) && (info1.total_call_duration_s == info2.total_call_duration_s) &&
+            (info1.user.number < info2.user.number));
+  }
+};
+
+class persistent_phone_book_t;
+
+/**
+ * Call-history record inside of phone book, number refers to the phone book's storage
+ */
+struct call_view_t {
+  std::string_view number;
+  double duration_s{0};
+};
+
+/**
+ * Page of call-history records, it refers to the phone book and is valid until the book is changed
+ */
+class call_page_t {
+public:
+  call_page_t() = default;
+  call_page_t(const std::vector<user_info_t> *users_info, const uint32_t *users, const double *durations, size_t size)
+      : users_info(users_info), users(users), durations(durations), calls_count(size) {}
+
+  size_t size() const {
+    return calls_count;
+  }
+  bool empty() const {
+    return calls_count == 0;
+  }
+  call_view_t operator[](size_t index) const {
+    return {(*users_info)[users[index]].user.number, durations[index]};
+  }
+  /**
+   * @return durations of all calls of the page in ORDER
+   */
+  const double *durations_s() const {
+    return durations;
+  }
+
+private:
+  const std::vector<user_info_t> *users_info{nullptr};
+  const uint32_t *users{nullptr};
+  const double *durations{nullptr};
+  size_t calls_count{0};
+};
+
+/**
+ * Open-addressing hash index from user's number to user's position in users_info of phone book.
+ * Positions and hashes are stored instead of pointers, so the index stays valid when the book is copied
+ */
+class user_index_t {
+public:
+  static constexpr size_t NOT_FOUND = SIZE_MAX;
+
+  /**
+   * @return position of user with specified number or NOT_FOUND
+   */
+  size_t find(std::string_view number, const std::vector<user_info_t> &users_info) const;
+
+  /**
+   * Adds position of user with specified number, who is going to be stored there.
+   * @return false if user with specified number is already indexed
+   */
+  bool insert(std::string_view number, size_t position, const std::vector<user_info_t> &users_info);
+
+  /**
+   * Makes room for users_count users without rehashing
+   */
+  void reserve(size_t users_count);
+
+  void clear();
+
+  // bytes of slots and the index itself
+  size_t memory_usage() const;
+
+private:
+  friend class persistent_phone_book_t;
+
+  // empty slots have zero position_plus_one
+  struct slot_t {
+    uint32_t position_plus_one;
+    uint32_t hash;
+  };
+
+  static uint32_t hash(std::string_view number);
+  // the first slot, which is either empty or has user with specified number
+  size_t probe(std::string_view number, uint32_t hash, const std::vector<user_info_t> &users_info) const;
+  void grow();
+
+  std::vector<slot_t> slots{};
+  size_t used{0};
+};
+
+/**
+ * Trie over users' numbers. Every node keeps the first user of its subtree in order of search_users_by_number,
+ * so that the first users with a number prefix are found by best-first walk from the prefix node without sorting
+ */
+class number_trie_t {
+public:
+  /**
+   * Adds user at specified position of users_info
+   */
+  void insert(uint32_t position, const std::vector<user_info_t> &users_info);
+
+  /**
+   * Adds users at specified positions of users_info, every node's first user is updated at most once
+   */
+  void insert(std::vector<uint32_t> positions, const std::vector<user_info_t> &users_info);
+
+  /**
+   * Restores order of subtrees after total call duration of user at specified position changed
+   */
+  void update(uint32_t position, const std::vector<user_info_t> &users_info);
+
+  /**
+   * @return positions of at most count first users with number prefix in order of search_users_by_number
+   */
+  std::vector<uint32_t> search(std::string_view prefix, size_t count, const std::vector<user_info_t> &users_info) const;
+
+  void clear();
+
+  // bytes of nodes and the trie itself
+  size_t memory_usage() const;
+
+private:
+  friend class persistent_phone_book_t;
+
+  static constexpr uint32_t NONE = UINT32_MAX;
+
+  // children are a list linked by next_sibling
+  struct node_t {
+    uint32_t parent{NONE};
+    uint32_t first_child{NONE};
+    uint32_t next_sibling{NONE};
+    // user with number ending at this node and the first user of the subtree
+    uint32_t user{NONE};
+    uint32_t best{NONE};
+    char symbol{0};
+    // snapshots are written as is, so there are no uninitialized bytes
+    char padding[3]{};
+  };
+
+  uint32_t find_child(uint32_t node, char symbol) const;
+  // adds nodes of the user's number without updating the first users
+  void add_nodes(uint32_t position, const std::vector<user_info_t> &users_info);
+  // recomputes best of node from its user and children
+  void update_best(uint32_t node, const std::vector<user_info_t> &users_info);
+
+  // nodes[0] is root
+  std::vector<node_t> nodes = std::vector<node_t>(1);
+  // node of every user by position
+  std::vector<uint32_t> user_nodes{};
+};
+
+/**
+ * Orders positions of users in users_info by name, total call duration (descending) and number,
+ * like search_users_by_name does. Positions are also comparable with name prefixes
+ */
+struct name_order_t {
+  using is_transparent = void;
+
+  const std::vector<user_info_t> *users_info;
+
+  bool operator()(uint32_t position1, uint32_t position2) const;
+  bool operator()(uint32_t position, std::string_view prefix) const;
+  bool operator()(std::string_view prefix, uint32_t position) const;
+};
+
 /**
  * Class of phone book you have to implement
  */
@@ -63,12 +254,12 @@ public:
   /**
    * Copy constructor
    */
-  phone_book_t(const phone_book_t &other) = default;
+  phone_book_t(const phone_book_t &other);
 
   /**
    * Copy assignment
    */
-  phone_book_t &operator=(const phone_book_t &other) = default;
+  phone_book_t &operator=(const phone_book_t &other);
 
   /**
    * Destructor
@@ -91,6 +282,22 @@ public:
    */
   bool add_call(const call_t &call);
 
+  /**
+   * Creates users in ORDER, like create_user for each of them, but the new users are added to the indexes
+   * together
+   * @param users -- array of count new users
+   * @return zero-indexed positions in users of the users which weren't created, in ascending order
+   */
+  std::vector<size_t> create_users(const user_t *users, size_t count);
+
+  /**
+   * Adds call-history records in ORDER, like add_call for each of them, but every user's position in
+   * indexes is updated once per batch
+   * @param calls -- array of count call-records
+   * @return zero-indexed positions in calls of the records which weren't added, in ascending order
+   */
+  std::vector<size_t> add_calls(const call_t *calls, size_t count);
+
   /**
    * All calls are sorted in ORDER of their addition.
    * Return at most count call-record starts from start_pos (zero-indexed) in ORDER
@@ -100,6 +307,11 @@ public:
    */
   std::vector<call_t> get_calls(size_t start_pos, size_t count) const;
 
+  /**
+   * The same calls as get_calls without copying, see call_page_t
+   */
+  call_page_t get_calls_page(size_t start_pos, size_t count) const;
+
   /**
    * Find at most count users with number starts with number_prefix sorted by:
    *    total call duration
@@ -127,6 +339,11 @@ public:
    */
   void clear();
 
+  /**
+   * @return Number of bytes used by container, including heap memory
+   */
+  size_t memory_usage() const;
+
   /**
    * @return count of users in your phone book
    */
@@ -138,6 +355,14 @@ public:
   bool empty() const;
 
 private:
+  friend class persistent_phone_book_t;
+
   std::vector<user_info_t> users_info{};
-  std::vector<call_t> calls{};
+  // calls are stored by columns, calls can be made only to users, so number is position of user
+  std::vector<uint32_t> call_users{};
+  std::vector<double> call_durations{};
+  user_index_t users_index{};
+  number_trie_t users_by_number{};
+  // name index refers to users_info, so it is rebuilt on copy with own users_info
+  std::set<uint32_t, name_order_t> users_by_name{name_order_t{&users_info}};
 };
@@ -0,0 +1,40 @@
+#include "game/bitboard.h"
+
+#include <string>
+#include <vector>
+
+bitboard_t::bitboard_t(const field_t &field) {
+  for (int x = 0; x < field_t::FIELD_SIZE; ++x) {
+    for (int y = 0; y < field_t::FIELD_SIZE; ++y) {
+      uint128_t mask = cell_mask(x, y);
+      switch (field[x][y]) {
+      case field_t::SHIP_CELL:
+        ships |= mask;
+        break;
+      case field_t::HIT_CELL:
+        ships |= mask;
+        hits |= mask;
+        break;
+      case field_t::MISS_CELL:
+        misses |= mask;
+        break;
+      default:
+        break;
+      }
+    }
+  }
+}
+
+field_t bitboard_t::to_field(bool hide_ships) const {
+  field_t field(std::vector<std::string>(field_t::FIELD_SIZE, std::string(field_t::FIELD_SIZE, field_t::EMPTY_CELL)));
+  for (int x = 0; x < field_t::FIELD_SIZE; ++x) {
+    for (int y = 0; y < field_t::FIELD_SIZE; ++y) {
+      field[x][y] = cell(x, y, hide_ships);
+    }
+  }
+  return field;
+}
+
+std::ostream &operator<<(std::ostream &stream, const bitboard_t &board) {
+  return stream << board.to_field();
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+
+#include "game/field.h"
+
+__extension__ typedef unsigned __int128 uint128_t;
+
+/**
+ * Compact field: ships, hits and misses are 128-bit masks with bit x * STRIDE + y for cell (x, y).
+ * Every row has an extra always empty column, so that shifts by 1 and by STRIDE give neighbours
+ * without wrapping to the next row
+ */
+class bitboard_t {
+public:
+  enum shot_t { INCORRECT, DUPLICATE, MISS, HIT, KILL };
+
+  static constexpr size_t STRIDE = field_t::FIELD_SIZE + 1;
+
+  bitboard_t() = default;
+
+  /**
+   * Field may contain ships, hits and misses
+   */
+  explicit bitboard_t(const field_t &field);
+
+  static uint128_t cell_mask(int x, int y) {
+    return uint128_t{1} << (x * STRIDE + y);
+  }
+
+  static uint128_t row_mask(int x) {
+    return ((uint128_t{1} << field_t::FIELD_SIZE) - 1) << (x * STRIDE);
+  }
+
+  static size_t count(uint128_t mask) {
+    return __builtin_popcountll(static_cast<uint64_t>(mask)) + __builtin_popcountll(static_cast<uint64_t>(mask >> 64));
+  }
+
+  /**
+   * Marks the cell as shot
+   * @return what the shot did, the field isn't changed for INCORRECT and DUPLICATE
+   */
+  shot_t shoot(int x, int y) {
+    if (!field_t::is_cell_valid(x, y)) {
+      return INCORRECT;
+    }
+    uint128_t cell = cell_mask(x, y);
+    if ((hits | misses) & cell) {
+      return DUPLICATE;
+    }
+    if (!(ships & cell)) {
+      misses |= cell;
+      return MISS;
+    }
+    hits |= cell;
+    return (ship_of(cell) & ~hits) ? HIT : KILL;
+  }
+
+  /**
+   * @return cells of the ship, which contains cell
+   */
+  uint128_t ship_of(uint128_t cell) const {
+    // ships are straight and at most field wide, so growing by neighbours stops after a few steps
+    uint128_t ship = cell & ships;
+    while (true) {
+      uint128_t grown = (ship | ship << 1 | ship >> 1 | ship << STRIDE | ship >> STRIDE) & ships;
+      if (grown == ship) {
+        return ship;
+      }
+      ship = grown;
+    }
+  }
+
+  /**
+   * @return true if some ship cells aren't hit
+   */
+  bool has_ships() const {
+    return (ships & ~hits) != 0;
+  }
+
+  /**
+   * @return cell of char-grid view
+   */
+  char cell(int x, int y, bool hide_ships = false) const {
+    uint128_t mask = cell_mask(x, y);
+    if (hits & mask) {
+      return field_t::HIT_CELL;
+    }
+    if (misses & mask) {
+      return field_t::MISS_CELL;
+    }
+    return (ships & mask) && !hide_ships ? field_t::SHIP_CELL : field_t::EMPTY_CELL;
+  }
+
+  /**
+   * @return char-grid view, which an enemy sees if hide_ships is true
+   */
+  field_t to_field(bool hide_ships = false) const;
+
+  uint128_t ships_mask() const {
+    return ships;
+  }
+  uint128_t hits_mask() const {
+    return hits;
+  }
+  uint128_t misses_mask() const {
+    return misses;
+  }
+
+  friend bool operator==(const bitboard_t &a, const bitboard_t &b) {
+    return a.ships == b.ships && a.hits == b.hits && a.misses == b.misses;
+  }
+  friend bool operator!=(const bitboard_t &a, const bitboard_t &b) {
+    return !(a == b);
+  }
+
+  friend std::ostream &operator<<(std::ostream &stream, const bitboard_t &board);
+
+private:
+  uint128_t ships{0};
+  uint128_t hits{0};
+  uint128_t misses{0};
+};
@@ -4,52 +4,93 @@
 #include <cassert>
 #include <random>
 
+#include "game/bitboard.h"
+
+// cells, where a ship may be placed, are empty and have no ship neighbours by side
+static uint128_t allowed_cells(uint128_t ships) {
+  static const uint128_t all_cells = []() {
+    uint128_t result = 0;
+    for (int x = 0; x < field_t::FIELD_SIZE; ++x) {
+      for (int y = 0; y < field_t::FIELD_SIZE; ++y) {
+        result |= bitboard_t::cell_mask(x, y);
+      }
+    }
+    return result;
+  }();
+  uint128_t forbidden = ships | ships << 1 | ships >> 1 | ships << bitboard_t::STRIDE | ships >> bitboard_t::STRIDE;
+  return all_cells & ~forbidden;
+}
+
+// first cells of ships with ship_len cells of allowed, which go from the first cell in direction
+static uint128_t ship_starts(uint128_t allowed, size_t ship_len, std::pair<int, int> direction) {
+  int step = direction.first * static_cast<int>(bitboard_t::STRIDE) + direction.second;
+  uint128_t result = allowed;
+  for (int q = 1; q < ship_len; ++q) {
+    // the extra column isn't allowed, so shifts don't wrap ships to other rows
+    result &= step > 0 ? allowed >> (q * step) : allowed << (q * -step);
+  }
+  return result;
+}
+
 field_t::field_t(uint32_t seed) : field(FIELD_SIZE, std::string(FIELD_SIZE, EMPTY_CELL)) {
   std::seed_seq seq = {seed};
   std::mt19937_64 gen(seq);
+  place_ships(gen);
+}
 
-  std::vector<size_t> ships_len = {4, 3, 3, 2, 2, 2, 1, 1, 1, 1};
-  std::shuffle(ships_len.begin(), ships_len.end(), gen);
+field_t::field_t(std::mt19937_64 &gen) : field(FIELD_SIZE, std::string(FIELD_SIZE, EMPTY_CELL)) {
+  place_ships(gen);
+}
 
-  const auto check_cell = [&, this](int x, int y) {
-    if (!is_cell_valid(x, y) || field[x][y] != EMPTY_CELL) {
-      return false;
-    }
-    return std::all_of(DIRECTIONS.begin(), DIRECTIONS.end(), [&, this](const std::pair<int, int> &dir) {
-      int dx = x + dir.first;
-      int dy = y + dir.second;
-      return !(is_cell_valid(dx, dy) && field[dx][dy] == SHIP_CELL);
-    });
-  };
+void field_t::place_ships(std::mt19937_64 &gen) {
+  std::array<size_t, 10> ships_len = {4, 3, 3, 2, 2, 2, 1, 1, 1, 1};
+  std::shuffle(ships_len.begin(), ships_len.end(), gen);
 
+  // positions are numbered by cell and then by direction, like when they were listed one by one,
+  // so the same seed gives the same field
+  uint128_t ships = 0;
   while (true) {
-    field = std::vector<std::string>(FIELD_SIZE, std::string(FIELD_SIZE, EMPTY_CELL));
+    ships = 0;
     bool flag = true;
     for (size_t ship_len : ships_len) {
-      std::vector<std::tuple<int, int, size_t>> available_positions;
-      for (int i = 0; i < FIELD_SIZE; ++i) {
-        for (int j = 0; j < FIELD_SIZE; ++j) {
-          for (size_t k = 0; k < DIRECTIONS.size(); ++k) {
-            bool able = true;
-            for (int q = 0; q < ship_len; ++q) {
-              able &= check_cell(i + q * DIRECTIONS[k].first, j + q * DIRECTIONS[k].second);
-            }
-            if (able) {
-              available_positions.emplace_back(i, j, k);
-            }
-          }
-        }
+      uint128_t allowed = allowed_cells(ships);
+      std::array<uint128_t, DIRECTIONS.size()> starts{};
+      size_t positions_count = 0;
+      for (size_t k = 0; k < DIRECTIONS.size(); ++k) {
+        starts[k] = ship_starts(allowed, ship_len, DIRECTIONS[k]);
+        positions_count += bitboard_t::count(starts[k]);
       }
 
-      if (available_positions.empty()) {
+      if (positions_count == 0) {
         flag = false;
         break;
       }
 
-      auto [x, y, dir_pos] =
-          available_positions[std::uniform_int_distribution<size_t>(0, available_positions.size() - 1)(gen)];
+      size_t position = std::uniform_int_distribution<size_t>(0, positions_count - 1)(gen);
+      int x = 0;
+      for (;; ++x) {
+        uint128_t row = bitboard_t::row_mask(x);
+        size_t row_count = 0;
+        for (uint128_t start : starts) {
+          row_count += bitboard_t::count(start & row);
+        }
+        if (position < row_count) {
+          break;
+        }
+        position -= row_count;
+      }
+      int y = -1;
+      size_t dir_pos = 0;
+      for (int j = 0; y < 0; ++j) {
+        for (size_t k = 0; k < DIRECTIONS.size() && y < 0; ++k) {
+          if ((starts[k] & bitboard_t::cell_mask(x, j)) && position-- == 0) {
+            y = j;
+            dir_pos = k;
+          }
+        }
+      }
       for (int q = 0; q < ship_len; ++q) {
-        field[x + q * DIRECTIONS[dir_pos].first][y + q * DIRECTIONS[dir_pos].second] = SHIP_CELL;
+        ships |= bitboard_t::cell_mask(x + q * DIRECTIONS[dir_pos].first, y + q * DIRECTIONS[dir_pos].second);
       }
     }
 
@@ -57,6 +98,14 @@ field_t::field_t(uint32_t seed) : field(FIELD_SIZE, std::string(FIELD_SIZE, EMPT
       break;
     }
   }
+
+  for (int x = 0; x < FIELD_SIZE; ++x) {
+    for (int y = 0; y < FIELD_SIZE; ++y) {
+      if (ships & bitboard_t::cell_mask(x, y)) {
+        field[x][y] = SHIP_CELL;
+      }
+    }
+  }
 }
 
 field_t::field_t(std::vector<std::string> field) : field(std::move(field)) {
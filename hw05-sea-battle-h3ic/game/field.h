@@ -3,6 +3,7 @@
 #include <array>
 #include <cstdint>
 #include <iostream>
+#include <random>
 #include <string>
 #include <vector>
 
@@ -15,7 +16,14 @@ public:
 
   static constexpr size_t FIELD_SIZE = 10;
 
+  /**
+   * Random standard set of ships, the same seed gives the same field
+   */
   explicit field_t(uint32_t seed);
+  /**
+   * Random standard set of ships drawn from gen, which is cheaper than seeding a generator for every field
+   */
+  explicit field_t(std::mt19937_64 &gen);
   explicit field_t(std::vector<std::string> field);
   field_t(std::initializer_list<std::string> field) : field_t(std::vector<std::string>(field)) {}
 
@@ -43,5 +51,7 @@ public:
                                                                     std::make_pair(1, 0), std::make_pair(-1, 0)};
 
 private:
+  void place_ships(std::mt19937_64 &gen);
+
   std::vector<std::string> field;
 };
@@ -1,31 +1,142 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
 #include <memory>
 #include <set>
 #include <string>
 
+#include "game/bitboard.h"
 #include "game/field.h"
 #include "players/player-interface.h"
 
-class sea_battle_t {
+/**
+ * Turns and moves of a game, which don't depend on types of players
+ */
+class sea_battle_base_t {
 public:
   enum turn_t { FIRST_PLAYER = 0, SECOND_PLAYER = 1 };
 
-  sea_battle_t(std::shared_ptr<player_interface_t> player1, field_t field1, std::shared_ptr<player_interface_t> player2,
-               field_t field2);
+  /**
+   * @return the player, who made the last move, after play() it is the winner
+   */
+  turn_t get_turn() const {
+    return current_turn;
+  }
 
-  ~sea_battle_t() = default;
-
-  void play();
+  /**
+   * @return moves made by both players including incorrect and duplicate ones
+   */
+  size_t get_moves_count() const {
+    return moves_count;
+  }
 
   static turn_t change_turn(turn_t current_turn);
   static std::string get_player_name(turn_t turn);
 
+protected:
+  turn_t current_turn{FIRST_PLAYER};
+  size_t moves_count{0};
+};
+
+/**
+ * Game of two players, which are std::shared_ptr of players or players themselves. In the second case
+ * types of players are known at compile time, so their calls aren't virtual and may be inlined,
+ * which is used for games of AI players in tournaments
+ */
+template <typename player1_t, typename player2_t>
+class basic_sea_battle_t : public sea_battle_base_t {
+public:
+  basic_sea_battle_t(player1_t player1, field_t field1, player2_t player2, field_t field2)
+      : first{std::move(player1), field1}, second{std::move(player2), field2} {}
+
+  ~basic_sea_battle_t() = default;
+
+  void play();
+
 private:
-  std::shared_ptr<player_interface_t> player1;
-  std::shared_ptr<player_interface_t> player2;
-  field_t field1;
-  field_t field2;
-  sea_battle_t::turn_t current_turn{FIRST_PLAYER};
+  template <typename player_t>
+  struct side_t {
+    side_t(player_t player, const field_t &field)
+        : player{std::move(player)}, board{field}, view{board.to_field()}, hidden_view{board.to_field(true)},
+          ship_cells_left{bitboard_t::count(board.ships_mask() & ~board.hits_mask())} {}
+
+    player_t player;
+    bitboard_t board;
+    // views of the field for its owner and for the enemy, only shot cells change during the game
+    field_t view;
+    field_t hidden_view;
+    size_t ship_cells_left;
+  };
+
+  template <typename player_t>
+  static player_t &get_player(player_t &player) {
+    return player;
+  }
+  template <typename player_t>
+  static player_t &get_player(std::shared_ptr<player_t> &player) {
+    return *player;
+  }
+
+  /**
+   * Player of side moves until a miss or a win
+   * @return true if the player won
+   */
+  template <typename player_t, typename enemy_player_t>
+  bool play_turn(side_t<player_t> &side, side_t<enemy_player_t> &enemy);
+
+  side_t<player1_t> first;
+  side_t<player2_t> second;
 };
+
+template <typename player1_t, typename player2_t>
+void basic_sea_battle_t<player1_t, player2_t>::play() {
+  while (!(current_turn == FIRST_PLAYER ? play_turn(first, second) : play_turn(second, first))) {
+    current_turn = change_turn(current_turn);
+  }
+}
+
+template <typename player1_t, typename player2_t>
+template <typename player_t, typename enemy_player_t>
+bool basic_sea_battle_t<player1_t, player2_t>::play_turn(side_t<player_t> &side, side_t<enemy_player_t> &enemy) {
+  // views are kept up to date, so turns don't copy fields and don't allocate
+  auto &player = get_player(side.player);
+  while (true) {
+    auto [x, y] = player.make_move(side.view, enemy.hidden_view);
+    ++moves_count;
+    bitboard_t::shot_t shot = enemy.board.shoot(x, y);
+    if (shot == bitboard_t::MISS || shot == bitboard_t::HIT || shot == bitboard_t::KILL) {
+      enemy.view[x][y] = enemy.hidden_view[x][y] = enemy.board.cell(x, y);
+    }
+
+    switch (shot) {
+    case bitboard_t::INCORRECT:
+      player.on_incorrect_move(x, y);
+      break;
+    case bitboard_t::DUPLICATE:
+      player.on_duplicate_move(x, y);
+      break;
+    case bitboard_t::MISS:
+      player.on_miss(x, y);
+      return false;
+    case bitboard_t::HIT:
+      --enemy.ship_cells_left;
+      player.on_hit(x, y);
+      break;
+    case bitboard_t::KILL:
+      --enemy.ship_cells_left;
+      player.on_kill(x, y);
+      if (enemy.ship_cells_left == 0) {
+        player.on_win();
+        get_player(enemy.player).on_lose();
+        return true;
+      }
+      break;
+    }
+  }
+}
+
+// game of any players behind player_interface_t, e.g. human and mock ones
+using sea_battle_t = basic_sea_battle_t<std::shared_ptr<player_interface_t>, std::shared_ptr<player_interface_t>>;
+
+extern template class basic_sea_battle_t<std::shared_ptr<player_interface_t>, std::shared_ptr<player_interface_t>>;
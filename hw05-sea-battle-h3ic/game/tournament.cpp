@@ -0,0 +1,15 @@
+#include "game/tournament.h"
+
+#include <algorithm>
+
+template class basic_tournament_t<std::shared_ptr<player_interface_t>, std::shared_ptr<player_interface_t>>;
+
+tournament_stats_t &tournament_stats_t::operator+=(const tournament_stats_t &other) {
+  games_count += other.games_count;
+  wins[0] += other.wins[0];
+  wins[1] += other.wins[1];
+  moves_count += other.moves_count;
+  // workers run at the same time
+  seconds = std::max(seconds, other.seconds);
+  return *this;
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "game/field.h"
+#include "game/sea-battle.h"
+#include "players/player-interface.h"
+
+/**
+ * Results of games, every worker collects its own, they are merged at the end
+ */
+struct tournament_stats_t {
+  size_t games_count{0};
+  // by sea_battle_t::turn_t of the winner
+  std::array<size_t, 2> wins{};
+  size_t moves_count{0};
+  double seconds{0};
+
+  tournament_stats_t &operator+=(const tournament_stats_t &other);
+
+  double games_per_second() const {
+    return seconds > 0 ? games_count / seconds : 0;
+  }
+  double moves_per_game() const {
+    return games_count > 0 ? static_cast<double>(moves_count) / games_count : 0;
+  }
+};
+
+/**
+ * Plays many games between players of two kinds on a pool of threads. Every worker plays its own range
+ * of games with its own generator seeded by the tournament seed and worker index, so that the results
+ * depend only on the seed and threads count. Players are made as basic_sea_battle_t takes them, so
+ * AI players of known types may be played by value without virtual calls
+ */
+template <typename player1_t, typename player2_t>
+class basic_tournament_t {
+public:
+  // makes a player for one game, gen is the generator of worker, which plays the game
+  template <typename player_t>
+  using player_factory_t = std::function<player_t(std::mt19937_64 &gen)>;
+
+  /**
+   * @param threads_count -- workers count, 0 means hardware concurrency
+   */
+  basic_tournament_t(player_factory_t<player1_t> first_factory, player_factory_t<player2_t> second_factory,
+                     size_t threads_count = 0)
+      : first_factory(std::move(first_factory)), second_factory(std::move(second_factory)),
+        threads_count(threads_count != 0 ? threads_count : std::max(1u, std::thread::hardware_concurrency())) {}
+
+  /**
+   * Plays games_count games on random fields
+   * @return merged statistics of workers
+   */
+  tournament_stats_t run(size_t games_count, uint64_t seed) const;
+
+  size_t get_threads_count() const {
+    return threads_count;
+  }
+
+private:
+  tournament_stats_t run_worker(size_t games_count, uint64_t seed, size_t worker) const;
+
+  player_factory_t<player1_t> first_factory;
+  player_factory_t<player2_t> second_factory;
+  size_t threads_count;
+};
+
+template <typename player1_t, typename player2_t>
+tournament_stats_t basic_tournament_t<player1_t, player2_t>::run(size_t games_count, uint64_t seed) const {
+  auto start = std::chrono::steady_clock::now();
+  std::vector<tournament_stats_t> workers_stats(threads_count);
+  std::vector<std::thread> workers;
+  workers.reserve(threads_count);
+  for (size_t worker = 0; worker < threads_count; ++worker) {
+    // worker plays games [games_count * worker / threads_count, games_count * (worker + 1) / threads_count)
+    size_t worker_games_count =
+        games_count * (worker + 1) / threads_count - games_count * worker / threads_count;
+    workers.emplace_back([this, &workers_stats, worker_games_count, seed, worker]() {
+      workers_stats[worker] = run_worker(worker_games_count, seed, worker);
+    });
+  }
+
+  tournament_stats_t stats;
+  for (size_t worker = 0; worker < threads_count; ++worker) {
+    workers[worker].join();
+    stats += workers_stats[worker];
+  }
+  stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return stats;
+}
+
+template <typename player1_t, typename player2_t>
+tournament_stats_t basic_tournament_t<player1_t, player2_t>::run_worker(size_t games_count, uint64_t seed,
+                                                                        size_t worker) const {
+  std::seed_seq seq = {static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32), static_cast<uint32_t>(worker)};
+  std::mt19937_64 gen(seq);
+
+  auto start = std::chrono::steady_clock::now();
+  tournament_stats_t stats;
+  for (size_t i = 0; i < games_count; ++i) {
+    field_t field1(gen);
+    field_t field2(gen);
+    basic_sea_battle_t<player1_t, player2_t> game(first_factory(gen), std::move(field1), second_factory(gen),
+                                                  std::move(field2));
+    game.play();
+    ++stats.games_count;
+    ++stats.wins[game.get_turn()];
+    stats.moves_count += game.get_moves_count();
+  }
+  stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return stats;
+}
+
+// tournament of any players behind player_interface_t
+using tournament_t = basic_tournament_t<std::shared_ptr<player_interface_t>, std::shared_ptr<player_interface_t>>;
+
+extern template class basic_tournament_t<std::shared_ptr<player_interface_t>, std::shared_ptr<player_interface_t>>;
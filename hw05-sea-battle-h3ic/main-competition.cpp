@@ -1,9 +1,11 @@
 #include "gtest/gtest.h"
 
 #include <chrono>
+#include <iostream>
 #include <random>
 
 #include "game/sea-battle.h"
+#include "game/tournament.h"
 #include "players/simple-ai-player.h"
 #include "players/smart-ai-player.h"
 
@@ -11,16 +13,38 @@ TEST(CompetitionTest, MainTest) {
   static constexpr size_t iterations = 1000;
   static constexpr double wins_factor = 90.0 / 100.0;
 
-  std::seed_seq seq = {std::chrono::high_resolution_clock::now().time_since_epoch().count()};
-  std::mt19937_64 gen(seq);
-  const auto rnd = [&gen]() { return std::uniform_int_distribution<uint32_t>(0)(gen); };
-
-  size_t simple_wins_counter = 0;
-  for (size_t i = 0; i < iterations; ++i) {
-    sea_battle_t game(std::make_shared<simple_ai_player_t>(&simple_wins_counter), field_t(rnd()),
-                      std::make_shared<smart_ai_player_t>(), field_t(rnd()));
-    game.play();
-  }
+  std::atomic<size_t> simple_wins_counter{0};
+  tournament_t tournament(
+      [&simple_wins_counter](std::mt19937_64 &gen) {
+        return std::make_shared<simple_ai_player_t>(gen(), &simple_wins_counter);
+      },
+      [](std::mt19937_64 &) { return std::make_shared<smart_ai_player_t>(); });
+  tournament_stats_t stats =
+      tournament.run(iterations, std::chrono::high_resolution_clock::now().time_since_epoch().count());
+  std::cout << stats.games_per_second() << " games/sec on " << tournament.get_threads_count() << " threads"
+            << std::endl;
 
+  ASSERT_EQ(stats.games_count, iterations);
+  ASSERT_EQ(stats.wins[sea_battle_t::FIRST_PLAYER], simple_wins_counter);
   ASSERT_GE(iterations - simple_wins_counter, wins_factor * iterations);
 }
+
+TEST(CompetitionTest, StaticPlayers) {
+  static constexpr size_t iterations = 2000;
+  static constexpr uint64_t seed = 2023;
+
+  tournament_t dynamic_tournament([](std::mt19937_64 &) { return std::make_shared<smart_ai_player_t>(); },
+                                  [](std::mt19937_64 &) { return std::make_shared<smart_ai_player_t>(); }, 1);
+  basic_tournament_t<smart_ai_player_t, smart_ai_player_t> static_tournament(
+      [](std::mt19937_64 &) { return smart_ai_player_t(); }, [](std::mt19937_64 &) { return smart_ai_player_t(); },
+      1);
+  tournament_stats_t dynamic_stats = dynamic_tournament.run(iterations, seed);
+  tournament_stats_t static_stats = static_tournament.run(iterations, seed);
+  std::cout << dynamic_stats.games_per_second() << " games/sec with virtual calls, "
+            << static_stats.games_per_second() << " games/sec with static players" << std::endl;
+
+  // players and fields are the same, so are the games
+  ASSERT_EQ(static_stats.games_count, iterations);
+  ASSERT_EQ(static_stats.wins, dynamic_stats.wins);
+  ASSERT_EQ(static_stats.moves_count, dynamic_stats.moves_count);
+}
@@ -1,13 +1,60 @@
 #include "gtest/gtest.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <random>
 #include <thread>
 
+#include "game/bitboard.h"
 #include "game/sea-battle.h"
 #include "testing/mock-player-data.h"
 #include "testing/mock-player.h"
 
 using turn_t = sea_battle_t::turn_t;
 
+// global allocations are counted to check that games don't allocate
+static std::atomic<size_t> allocations_count{0};
+
+void *operator new(size_t size) {
+  ++allocations_count;
+  if (void *result = std::malloc(size == 0 ? 1 : size)) {
+    return result;
+  }
+  throw std::bad_alloc();
+}
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void operator delete(void *ptr) noexcept {
+  std::free(ptr);
+}
+void operator delete(void *ptr, size_t) noexcept {
+  std::free(ptr);
+}
+#pragma GCC diagnostic pop
+
+// shoots cells row by row, without allocations
+class scanning_player_t : public player_interface_t {
+public:
+  std::pair<int, int> make_move(const field_t &, const field_t &) override {
+    int cell = next_cell++;
+    return {cell / field_t::FIELD_SIZE, cell % field_t::FIELD_SIZE};
+  }
+  void on_incorrect_move(int, int) override {}
+  void on_duplicate_move(int, int) override {}
+  void on_miss(int, int) override {}
+  void on_hit(int, int) override {}
+  void on_kill(int, int) override {}
+  void on_win() override {
+    won = true;
+  }
+  void on_lose() override {}
+
+  int next_cell{0};
+  bool won{false};
+};
+
 static void run_test(field_t f1, field_t f2, turn_t winner_turn,
                      std::vector<std::tuple<turn_t, mock_player_data_t::action_t, std::pair<int, int>>> script) {
   auto test_data =
@@ -140,6 +187,91 @@ TEST(GameTest, MultipleShipsTest) {
   run_test(std::move(f1), std::move(f2), turn_t::SECOND_PLAYER, script);
 }
 
+TEST(BitboardTest, ShotsAndViews) {
+  field_t field = {"#..#......", "#..#......", "#.........", "#.........", "..........",
+                   "..........", "..........", "..........", ".........#", "###......#"};
+  bitboard_t board(field);
+  ASSERT_EQ(board.to_field(), field);
+
+  ASSERT_EQ(board.shoot(-1, 0), bitboard_t::INCORRECT);
+  ASSERT_EQ(board.shoot(0, 10), bitboard_t::INCORRECT);
+  ASSERT_EQ(board.shoot(0, 1), bitboard_t::MISS);
+  ASSERT_EQ(board.shoot(0, 1), bitboard_t::DUPLICATE);
+  ASSERT_EQ(board.shoot(9, 9), bitboard_t::HIT);
+  ASSERT_EQ(board.shoot(8, 9), bitboard_t::KILL);
+  // the ship at the end of row 9 doesn't continue at the start of row 10
+  ASSERT_EQ(board.shoot(9, 0), bitboard_t::HIT);
+  ASSERT_EQ(board.shoot(0, 0), bitboard_t::HIT);
+  ASSERT_EQ(board.ship_of(bitboard_t::cell_mask(1, 0)),
+            bitboard_t::cell_mask(0, 0) | bitboard_t::cell_mask(1, 0) | bitboard_t::cell_mask(2, 0) |
+                bitboard_t::cell_mask(3, 0));
+  ASSERT_EQ(board.ship_of(bitboard_t::cell_mask(5, 5)), 0);
+
+  field[0][1] = field_t::MISS_CELL;
+  field[9][9] = field[8][9] = field[9][0] = field[0][0] = field_t::HIT_CELL;
+  ASSERT_EQ(board.to_field(), field);
+  ASSERT_EQ(bitboard_t(field), board);
+  field_t hidden = {"..........", "..........", "..........", "..........", "..........",
+                    "..........", "..........", "..........", "..........", ".........."};
+  hidden[0][1] = field_t::MISS_CELL;
+  hidden[9][9] = hidden[8][9] = hidden[9][0] = hidden[0][0] = field_t::HIT_CELL;
+  ASSERT_EQ(board.to_field(true), hidden);
+
+  ASSERT_EQ(board.shoot(0, 3), bitboard_t::HIT);
+  ASSERT_EQ(board.shoot(1, 3), bitboard_t::KILL);
+  ASSERT_EQ(board.shoot(9, 1), bitboard_t::HIT);
+  ASSERT_EQ(board.shoot(9, 2), bitboard_t::KILL);
+  ASSERT_EQ(board.shoot(1, 0), bitboard_t::HIT);
+  ASSERT_EQ(board.shoot(3, 0), bitboard_t::HIT);
+  ASSERT_TRUE(board.has_ships());
+  ASSERT_EQ(board.shoot(2, 0), bitboard_t::KILL);
+  ASSERT_FALSE(board.has_ships());
+}
+
+// ships of the standard set, which touch only by corners
+static void check_random_field(const field_t &field) {
+  bitboard_t board(field);
+  std::vector<size_t> ships_len;
+  uint128_t ships = board.ships_mask();
+  while (ships != 0) {
+    uint128_t ship = board.ship_of(ships & -ships);
+    ships_len.push_back(bitboard_t::count(ship));
+    ships &= ~ship;
+  }
+  std::sort(ships_len.begin(), ships_len.end());
+  ASSERT_EQ(ships_len, std::vector<size_t>({1, 1, 1, 1, 2, 2, 2, 3, 3, 4})) << field;
+}
+
+TEST(FieldTest, RandomFields) {
+  std::mt19937_64 gen(32);
+  for (uint32_t seed = 0; seed < 1000; ++seed) {
+    check_random_field(field_t(seed));
+    ASSERT_EQ(field_t(seed), field_t(seed));
+    check_random_field(field_t(gen));
+  }
+  std::mt19937_64 gen1(7);
+  std::mt19937_64 gen2(7);
+  ASSERT_EQ(field_t(gen1), field_t(gen2));
+  // layouts of seeds are the same as before the placement by masks
+  ASSERT_EQ(field_t(100), field_t({"#..#......", "...#......", "...#...##.", "..........", "##....##..",
+                                   "..........", "....#.#...", "......#..#", "...#..#..#", "..#...#..#"}));
+}
+
+TEST(GameTest, PlayDoesNotAllocate) {
+  auto first = std::make_shared<scanning_player_t>();
+  auto second = std::make_shared<scanning_player_t>();
+  // the first player hits all ships of the second one before reaching the last row of the first field
+  sea_battle_t game(first, field_t({"..........", "..........", "..........", "..........", "..........",
+                                    "..........", "..........", "..........", "..........", "#.#.#.#..."}),
+                    second, field_t({"#.#.#.#...", "..........", "##.##.##..", "..........", "###.###...",
+                                     "..........", "####......", "..........", "..........", ".........."}));
+  size_t allocations_before = allocations_count;
+  game.play();
+  ASSERT_EQ(allocations_count, allocations_before);
+  ASSERT_TRUE(first->won);
+  ASSERT_FALSE(second->won);
+}
+
 TEST(GameTest, SimpleSimpleTest){
 #include "testing/simple-simple.test"
 }
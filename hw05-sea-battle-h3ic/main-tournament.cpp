@@ -0,0 +1,43 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+
+#include "game/tournament.h"
+#include "players/simple-ai-player.h"
+
+static tournament_t simple_tournament(size_t threads_count, std::atomic<size_t> *wins_counter = nullptr) {
+  const auto factory = [wins_counter](std::mt19937_64 &gen) {
+    return std::make_shared<simple_ai_player_t>(gen(), wins_counter);
+  };
+  return tournament_t(factory, factory, threads_count);
+}
+
+TEST(TournamentTest, Reproducible) {
+  static constexpr size_t games_count = 200;
+  tournament_stats_t stats1 = simple_tournament(3).run(games_count, 31);
+  tournament_stats_t stats2 = simple_tournament(3).run(games_count, 31);
+
+  ASSERT_EQ(stats1.games_count, games_count);
+  ASSERT_EQ(stats1.wins[0] + stats1.wins[1], games_count);
+  ASSERT_EQ(stats1.games_count, stats2.games_count);
+  ASSERT_EQ(stats1.wins, stats2.wins);
+  ASSERT_EQ(stats1.moves_count, stats2.moves_count);
+  // every game needs at least 20 hits of the standard set of ships
+  ASSERT_GE(stats1.moves_per_game(), 20);
+  ASSERT_GT(stats1.games_per_second(), 0);
+
+  tournament_stats_t other_seed_stats = simple_tournament(3).run(games_count, 32);
+  ASSERT_NE(stats1.moves_count, other_seed_stats.moves_count);
+}
+
+TEST(TournamentTest, SharedWinsCounter) {
+  std::atomic<size_t> wins_counter{0};
+  tournament_t tournament = simple_tournament(4, &wins_counter);
+  ASSERT_EQ(tournament.get_threads_count(), 4);
+  tournament_stats_t stats = tournament.run(101, 5);
+  ASSERT_EQ(stats.games_count, 101);
+  ASSERT_EQ(wins_counter, 101);
+
+  // more workers than games
+  ASSERT_EQ(simple_tournament(8).run(3, 5).games_count, 3);
+}
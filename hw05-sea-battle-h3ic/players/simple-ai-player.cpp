@@ -2,11 +2,14 @@
 
 #include <chrono>
 
-simple_ai_player_t::simple_ai_player_t(size_t *wins_counter) : wins_counter(wins_counter) {
+simple_ai_player_t::simple_ai_player_t(std::atomic<size_t> *wins_counter) : wins_counter(wins_counter) {
   std::seed_seq seq = {std::chrono::high_resolution_clock::now().time_since_epoch().count()};
   gen = std::mt19937_64(seq);
 }
 
+simple_ai_player_t::simple_ai_player_t(uint64_t seed, std::atomic<size_t> *wins_counter)
+    : gen(seed), wins_counter(wins_counter) {}
+
 std::pair<int, int> simple_ai_player_t::make_move(const field_t &, const field_t &enemy_field) {
   std::vector<std::pair<int, int>> empty_cells;
   for (int i = 0; i < field_t::FIELD_SIZE; ++i) {
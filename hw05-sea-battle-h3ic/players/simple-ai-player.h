@@ -1,13 +1,18 @@
 #pragma once
 
+#include <atomic>
 #include <cassert>
 #include <random>
 
 #include "player-interface.h"
 
-class simple_ai_player_t : public player_interface_t {
+class simple_ai_player_t final : public player_interface_t {
 public:
-  explicit simple_ai_player_t(size_t *wins_counter = nullptr);
+  /**
+   * @param wins_counter -- counter of wins, which may be shared by players of different threads
+   */
+  explicit simple_ai_player_t(std::atomic<size_t> *wins_counter = nullptr);
+  explicit simple_ai_player_t(uint64_t seed, std::atomic<size_t> *wins_counter = nullptr);
 
   std::pair<int, int> make_move(const field_t &my_field, const field_t &enemy_field) override;
 
@@ -23,12 +28,12 @@ public:
 
   void on_win() override {
     if (wins_counter) {
-      *wins_counter += 1;
+      wins_counter->fetch_add(1, std::memory_order_relaxed);
     }
   }
   void on_lose() override {}
 
 private:
   std::mt19937_64 gen;
-  size_t *wins_counter{nullptr};
+  std::atomic<size_t> *wins_counter{nullptr};
 };
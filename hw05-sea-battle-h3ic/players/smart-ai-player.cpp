@@ -1 +1,193 @@
 #include "players/smart-ai-player.h"
+
+#include <algorithm>
+
+// calls visit(len, start, step) for every ship placement over unknown cells, which covers cell
+template <typename visitor_t>
+static void for_each_placement(int cell, uint128_t unknown, int cells_count, visitor_t visit) {
+  for (int len = 1; len <= 4; ++len) {
+    // ships of one cell have one placement, not one per direction
+    for (int step : {1, static_cast<int>(bitboard_t::STRIDE)}) {
+      for (int offset = 0; offset < len; ++offset) {
+        int start = cell - offset * step;
+        if (start < 0 || start + (len - 1) * step >= cells_count) {
+          continue;
+        }
+        bool fits = true;
+        for (int q = 0; q < len && fits; ++q) {
+          // the extra column is never unknown, so ships don't wrap to other rows
+          fits = (unknown >> (start + q * step)) & 1;
+        }
+        if (fits) {
+          visit(len, start, step);
+        }
+      }
+      if (len == 1) {
+        break;
+      }
+    }
+  }
+}
+
+const smart_ai_player_t::state_t &smart_ai_player_t::initial_state() {
+  static const state_t state = []() {
+    state_t result;
+    result.ships_count = {0, 4, 3, 2, 1};
+    for (int x = 0; x < field_t::FIELD_SIZE; ++x) {
+      for (int y = 0; y < field_t::FIELD_SIZE; ++y) {
+        result.unknown |= bitboard_t::cell_mask(x, y);
+      }
+    }
+    // every placement is counted once by its first cell
+    for (int cell = 0; cell < CELLS_COUNT; ++cell) {
+      for_each_placement(cell, result.unknown, CELLS_COUNT, [&](int len, int start, int step) {
+        if (start != cell) {
+          return;
+        }
+        for (int q = 0; q < len; ++q) {
+          ++result.coverage[len][start + q * step];
+        }
+      });
+    }
+    for (int cell = 0; cell < CELLS_COUNT; ++cell) {
+      for (int len = 1; len <= MAX_SHIP_LEN; ++len) {
+        result.density[cell] += result.ships_count[len] * result.coverage[len][cell];
+      }
+    }
+    return result;
+  }();
+  return state;
+}
+
+smart_ai_player_t::smart_ai_player_t() : state(initial_state()) {}
+
+void smart_ai_player_t::reset() {
+  state = initial_state();
+}
+
+int smart_ai_player_t::first_cell(uint128_t mask) {
+  auto low = static_cast<uint64_t>(mask);
+  return low != 0 ? __builtin_ctzll(low) : 64 + __builtin_ctzll(static_cast<uint64_t>(mask >> 64));
+}
+
+int smart_ai_player_t::last_cell(uint128_t mask) {
+  auto high = static_cast<uint64_t>(mask >> 64);
+  return high != 0 ? 127 - __builtin_clzll(high) : 63 - __builtin_clzll(static_cast<uint64_t>(mask));
+}
+
+void smart_ai_player_t::remove_cell(int cell) {
+  if (!((state.unknown >> cell) & 1)) {
+    return;
+  }
+  for_each_placement(cell, state.unknown, CELLS_COUNT, [this](int len, int start, int step) {
+    for (int q = 0; q < len; ++q) {
+      --state.coverage[len][start + q * step];
+      state.density[start + q * step] -= state.ships_count[len];
+    }
+  });
+  state.unknown &= ~(uint128_t{1} << cell);
+}
+
+void smart_ai_player_t::remove_cells(uint128_t mask) {
+  while (mask != 0) {
+    remove_cell(first_cell(mask));
+    mask &= mask - 1;
+  }
+}
+
+int32_t smart_ai_player_t::target_score(int cell, int step) const {
+  int low = std::min(first_cell(state.wounded), cell);
+  int high = std::max(last_cell(state.wounded), cell);
+  int span = (high - low) / step + 1;
+  uint128_t allowed = state.unknown | state.wounded;
+  int32_t score = 0;
+  for (int len = span; len <= MAX_SHIP_LEN; ++len) {
+    if (state.ships_count[len] == 0) {
+      continue;
+    }
+    for (int start = low - (len - span) * step; start <= low; start += step) {
+      if (start < 0 || start + (len - 1) * step >= CELLS_COUNT) {
+        continue;
+      }
+      bool fits = true;
+      for (int q = 0; q < len && fits; ++q) {
+        fits = (allowed >> (start + q * step)) & 1;
+      }
+      score += fits ? state.ships_count[len] : 0;
+    }
+  }
+  return score;
+}
+
+std::pair<int, int> smart_ai_player_t::make_move(const field_t &, const field_t &) {
+  int best_cell = -1;
+  int32_t best_score = 0;
+  if (state.wounded != 0) {
+    // target: ends of the wounded ship, which are on its line if it has several cells
+    int low = first_cell(state.wounded);
+    int high = last_cell(state.wounded);
+    for (int step : STEPS) {
+      if (low != high && (high - low) % step != 0) {
+        continue;
+      }
+      for (int cell : {low - step, high + step}) {
+        if (cell < 0 || !((state.unknown >> cell) & 1)) {
+          continue;
+        }
+        int32_t score = target_score(cell, step);
+        if (score > best_score) {
+          best_cell = cell;
+          best_score = score;
+        }
+      }
+    }
+  }
+  if (best_cell < 0) {
+    // hunt: the cell covered by most placements
+    for (int cell = 0; cell < CELLS_COUNT; ++cell) {
+      if (state.density[cell] > best_score) {
+        best_cell = cell;
+        best_score = state.density[cell];
+      }
+    }
+  }
+  if (best_cell < 0) {
+    // no placements fit, e.g. ships aren't of the standard set
+    assert(state.unknown != 0);
+    best_cell = first_cell(state.unknown);
+  }
+  return {best_cell / static_cast<int>(bitboard_t::STRIDE), best_cell % static_cast<int>(bitboard_t::STRIDE)};
+}
+
+void smart_ai_player_t::on_miss(int x, int y) {
+  remove_cell(first_cell(bitboard_t::cell_mask(x, y)));
+}
+
+void smart_ai_player_t::on_hit(int x, int y) {
+  uint128_t cell = bitboard_t::cell_mask(x, y);
+  remove_cell(first_cell(cell));
+  state.wounded |= cell;
+  int low = first_cell(state.wounded);
+  int high = last_cell(state.wounded);
+  if (low != high) {
+    // the ship's direction is known, so cells beside it are empty
+    int across = high - low < bitboard_t::STRIDE ? bitboard_t::STRIDE : 1;
+    remove_cells((state.wounded << across | state.wounded >> across) & state.unknown);
+  }
+}
+
+void smart_ai_player_t::on_kill(int x, int y) {
+  uint128_t ship = state.wounded | bitboard_t::cell_mask(x, y);
+  remove_cell(first_cell(bitboard_t::cell_mask(x, y)));
+  state.wounded = 0;
+  size_t len = bitboard_t::count(ship);
+  if (len <= MAX_SHIP_LEN && state.ships_count[len] > 0) {
+    --state.ships_count[len];
+    for (int cell = 0; cell < CELLS_COUNT; ++cell) {
+      state.density[cell] -= state.coverage[len][cell];
+    }
+  }
+  // other ships don't touch the killed one by sides
+  uint128_t around = ship << 1 | ship >> 1 | ship << bitboard_t::STRIDE | ship >> bitboard_t::STRIDE;
+  remove_cells(around & state.unknown);
+}
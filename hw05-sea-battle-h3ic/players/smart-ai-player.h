@@ -1,6 +1,71 @@
 #pragma once
 
+#include <array>
+#include <cassert>
+#include <cstdint>
+
+#include "game/bitboard.h"
 #include "players/player-interface.h"
 
-class smart_ai_player_t : public player_interface_t {
+/**
+ * Hunt/target player. For every cell it keeps the number of placements of remaining enemy ships,
+ * which cover the cell and only unknown cells. Shots remove placements through the shot cell, kills
+ * remove the ship and placements through its neighbours, so make_move only picks the densest cell.
+ * After a hit it shoots next to the wounded ship along possible placements until the ship is killed
+ */
+class smart_ai_player_t final : public player_interface_t {
+public:
+  smart_ai_player_t();
+
+  std::pair<int, int> make_move(const field_t &my_field, const field_t &enemy_field) override;
+
+  void on_incorrect_move(int, int) override {
+    assert(false);
+  }
+  void on_duplicate_move(int, int) override {
+    assert(false);
+  }
+  void on_miss(int x, int y) override;
+  void on_hit(int x, int y) override;
+  void on_kill(int x, int y) override;
+
+  void on_win() override {
+    reset();
+  }
+  void on_lose() override {
+    reset();
+  }
+
+private:
+  static constexpr int MAX_SHIP_LEN = 4;
+  static constexpr int CELLS_COUNT = field_t::FIELD_SIZE * bitboard_t::STRIDE;
+  // steps between cells of horizontal and of vertical ships
+  static constexpr std::array<int, 2> STEPS = {1, static_cast<int>(bitboard_t::STRIDE)};
+
+  struct state_t {
+    // cells, which may contain a not yet found ship
+    uint128_t unknown{0};
+    // hit cells of the ship, which isn't killed yet
+    uint128_t wounded{0};
+    // remaining ships by length
+    std::array<int32_t, MAX_SHIP_LEN + 1> ships_count{};
+    // placements of ships of every length over unknown cells, which cover every cell
+    std::array<std::array<int32_t, CELLS_COUNT>, MAX_SHIP_LEN + 1> coverage{};
+    // sum of coverage weighted by ships_count
+    std::array<int32_t, CELLS_COUNT> density{};
+  };
+
+  static const state_t &initial_state();
+  static int first_cell(uint128_t mask);
+  static int last_cell(uint128_t mask);
+
+  void reset();
+  // the cell becomes known, placements through it are removed
+  void remove_cell(int cell);
+  // remove_cell for every cell of mask
+  void remove_cells(uint128_t mask);
+  // placements of remaining ships, which cover the wounded ship and cell
+  int32_t target_score(int cell, int step) const;
+
+  state_t state;
 };
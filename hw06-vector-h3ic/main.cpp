@@ -2,8 +2,10 @@
 
 #include <array>
 #include <chrono>
+#include <list>
 #include <memory>
 #include <random>
+#include <stdexcept>
 #include <vector>
 
 #include "vector.h"
@@ -140,7 +142,8 @@ bool check_equality(const std::vector<T> &expected, const vector_t<T> &actual, s
       return false;
     }
   }
-  for (size_t i = 0; i < actual.capacity(); ++i) {
+  // slots after size() are raw storage without elements
+  for (size_t i = 0; i < actual.size(); ++i) {
     if (actual.data()[i] != actual[i]) {
       dump_on_error("Compare data and operator[] " + std::to_string(i));
     }
@@ -193,6 +196,107 @@ struct action_factory_t {
   }
 };
 
+// counts alive objects and copies, has no default constructor
+struct tracked_t {
+  static inline int alive = 0;
+  static inline int copies = 0;
+
+  explicit tracked_t(int val) : val(val) { ++alive; }
+  tracked_t(const tracked_t &other) : val(other.val) {
+    ++alive;
+    ++copies;
+  }
+  tracked_t(tracked_t &&other) noexcept : val(other.val) { ++alive; }
+  tracked_t &operator=(const tracked_t &other) = default;
+  tracked_t &operator=(tracked_t &&other) noexcept = default;
+  ~tracked_t() { --alive; }
+
+  friend bool operator==(const tracked_t &a, const tracked_t &b) { return a.val == b.val; }
+  friend bool operator<(const tracked_t &a, const tracked_t &b) { return a.val < b.val; }
+
+  int val;
+};
+
+TEST(Vector, ConstructsOnlyElements) {
+  tracked_t::alive = 0;
+  {
+    vector_t<tracked_t> v(3, tracked_t(1));
+    ASSERT_EQ(v.capacity(), 4);
+    ASSERT_EQ(tracked_t::alive, 3);
+
+    tracked_t::copies = 0;
+    for (int i = 0; i < 100; ++i) {
+      tracked_t val(i);
+      v.push_back(val);
+    }
+    // reallocations move elements with noexcept move constructor
+    ASSERT_EQ(tracked_t::copies, 100);
+    ASSERT_EQ(tracked_t::alive, 103);
+
+    v.insert(0, 10, v[50]);
+    ASSERT_EQ(tracked_t::alive, 113);
+    ASSERT_EQ(v[0].val, 47);
+    ASSERT_EQ(v[60].val, 47);
+
+    v.erase(5, 105);
+    ASSERT_EQ(tracked_t::alive, 13);
+    v.resize(2, tracked_t(0));
+    ASSERT_EQ(tracked_t::alive, 2);
+    v.shrink_to_fit();
+    ASSERT_EQ(v.capacity(), 2);
+    ASSERT_EQ(tracked_t::alive, 2);
+  }
+  ASSERT_EQ(tracked_t::alive, 0);
+}
+
+// tracked_t, whose copy constructor and assignment throw once copies_left copies are made
+struct throwing_t : tracked_t {
+  static inline int copies_left = 0;
+
+  explicit throwing_t(int val) : tracked_t(val) {}
+  throwing_t(const throwing_t &other) : tracked_t(check_copy(other)) {}
+  throwing_t &operator=(const throwing_t &other) {
+    tracked_t::operator=(check_copy(other));
+    return *this;
+  }
+
+  static const throwing_t &check_copy(const throwing_t &other) {
+    if (copies_left-- == 0) {
+      throw std::runtime_error("copy");
+    }
+    return other;
+  }
+};
+
+TEST(Vector, ThrowingCopy) {
+  tracked_t::alive = 0;
+  {
+    throwing_t val(1);
+    throwing_t::copies_left = 5;
+    ASSERT_THROW((vector_t<throwing_t>(10, val)), std::runtime_error);
+    ASSERT_EQ(tracked_t::alive, 1);
+
+    throwing_t::copies_left = 10;
+    vector_t<throwing_t> v(10, val);
+    throwing_t::copies_left = 3;
+    ASSERT_THROW(vector_t<throwing_t> copy(v), std::runtime_error);
+    ASSERT_EQ(tracked_t::alive, 11);
+
+    // inserts in place, throws while the old tail is moved and while inserted copies are assigned
+    v.reserve(16);
+    throwing_t::copies_left = 4;
+    ASSERT_THROW(v.insert(8, 5, v[0]), std::runtime_error);
+    ASSERT_EQ(tracked_t::alive, v.size() + 1);
+    throwing_t::copies_left = 4;
+    ASSERT_THROW(v.insert(2, 3, v[0]), std::runtime_error);
+    ASSERT_EQ(tracked_t::alive, v.size() + 1);
+    throwing_t::copies_left = 1;
+    ASSERT_THROW(v.insert(9, 1, v[0]), std::runtime_error);
+    ASSERT_EQ(tracked_t::alive, v.size() + 1);
+  }
+  ASSERT_EQ(tracked_t::alive, 0);
+}
+
 TEST(Vector, DefaultConstructor) {
   vector_t<int> v;
 
@@ -999,3 +1103,303 @@ TEST(Vector, PopBackStress) {
     v.pop_back();
   }
 }
+
+// std::allocator, which counts allocations of all its instances
+template <typename T>
+struct counting_allocator_t : std::allocator<T> {
+  static inline size_t allocations = 0;
+
+  template <typename U>
+  struct rebind {
+    using other = counting_allocator_t<U>;
+  };
+
+  T *allocate(size_t n) {
+    ++allocations;
+    return std::allocator<T>::allocate(n);
+  }
+};
+
+template <typename T, size_t N>
+using counted_small_vector_t = small_vector_t<T, N, counting_allocator_t<T>>;
+
+template <typename T, size_t N>
+static bool is_inline(const small_vector_t<T, N, counting_allocator_t<T>> &v) {
+  const auto *begin = reinterpret_cast<const char *>(&v);
+  const auto *data = reinterpret_cast<const char *>(v.data());
+  return begin <= data && data < begin + sizeof(v);
+}
+
+TEST(SmallVector, Inline) {
+  counting_allocator_t<std::string>::allocations = 0;
+  counted_small_vector_t<std::string, 8> v;
+  ASSERT_EQ(v.capacity(), 8);
+  ASSERT_TRUE(v.empty());
+  ASSERT_TRUE(is_inline(v));
+
+  for (size_t i = 0; i < 7; ++i) {
+    v.push_back(std::to_string(i));
+  }
+  v.insert(3, "x");
+  v.erase(0);
+  v.resize(8);
+  counted_small_vector_t<std::string, 8> copy(v);
+  copy = v;
+  ASSERT_EQ(copy, v);
+  copy.back() = "y";
+  ASSERT_LT(v, copy);
+  ASSERT_EQ(counting_allocator_t<std::string>::allocations, 0);
+  ASSERT_TRUE(is_inline(v));
+  ASSERT_EQ(v.size(), 8);
+  ASSERT_EQ(v[0], "1");
+  ASSERT_EQ(v[2], "x");
+  ASSERT_EQ(v.back(), "");
+
+  counted_small_vector_t<int, 4> filled(3, 7);
+  ASSERT_EQ(filled.capacity(), 4);
+  ASSERT_TRUE(is_inline(filled));
+  ASSERT_EQ(counting_allocator_t<int>::allocations, 0);
+}
+
+TEST(SmallVector, Spill) {
+  counting_allocator_t<int>::allocations = 0;
+  counted_small_vector_t<int, 3> v;
+  for (int i = 0; i < 3; ++i) {
+    v.push_back(i);
+  }
+  ASSERT_EQ(counting_allocator_t<int>::allocations, 0);
+
+  v.push_back(3);
+  ASSERT_EQ(counting_allocator_t<int>::allocations, 1);
+  ASSERT_FALSE(is_inline(v));
+  ASSERT_EQ(v.capacity(), 4);
+  v.insert(0, 5, 10);
+  ASSERT_EQ(v.capacity(), 16);
+
+  // elements return inside when they fit
+  v.erase(0, 7);
+  v.shrink_to_fit();
+  ASSERT_TRUE(is_inline(v));
+  ASSERT_EQ(v.capacity(), 3);
+  ASSERT_EQ(v.size(), 2);
+  ASSERT_EQ(v[0], 2);
+  ASSERT_EQ(v[1], 3);
+
+  v.reserve(5);
+  ASSERT_EQ(v.capacity(), 8);
+  v.clear();
+  ASSERT_TRUE(is_inline(v));
+  ASSERT_EQ(v.capacity(), 3);
+}
+
+TEST(SmallVector, Swap) {
+  using vector_t = counted_small_vector_t<std::string, 4>;
+  const auto make = [](size_t size, const std::string &val) { return vector_t(size, val); };
+
+  for (size_t size_a : {0, 1, 3, 4, 5, 20}) {
+    for (size_t size_b : {0, 2, 4, 9}) {
+      vector_t a = make(size_a, "a");
+      vector_t b = make(size_b, "b");
+      const std::string *heap_data = size_a > 4 ? a.data() : nullptr;
+      a.swap(b);
+      ASSERT_EQ(a, make(size_b, "b"));
+      ASSERT_EQ(b, make(size_a, "a"));
+      ASSERT_EQ(a.capacity(), size_b > 4 ? 16 : 4);
+      ASSERT_EQ(b.capacity(), size_a > 4 ? size_a > 8 ? 32 : 8 : 4);
+      if (heap_data != nullptr) {
+        ASSERT_EQ(b.data(), heap_data);
+      }
+    }
+  }
+}
+
+TEST(SmallVector, ChangesRandom) {
+  static constexpr size_t iterations = 10'000;
+  std::vector<std::string> expected;
+  small_vector_t<std::string, 6> actual;
+
+  for (size_t i = 0; i < iterations; ++i) {
+    size_t pos = rnd<size_t>(0, expected.size());
+    std::string val = rnd_str();
+    switch (expected.size() < 3 ? 0 : expected.size() > 20 ? 1 : rnd<size_t>(0, 1)) {
+    case 0:
+      expected.insert(expected.begin() + pos, val);
+      actual.insert(pos, val);
+      break;
+    default:
+      pos = std::min(pos, expected.size() - 1);
+      expected.erase(expected.begin() + pos);
+      actual.erase(pos);
+      break;
+    }
+    if (rnd_bool(0.1)) {
+      actual.shrink_to_fit();
+    }
+    small_vector_t<std::string, 6> copy(actual);
+    ASSERT_EQ(actual.size(), expected.size());
+    ASSERT_TRUE(std::equal(expected.begin(), expected.end(), copy.data()));
+  }
+}
+
+// owns a heap object, so it may be relocated by bytes
+struct boxed_t {
+  explicit boxed_t(int val) : ptr(std::make_unique<int>(val)) {}
+
+  std::unique_ptr<int> ptr;
+};
+
+template <>
+struct is_trivially_relocatable_t<boxed_t> : std::true_type {};
+
+template <typename Vector>
+static std::vector<int> unbox(const Vector &v) {
+  std::vector<int> res;
+  for (size_t i = 0; i < v.size(); ++i) {
+    res.push_back(*v[i].ptr);
+  }
+  return res;
+}
+
+TEST(Vector, MoveConstructorAndAssignment) {
+  vector_t<std::string> v(10, "abacaba");
+  const std::string *data = v.data();
+
+  vector_t<std::string> moved(std::move(v));
+  ASSERT_EQ(moved.data(), data);
+  ASSERT_EQ(moved.size(), 10);
+  ASSERT_EQ(moved.capacity(), 16);
+  ASSERT_EQ(v.size(), 0);
+  ASSERT_EQ(v.capacity(), 0);
+  ASSERT_EQ(v.data(), nullptr);
+
+  vector_t<std::string> assigned(3, "x");
+  assigned = std::move(moved);
+  ASSERT_EQ(assigned.data(), data);
+  ASSERT_EQ(assigned, vector_t<std::string>(10, "abacaba"));
+  ASSERT_TRUE(moved.empty());
+
+  small_vector_t<std::string, 4> small(3, "y");
+  small_vector_t<std::string, 4> small_moved(std::move(small));
+  ASSERT_EQ(small_moved, (small_vector_t<std::string, 4>(3, "y")));
+  ASSERT_TRUE(small.empty());
+  ASSERT_EQ(small.capacity(), 4);
+
+  static_assert(std::is_nothrow_move_constructible_v<vector_t<std::string>>);
+  static_assert(std::is_nothrow_move_assignable_v<vector_t<std::string>>);
+}
+
+TEST(Vector, Emplace) {
+  vector_t<std::string> v;
+  ASSERT_EQ(v.emplace_back(3, 'a'), "aaa");
+  v.emplace_back("b");
+  // the argument is an element, which is moved by reallocation
+  v.emplace_back(v[0]);
+  ASSERT_EQ(v.capacity(), 4);
+  v.emplace_back(v[1]);
+  ASSERT_EQ(v.emplace(0, 2, 'c'), "cc");
+  ASSERT_EQ(v.emplace(2, v[0]), "cc");
+  ASSERT_EQ(v.emplace(v.size(), "d"), "d");
+
+  std::vector<std::string> expected = {"cc", "aaa", "cc", "b", "aaa", "b", "d"};
+  ASSERT_TRUE(std::equal(expected.begin(), expected.end(), v.data()));
+  ASSERT_EQ(v.size(), expected.size());
+}
+
+// the inserted element goes into the gap, nothing is constructed past the old end
+TEST(Vector, EmplaceBeforeLast) {
+  std::string long_string(100, 'x');
+  vector_t<std::string> v;
+  v.reserve(4);
+  v.push_back("first");
+  v.push_back("last");
+  ASSERT_EQ(v.emplace(1, long_string), long_string);
+  v.insert(2, std::string(long_string));
+  std::vector<std::string> expected = {"first", long_string, long_string, "last"};
+  ASSERT_TRUE(std::equal(expected.begin(), expected.end(), v.data()));
+  ASSERT_EQ(v.size(), expected.size());
+
+  small_vector_t<std::unique_ptr<int>, 4> small;
+  small.push_back(std::make_unique<int>(1));
+  small.push_back(std::make_unique<int>(3));
+  small.emplace(1, std::make_unique<int>(2));
+  ASSERT_EQ(small.size(), 3);
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(small[i]);
+    ASSERT_EQ(*small[i], i + 1);
+  }
+}
+
+TEST(Vector, RangeInsert) {
+  vector_t<int> v;
+  std::vector<int> expected;
+  for (size_t i = 0; i < 100; ++i) {
+    std::vector<int> values(rnd<size_t>(0, 10));
+    for (int &value : values) {
+      value = rnd<int>();
+    }
+    size_t pos = rnd<size_t>(0, expected.size());
+    expected.insert(expected.begin() + pos, values.begin(), values.end());
+    v.insert(pos, values.begin(), values.end());
+    ASSERT_EQ(v.size(), expected.size());
+    ASSERT_TRUE(std::equal(expected.begin(), expected.end(), v.data()));
+  }
+
+  // input iterators are read once
+  std::istringstream input("1 2 3");
+  vector_t<std::string> strings(2, "x");
+  strings.insert(1, std::istream_iterator<std::string>(input), std::istream_iterator<std::string>());
+  std::list<std::string> list = {"y", "z"};
+  strings.insert(0, list.begin(), list.end());
+  std::vector<std::string> expected_strings = {"y", "z", "x", "1", "2", "3", "x"};
+  ASSERT_TRUE(std::equal(expected_strings.begin(), expected_strings.end(), strings.data()));
+  ASSERT_EQ(strings.size(), expected_strings.size());
+}
+
+TEST(Vector, MoveOnly) {
+  vector_t<std::unique_ptr<int>> v;
+  for (int i = 0; i < 20; ++i) {
+    v.push_back(std::make_unique<int>(i));
+  }
+  v.emplace(3, std::make_unique<int>(100));
+  v.insert(0, std::make_unique<int>(200));
+  v.erase(5, 10);
+  vector_t<std::unique_ptr<int>> moved = std::move(v);
+  ASSERT_EQ(moved.size(), 17);
+  ASSERT_EQ(*moved[0], 200);
+  ASSERT_EQ(*moved[4], 100);
+  ASSERT_EQ(*moved[5], 8);
+  moved.shrink_to_fit();
+  ASSERT_EQ(*moved.back(), 19);
+}
+
+TEST(Vector, TriviallyRelocatable) {
+  static_assert(is_trivially_relocatable_v<int>);
+  static_assert(!is_trivially_relocatable_v<std::string>);
+
+  vector_t<boxed_t> v;
+  std::vector<int> expected;
+  for (int i = 0; i < 100; ++i) {
+    size_t pos = rnd<size_t>(0, expected.size());
+    if (expected.empty() || rnd_bool(0.7)) {
+      v.emplace(pos, i);
+      expected.insert(expected.begin() + pos, i);
+    } else {
+      pos = std::min(pos, expected.size() - 1);
+      v.erase(pos);
+      expected.erase(expected.begin() + pos);
+    }
+    ASSERT_EQ(unbox(v), expected);
+  }
+  v.shrink_to_fit();
+  ASSERT_EQ(unbox(v), expected);
+
+  small_vector_t<boxed_t, 4> a;
+  small_vector_t<boxed_t, 4> b;
+  a.emplace_back(1);
+  for (int i = 0; i < 6; ++i) {
+    b.emplace_back(i);
+  }
+  a.swap(b);
+  ASSERT_EQ(unbox(a), (std::vector<int>{0, 1, 2, 3, 4, 5}));
+  ASSERT_EQ(unbox(b), std::vector<int>{1});
+}
@@ -0,0 +1,224 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "vector.h"
+
+// counts every allocation, both of the vectors and of the elements they copy
+static std::atomic<size_t> allocations_count{0};
+
+void *operator new(size_t size) {
+  ++allocations_count;
+  if (void *result = std::malloc(size == 0 ? 1 : size)) {
+    return result;
+  }
+  throw std::bad_alloc();
+}
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void operator delete(void *ptr) noexcept {
+  std::free(ptr);
+}
+void operator delete(void *ptr, size_t) noexcept {
+  std::free(ptr);
+}
+#pragma GCC diagnostic pop
+
+template <typename T>
+using std_vector_t = std::vector<T>;
+template <typename T>
+using our_vector_t = vector_t<T>;
+
+using trivial_t = size_t;
+using move_only_t = std::unique_ptr<size_t>;
+
+// copying it allocates, too long for the small string buffer
+struct heavy_t {
+  explicit heavy_t(size_t key) : name(40, 'a' + key % 26), key(key) {}
+
+  std::string name;
+  size_t key;
+  std::array<char, 64> payload{};
+};
+
+template <typename T>
+static T make_value(size_t i) {
+  if constexpr (std::is_same_v<T, move_only_t>) {
+    return std::make_unique<size_t>(i);
+  } else {
+    return T(i);
+  }
+}
+
+template <typename T>
+static size_t value_of(const T &value) {
+  if constexpr (std::is_same_v<T, trivial_t>) {
+    return value;
+  } else if constexpr (std::is_same_v<T, move_only_t>) {
+    return *value;
+  } else {
+    return value.key;
+  }
+}
+
+// the two vectors name positions differently
+template <typename T>
+static void insert_at(std::vector<T> &v, size_t pos, T value) {
+  v.insert(v.begin() + pos, std::move(value));
+}
+template <typename T>
+static void insert_at(vector_t<T> &v, size_t pos, T value) {
+  v.insert(pos, std::move(value));
+}
+template <typename T>
+static void erase_at(std::vector<T> &v, size_t pos) {
+  v.erase(v.begin() + pos);
+}
+template <typename T>
+static void erase_at(vector_t<T> &v, size_t pos) {
+  v.erase(pos);
+}
+
+template <typename Vector>
+static Vector make_vector(size_t size) {
+  Vector v;
+  v.reserve(size);
+  for (size_t i = 0; i < size; ++i) {
+    v.push_back(make_value<typename Vector::value_type>(i));
+  }
+  return v;
+}
+
+template <typename Vector>
+static void push_back(benchmark::State &state, bool reserve) {
+  using T = typename Vector::value_type;
+  size_t size = state.range(0);
+  allocations_count = 0;
+  for (auto _ : state) {
+    Vector v;
+    if (reserve) {
+      v.reserve(size);
+    }
+    for (size_t i = 0; i < size; ++i) {
+      v.push_back(make_value<T>(i));
+    }
+    benchmark::DoNotOptimize(v.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * size);
+  state.counters["allocs_per_op"] =
+      static_cast<double>(allocations_count) / (state.iterations() * size);
+}
+
+template <typename Vector>
+static void BM_push_back(benchmark::State &state) {
+  push_back<Vector>(state, false);
+}
+
+template <typename Vector>
+static void BM_push_back_reserved(benchmark::State &state) {
+  push_back<Vector>(state, true);
+}
+
+// the size stays the same, an insert and an erase at random positions are two operations
+template <typename Vector>
+static void BM_insert_erase(benchmark::State &state) {
+  using T = typename Vector::value_type;
+  size_t size = state.range(0);
+  Vector v = make_vector<Vector>(size);
+  std::mt19937_64 gen(size);
+  allocations_count = 0;
+  for (auto _ : state) {
+    insert_at(v, gen() % (size + 1), make_value<T>(size));
+    erase_at(v, gen() % (size + 1));
+  }
+  benchmark::DoNotOptimize(v.data());
+  state.SetItemsProcessed(state.iterations() * 2);
+  state.counters["allocs_per_op"] =
+      static_cast<double>(allocations_count) / (state.iterations() * 2);
+}
+
+template <typename Vector>
+static void BM_copy(benchmark::State &state) {
+  size_t size = state.range(0);
+  Vector v = make_vector<Vector>(size);
+  allocations_count = 0;
+  for (auto _ : state) {
+    Vector copy(v);
+    benchmark::DoNotOptimize(copy.data());
+  }
+  state.SetItemsProcessed(state.iterations() * size);
+  state.counters["allocs_per_op"] = static_cast<double>(allocations_count) / state.iterations();
+}
+
+template <typename Vector>
+static void BM_swap(benchmark::State &state) {
+  size_t size = state.range(0);
+  Vector a = make_vector<Vector>(size);
+  Vector b = make_vector<Vector>(size / 2);
+  allocations_count = 0;
+  for (auto _ : state) {
+    a.swap(b);
+    benchmark::DoNotOptimize(a.data());
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["allocs_per_op"] = static_cast<double>(allocations_count) / state.iterations();
+}
+
+template <typename Vector>
+static void BM_iterate(benchmark::State &state) {
+  size_t size = state.range(0);
+  const Vector v = make_vector<Vector>(size);
+  for (auto _ : state) {
+    size_t sum = 0;
+    for (size_t i = 0; i < v.size(); ++i) {
+      sum += value_of(v[i]);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * size);
+}
+
+// sizes 1, 10, ..., max_size
+template <int64_t max_size>
+static void sizes(benchmark::internal::Benchmark *benchmark) {
+  benchmark->ArgName("size");
+  for (int64_t size = 1; size <= max_size; size *= 10) {
+    benchmark->Arg(size);
+  }
+}
+
+// the same benchmark for std::vector and vector_t side by side
+#define BENCHMARK_VECTORS(name, type, max_size)                                                                        \
+  BENCHMARK_TEMPLATE(name, std_vector_t<type>)->Apply(sizes<max_size>);                                               \
+  BENCHMARK_TEMPLATE(name, our_vector_t<type>)->Apply(sizes<max_size>)
+
+// heavy and move-only elements own heap memory, so their vectors are limited by 1e7 and 1e6 elements,
+// insert and erase move all the tail, so they are limited by 1e6 elements
+BENCHMARK_VECTORS(BM_push_back, trivial_t, 100'000'000);
+BENCHMARK_VECTORS(BM_push_back, move_only_t, 10'000'000);
+BENCHMARK_VECTORS(BM_push_back, heavy_t, 1'000'000);
+BENCHMARK_VECTORS(BM_push_back_reserved, trivial_t, 100'000'000);
+BENCHMARK_VECTORS(BM_push_back_reserved, move_only_t, 10'000'000);
+BENCHMARK_VECTORS(BM_push_back_reserved, heavy_t, 1'000'000);
+BENCHMARK_VECTORS(BM_insert_erase, trivial_t, 1'000'000);
+BENCHMARK_VECTORS(BM_insert_erase, move_only_t, 1'000'000);
+BENCHMARK_VECTORS(BM_insert_erase, heavy_t, 1'000'000);
+BENCHMARK_VECTORS(BM_copy, trivial_t, 100'000'000);
+BENCHMARK_VECTORS(BM_copy, heavy_t, 1'000'000);
+BENCHMARK_VECTORS(BM_swap, trivial_t, 100'000'000);
+BENCHMARK_VECTORS(BM_swap, move_only_t, 10'000'000);
+BENCHMARK_VECTORS(BM_swap, heavy_t, 1'000'000);
+BENCHMARK_VECTORS(BM_iterate, trivial_t, 100'000'000);
+BENCHMARK_VECTORS(BM_iterate, move_only_t, 10'000'000);
+BENCHMARK_VECTORS(BM_iterate, heavy_t, 1'000'000);
+
+BENCHMARK_MAIN();
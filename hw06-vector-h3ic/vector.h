@@ -1,32 +1,131 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * True if moving an object to other memory and forgetting the old one is the same as copying its bytes.
+ * It holds for trivially copyable types, other types may opt in by a specialization, e.g. types,
+ * which own a heap pointer, but not std::string of libstdc++, which points into itself
+ */
+template <class T>
+struct is_trivially_relocatable_t : std::is_trivially_copyable<T> {};
+
+template <class T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable_t<T>::value;
+
+// raw storage for elements kept inside the vector, it is an empty base without inline capacity
+template <class T, size_t InlineCapacity>
+struct vector_inline_buffer_t {
+  T *inline_data() { return reinterpret_cast<T *>(buffer); }
+
+  alignas(T) unsigned char buffer[InlineCapacity * sizeof(T)];
+};
+
 template <class T>
-class vector_t {
+struct vector_inline_buffer_t<T, 0> {
+  T *inline_data() { return nullptr; }
+};
+
+/**
+ * Self-expanding array. Capacity is always zero or a power of two, storage is raw memory of the allocator,
+ * so only the first size() slots hold constructed elements.
+ * With InlineCapacity the first InlineCapacity elements are kept inside the vector, capacity is
+ * InlineCapacity until they don't fit and the vector spills to the heap, see small_vector_t.
+ * Elements of trivially relocatable types are moved by memcpy and memmove
+ */
+template <class T, class Allocator = std::allocator<T>, size_t InlineCapacity = 0>
+class vector_t : private vector_inline_buffer_t<T, InlineCapacity> {
 public:
+  using value_type = T;
+  using allocator_type = Allocator;
+
   vector_t() = default;
-  explicit vector_t(size_t elem_num, const T & = T()) {
-    if (elem_num == 0) {
-      capacity_ = 0;
-      arr_ = nullptr;
-      pos_ = 0;
-    } else {
-      int power = 1;
-      while (power < elem_num) {
-        power *= 2;
-      }
-      capacity_ = power;
-      pos_ = 0;
-      arr_ = new T[capacity_];
+  explicit vector_t(size_t elem_num, const T &val = T()) {
+    if (elem_num > capacity_) {
+      arr_ = allocate(storage_capacity(elem_num));
+      capacity_ = storage_capacity(elem_num);
+    }
+    try {
+      std::uninitialized_fill_n(arr_, elem_num, val);
+    } catch (...) {
+      // the destructor doesn't run for a throwing constructor
+      deallocate(arr_, capacity_);
+      throw;
     }
+    pos_ = elem_num;
   };
 
+  /**
+   * Exchanges contents without copies, inline elements are moved if any of vectors keeps them
+   */
   void swap(vector_t &other) {
-    std::swap(pos_, other.pos_);
-    std::swap(pos_, other.pos_);
-    std::swap(pos_, other.pos_);
+    std::swap(allocator_, other.allocator_);
+    if (!is_inline() && !other.is_inline()) {
+      std::swap(capacity_, other.capacity_);
+      std::swap(arr_, other.arr_);
+      std::swap(pos_, other.pos_);
+    } else if (is_inline() && other.is_inline()) {
+      vector_t &longer = pos_ >= other.pos_ ? *this : other;
+      vector_t &shorter = pos_ >= other.pos_ ? other : *this;
+      std::swap_ranges(shorter.arr_, shorter.arr_ + shorter.pos_, longer.arr_);
+      relocate(longer.arr_ + shorter.pos_, longer.arr_ + longer.pos_, shorter.arr_ + shorter.pos_);
+      destroy_relocated(longer.arr_ + shorter.pos_, longer.arr_ + longer.pos_);
+      std::swap(pos_, other.pos_);
+    } else {
+      vector_t &inline_vector = is_inline() ? *this : other;
+      vector_t &heap_vector = is_inline() ? other : *this;
+      T *heap_arr = heap_vector.arr_;
+      heap_vector.arr_ = heap_vector.inline_data();
+      relocate(inline_vector.arr_, inline_vector.arr_ + inline_vector.pos_, heap_vector.arr_);
+      destroy_relocated(inline_vector.arr_, inline_vector.arr_ + inline_vector.pos_);
+      inline_vector.arr_ = heap_arr;
+      std::swap(capacity_, other.capacity_);
+      std::swap(pos_, other.pos_);
+    }
   }
 
-  vector_t(const vector_t &other) : pos_{other.pos_} {};
+  vector_t(const vector_t &other) : allocator_{other.allocator_} {
+    if (other.pos_ > capacity_) {
+      arr_ = allocate(storage_capacity(other.pos_));
+      capacity_ = storage_capacity(other.pos_);
+    }
+    if constexpr (std::is_trivially_copyable_v<T>) {
+      copy_bytes(other.arr_, other.pos_, arr_);
+    } else {
+      try {
+        std::uninitialized_copy(other.arr_, other.arr_ + other.pos_, arr_);
+      } catch (...) {
+        deallocate(arr_, capacity_);
+        throw;
+      }
+    }
+    pos_ = other.pos_;
+  };
+
+  /**
+   * Takes the storage of other, only inline elements are moved one by one, other becomes empty
+   */
+  vector_t(vector_t &&other) noexcept(InlineCapacity == 0 || std::is_nothrow_move_constructible_v<T>)
+      : allocator_{std::move(other.allocator_)} {
+    if (other.is_inline()) {
+      relocate(other.arr_, other.arr_ + other.pos_, arr_);
+      destroy_relocated(other.arr_, other.arr_ + other.pos_);
+    } else {
+      capacity_ = other.capacity_;
+      arr_ = other.arr_;
+      other.capacity_ = InlineCapacity;
+      other.arr_ = other.inline_data();
+    }
+    pos_ = other.pos_;
+    other.pos_ = 0;
+  }
 
   vector_t &operator=(const vector_t &other) {
     vector_t tmp(other);
@@ -34,22 +133,365 @@ public:
     return *this;
   }
 
-  ~vector_t() = default;
+  vector_t &operator=(vector_t &&other) noexcept(InlineCapacity == 0 || std::is_nothrow_move_constructible_v<T>) {
+    vector_t tmp(std::move(other));
+    swap(tmp);
+    return *this;
+  }
+
+  ~vector_t() { clear(); }
 
-  T &operator[](size_t index) const { return arr_[index]; }
+  const T &operator[](size_t index) const { return arr_[index]; }
   T &operator[](size_t index) { return arr_[index]; }
-  T &front() const { return arr_[0]; }
+  const T &front() const { return arr_[0]; }
   T &front() { return arr_[0]; }
-  T &back() const { return arr_[pos_ - 1]; }
+  const T &back() const { return arr_[pos_ - 1]; }
   T &back() { return arr_[pos_ - 1]; }
-  T *data() const { return arr_; }
+  const T *data() const { return arr_; }
   T *data() { return arr_; }
-  bool empty() const { return (arr_ == nullptr); }
+  bool empty() const { return pos_ == 0; }
   size_t size() const { return pos_; }
   size_t capacity() const { return capacity_; }
 
+  void reserve(size_t new_cap) {
+    if (new_cap > capacity_) {
+      reallocate(storage_capacity(new_cap));
+    }
+  }
+
+  /**
+   * Shrinks capacity to the smallest power of two for size(), elements return inside the vector if they fit
+   */
+  void shrink_to_fit() {
+    if (storage_capacity(pos_) < capacity_) {
+      reallocate(storage_capacity(pos_));
+    }
+  }
+
+  void clear() {
+    std::destroy(arr_, arr_ + pos_);
+    deallocate(arr_, capacity_);
+    capacity_ = InlineCapacity;
+    arr_ = inline_data();
+    pos_ = 0;
+  }
+
+  void insert(size_t pos, const T &val) { insert(pos, 1, val); }
+  void insert(size_t pos, T &&val) { emplace(pos, std::move(val)); }
+
+  /**
+   * Inserts count copies of val before pos, val may be an element of the vector
+   */
+  void insert(size_t pos, size_t count, const T &val) {
+    if (count == 0) {
+      return;
+    }
+    if (pos_ + count > capacity_) {
+      reallocate_insert(pos, count, [&val](T *dest, size_t, size_t n) { std::uninitialized_fill_n(dest, n, val); });
+      return;
+    }
+    T copy(val);
+    insert_in_place(
+        pos, count, [&copy](T *dest, size_t, size_t n) { std::fill_n(dest, n, copy); },
+        [&copy](T *dest, size_t, size_t n) { std::uninitialized_fill_n(dest, n, copy); });
+  }
+
+  /**
+   * Inserts elements of [first, last) before pos, they must not be elements of the vector
+   */
+  template <class InputIt, class = typename std::iterator_traits<InputIt>::iterator_category>
+  void insert(size_t pos, InputIt first, InputIt last) {
+    using category_t = typename std::iterator_traits<InputIt>::iterator_category;
+    if constexpr (!std::is_base_of_v<std::forward_iterator_tag, category_t>) {
+      // elements can be read only once, so they are counted in a temporary vector
+      vector_t tmp;
+      for (; first != last; ++first) {
+        tmp.emplace_back(*first);
+      }
+      insert(pos, std::make_move_iterator(tmp.data()), std::make_move_iterator(tmp.data() + tmp.size()));
+    } else {
+      size_t count = std::distance(first, last);
+      if (count == 0) {
+        return;
+      }
+      // i-th inserted element is *std::next(first, i)
+      const auto construct = [first](T *dest, size_t from, size_t n) {
+        auto begin = std::next(first, from);
+        std::uninitialized_copy(begin, std::next(begin, n), dest);
+      };
+      if (pos_ + count > capacity_) {
+        reallocate_insert(pos, count, construct);
+        return;
+      }
+      insert_in_place(
+          pos, count,
+          [first](T *dest, size_t from, size_t n) {
+            auto begin = std::next(first, from);
+            std::copy(begin, std::next(begin, n), dest);
+          },
+          construct);
+    }
+  }
+
+  /**
+   * Inserts an element constructed from args before pos
+   * @return the inserted element
+   */
+  template <class... Args>
+  T &emplace(size_t pos, Args &&...args) {
+    if (pos == pos_) {
+      return emplace_back(std::forward<Args>(args)...);
+    }
+    // args may refer to elements, which are shifted
+    T tmp(std::forward<Args>(args)...);
+    if (pos_ == capacity_) {
+      reallocate_insert(pos, 1, [&tmp](T *dest, size_t, size_t) { new (dest) T(std::move(tmp)); });
+    } else {
+      // the element goes either into the old end or into the gap, the other part is empty
+      insert_in_place(
+          pos, 1,
+          [&tmp](T *dest, size_t, size_t n) {
+            if (n == 1) {
+              *dest = std::move(tmp);
+            }
+          },
+          [&tmp](T *dest, size_t, size_t n) {
+            if (n == 1) {
+              new (dest) T(std::move(tmp));
+            }
+          });
+    }
+    return arr_[pos];
+  }
+
+  void erase(size_t pos) { erase(pos, pos + 1); }
+
+  /**
+   * Erases elements in [first, last), capacity isn't changed
+   */
+  void erase(size_t first, size_t last) {
+    if (first == last) {
+      return;
+    }
+    if constexpr (is_trivially_relocatable_v<T>) {
+      std::destroy(arr_ + first, arr_ + last);
+      move_bytes(arr_ + last, pos_ - last, arr_ + first);
+    } else {
+      std::move(arr_ + last, arr_ + pos_, arr_ + first);
+      std::destroy(arr_ + pos_ - (last - first), arr_ + pos_);
+    }
+    pos_ -= last - first;
+  }
+
+  void push_back(const T &val) { emplace_back(val); }
+  void push_back(T &&val) { emplace_back(std::move(val)); }
+
+  /**
+   * Appends an element constructed from args, which may refer to elements of the vector
+   * @return the appended element
+   */
+  template <class... Args>
+  T &emplace_back(Args &&...args) {
+    if (pos_ == capacity_) {
+      reallocate_insert(pos_, 1, [&args...](T *dest, size_t, size_t) { new (dest) T(std::forward<Args>(args)...); });
+    } else {
+      new (arr_ + pos_) T(std::forward<Args>(args)...);
+      ++pos_;
+    }
+    return back();
+  }
+
+  void pop_back() {
+    --pos_;
+    std::destroy_at(arr_ + pos_);
+  }
+
+  void resize(size_t new_size, const T &val = T()) {
+    if (new_size <= pos_) {
+      std::destroy(arr_ + new_size, arr_ + pos_);
+      pos_ = new_size;
+    } else {
+      insert(pos_, new_size - pos_, val);
+    }
+  }
+
+  friend bool operator==(const vector_t &a, const vector_t &b) {
+    return a.pos_ == b.pos_ && std::equal(a.arr_, a.arr_ + a.pos_, b.arr_);
+  }
+  friend bool operator!=(const vector_t &a, const vector_t &b) { return !(a == b); }
+  friend bool operator<(const vector_t &a, const vector_t &b) {
+    return std::lexicographical_compare(a.arr_, a.arr_ + a.pos_, b.arr_, b.arr_ + b.pos_);
+  }
+  friend bool operator>(const vector_t &a, const vector_t &b) { return b < a; }
+  friend bool operator<=(const vector_t &a, const vector_t &b) { return !(b < a); }
+  friend bool operator>=(const vector_t &a, const vector_t &b) { return !(a < b); }
+
 private:
-  size_t capacity_{0};
-  T *arr_{nullptr};
+  using allocator_traits_t = std::allocator_traits<Allocator>;
+  using vector_inline_buffer_t<T, InlineCapacity>::inline_data;
+
+  // the smallest power of two, which is at least size, or zero for zero size
+  static size_t round_capacity(size_t size) {
+    size_t capacity = size == 0 ? 0 : 1;
+    while (capacity < size) {
+      capacity *= 2;
+    }
+    return capacity;
+  }
+
+  // capacity of storage for size elements, the inline one is used while they fit
+  static size_t storage_capacity(size_t size) { return size <= InlineCapacity ? InlineCapacity : round_capacity(size); }
+
+  bool is_inline() const { return InlineCapacity != 0 && capacity_ == InlineCapacity; }
+
+  // count may be zero with null pointers, which memcpy and memmove don't accept
+  static void copy_bytes(const T *from, size_t count, T *dest) {
+    if (count != 0) {
+      std::memcpy(static_cast<void *>(dest), from, count * sizeof(T));
+    }
+  }
+  static void move_bytes(const T *from, size_t count, T *dest) {
+    if (count != 0) {
+      std::memmove(static_cast<void *>(dest), from, count * sizeof(T));
+    }
+  }
+
+  /**
+   * Constructs elements of [first, last) at dest, the source is kept until destroy_relocated(first, last),
+   * so a throwing copy leaves it untouched. Elements are moved only if it can't throw
+   */
+  static void relocate(T *first, T *last, T *dest) {
+    if constexpr (is_trivially_relocatable_v<T>) {
+      copy_bytes(first, last - first, dest);
+    } else if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
+      std::uninitialized_move(first, last, dest);
+    } else {
+      std::uninitialized_copy(first, last, dest);
+    }
+  }
+
+  // relocated bytes belong to the new objects, so the old ones aren't destroyed
+  static void destroy_relocated(T *first, T *last) {
+    if constexpr (!is_trivially_relocatable_v<T>) {
+      std::destroy(first, last);
+    }
+  }
+
+  // storage_capacity gives InlineCapacity for the inline buffer, it is zero without one
+  T *allocate(size_t capacity) {
+    return capacity == InlineCapacity ? inline_data() : allocator_traits_t::allocate(allocator_, capacity);
+  }
+
+  void deallocate(T *arr, size_t capacity) {
+    if (capacity != InlineCapacity) {
+      allocator_traits_t::deallocate(allocator_, arr, capacity);
+    }
+  }
+
+  // replaces the old storage by new_capacity one
+  void reallocate(size_t new_capacity) {
+    T *new_arr = allocate(new_capacity);
+    try {
+      relocate(arr_, arr_ + pos_, new_arr);
+    } catch (...) {
+      deallocate(new_arr, new_capacity);
+      throw;
+    }
+    destroy_relocated(arr_, arr_ + pos_);
+    deallocate(arr_, capacity_);
+    capacity_ = new_capacity;
+    arr_ = new_arr;
+  }
+
+  /**
+   * Insert, which doesn't fit capacity. construct(dest, 0, count) makes inserted elements in the new storage
+   * before the old elements are touched, so they may be made of the old ones
+   */
+  template <class Construct>
+  void reallocate_insert(size_t pos, size_t count, Construct construct) {
+    size_t new_capacity = storage_capacity(pos_ + count);
+    T *new_arr = allocate(new_capacity);
+    T *inserted = new_arr + pos;
+    try {
+      construct(inserted, 0, count);
+    } catch (...) {
+      deallocate(new_arr, new_capacity);
+      throw;
+    }
+    try {
+      relocate(arr_, arr_ + pos, new_arr);
+      try {
+        relocate(arr_ + pos, arr_ + pos_, inserted + count);
+      } catch (...) {
+        // the first part may be moved only if the second one is
+        std::destroy(new_arr, inserted);
+        throw;
+      }
+    } catch (...) {
+      std::destroy(inserted, inserted + count);
+      deallocate(new_arr, new_capacity);
+      throw;
+    }
+    destroy_relocated(arr_, arr_ + pos_);
+    deallocate(arr_, capacity_);
+    capacity_ = new_capacity;
+    arr_ = new_arr;
+    pos_ += count;
+  }
+
+  /**
+   * Insert, which fits capacity. assign(dest, from, n) and construct(dest, from, n) put inserted
+   * elements [from, from + n) to constructed and to raw slots starting at dest
+   */
+  template <class Assign, class Construct>
+  void insert_in_place(size_t pos, size_t count, Assign assign, Construct construct) {
+    T *gap = arr_ + pos;
+    T *end = arr_ + pos_;
+    size_t after = pos_ - pos;
+    if constexpr (is_trivially_relocatable_v<T>) {
+      move_bytes(gap, after, gap + count);
+      try {
+        construct(gap, 0, count);
+      } catch (...) {
+        move_bytes(gap + count, after, gap);
+        throw;
+      }
+    } else if (after > count) {
+      std::uninitialized_move(end - count, end, end);
+      try {
+        std::move_backward(gap, end - count, end);
+        assign(gap, 0, count);
+      } catch (...) {
+        // slots after size() must be raw
+        std::destroy(end, end + count);
+        throw;
+      }
+    } else {
+      construct(end, after, count - after);
+      try {
+        std::uninitialized_move(gap, end, gap + count);
+      } catch (...) {
+        std::destroy(end, end + (count - after));
+        throw;
+      }
+      try {
+        assign(gap, 0, after);
+      } catch (...) {
+        std::destroy(end, end + count);
+        throw;
+      }
+    }
+    pos_ += count;
+  }
+
+  size_t capacity_{InlineCapacity};
+  T *arr_{inline_data()};
   size_t pos_{0};
+  Allocator allocator_;
 };
+
+/**
+ * Vector, which keeps up to N elements inside itself without heap allocations
+ */
+template <class T, size_t N, class Allocator = std::allocator<T>>
+using small_vector_t = vector_t<T, Allocator, N>;